@@ -11,6 +11,7 @@ CREATE TABLE IF NOT EXISTS item_properties (
 	media_position INTEGER,
 	flag INTEGER,
 	crc INTEGER,
+	phash INTEGER,
 	last_scanned INTEGER64,	
 	last_indexed INTEGER64,	
 	
@@ -115,18 +115,23 @@ std::vector<std::pair<std::u8string_view, std::u8string>> calc_app_info(const in
 	result.emplace_back(u8"Indexed items:"sv, str::to_string(index.stats.index_item_count));
 	result.emplace_back(u8"Indexed folders:"sv, str::to_string(index.stats.index_folder_count));
 	result.emplace_back(u8"Duplicates:"sv,
-		str::format(u8"g={} mcomp={}"sv, index.stats.indexed_dup_folder_count,
-			index.stats.indexed_max_compare_count));
+		str::format(u8"g={} mcomp={} keys={} changed={}"sv, index.stats.indexed_dup_folder_count,
+			index.stats.indexed_max_compare_count, index.stats.indexed_dup_key_count,
+			index.stats.predictions_changed_folders));
 	result.emplace_back(u8"Hashes:"sv,
-		str::format(u8"crc={}"sv, index.stats.indexed_crc_count));
+		str::format(u8"crc={} hashed={} remaining={}"sv, index.stats.indexed_crc_count,
+			index.stats.fingerprint_hashed, index.stats.fingerprint_remaining));
 	result.emplace_back(u8"DB size:"sv, index.stats.database_size.str());
 	result.emplace_back(u8"Saved:"sv, str::format(u8"{} items | {} thumbs"sv, index.stats.items_saved,
 		index.stats.thumbs_saved));
+	result.emplace_back(u8"Writes:"sv, str::format(u8"{} in {} statements"sv, index.stats.writes_received,
+		index.stats.write_statements));
 
 
 	result.emplace_back(u8"Index load:"sv, str::format(u8"{} ms"sv, index.stats.index_load_ms));
 	result.emplace_back(u8"Predictions:"sv, str::format(u8"{} ms"sv, index.stats.predictions_ms));
 	result.emplace_back(u8"Count Matches:"sv, str::format(u8"{} ms"sv, index.stats.count_matches_ms));
+	result.emplace_back(u8"Columns:"sv, str::format(u8"{} ms"sv, index.stats.columns_ms));
 
 	if (include_state)
 	{
@@ -556,9 +561,10 @@ void command_line_t::parse(const std::u8string_view command_line_text)
 				if ((stripped[0] == '-' || stripped[0] == '/') && stripped.size() > 1)
 				{
 					const auto op = stripped.substr(stripped[1] == '-' ? 2 : 1);
-					no_gpu = str::icmp(op, u8"no-gpu"sv) == 0;
-					no_indexing = str::icmp(op, u8"no-indexing"sv) == 0;
-					run_tests = str::icmp(op, u8"run-tests"sv) == 0;
+					if (str::icmp(op, u8"no-gpu"sv) == 0) no_gpu = true;
+					if (str::icmp(op, u8"no-indexing"sv) == 0) no_indexing = true;
+					if (str::icmp(op, u8"run-tests"sv) == 0) run_tests = true;
+					if (str::icmp(op, u8"queue-stats"sv) == 0) queue_stats = true;
 				}
 				else if (df::is_path(stripped))
 				{
@@ -590,6 +596,7 @@ std::u8string command_line_t::format_restart_cmd_line() const
 	std::u8string result;
 	if (no_gpu) result += u8" -no-gpu"sv;
 	if (no_indexing) result += u8" -no-indexing"sv;
+	if (queue_stats) result += u8" -queue-stats"sv;
 	return result;
 }
 
@@ -694,8 +701,48 @@ app_frame::app_frame(ui::plat_app_ptr pa) :
 	_edit_view_state(_state),
 	_item_index(*this, _locations),
 	_db(_state.item_index),
-	_pa(std::move(pa))
+	_pa(std::move(pa)),
+	_executor(std::max(std::thread::hardware_concurrency(), 4u))
 {
+	using pri = platform::executor::priority;
+
+	// Scanning lanes stay paused until the index has loaded.
+	const struct
+	{
+		async_queue q;
+		std::u8string_view name;
+		pri priority;
+		bool wait_for_index;
+	} lanes[] = {
+		{ async_queue::render, u8"render"sv, pri::interactive, false },
+		{ async_queue::load, u8"load"sv, pri::interactive, false },
+		{ async_queue::load_raw, u8"load_raw"sv, pri::interactive, false },
+		{ async_queue::query, u8"query"sv, pri::interactive, false },
+		{ async_queue::scan_displayed_items, u8"scan_displayed_items"sv, pri::interactive, true },
+		{ async_queue::auto_complete, u8"auto_complete"sv, pri::interactive, false },
+		{ async_queue::sidebar, u8"sidebar"sv, pri::interactive, false },
+		{ async_queue::work, u8"work"sv, pri::normal, false },
+		{ async_queue::web, u8"web"sv, pri::normal, false },
+		{ async_queue::cloud, u8"cloud"sv, pri::normal, false },
+		{ async_queue::scan_modified_items, u8"scan_modified_items"sv, pri::normal, true },
+		{ async_queue::index_predictions_single, u8"predictions"sv, pri::normal, true },
+		{ async_queue::index_summary_single, u8"summary"sv, pri::normal, true },
+		{ async_queue::index_presence_single, u8"presence"sv, pri::normal, true },
+		{ async_queue::thumbnail_prefetch_single, u8"thumbnail_prefetch"sv, pri::normal, false },
+		{ async_queue::index, u8"index"sv, pri::background, false },
+		{ async_queue::scan_folder, u8"scan_folder"sv, pri::background, true },
+		{ async_queue::crc, u8"crc"sv, pri::background, true },
+		{ async_queue::fingerprint, u8"fingerprint"sv, pri::background, true },
+	};
+
+	static_assert(std::extent_v<decltype(lanes)> == std::tuple_size_v<decltype(_async_lanes)>);
+
+	for (const auto& l : lanes)
+	{
+		_async_lanes[static_cast<size_t>(l.q)] = _executor.add_lane(l.name, l.priority, l.wait_for_index);
+	}
+
+	_location_lane = _executor.add_lane(u8"locations"sv, pri::normal);
 
 	_sidebar = std::make_shared<sidebar_host>(_state);
 	_view_frame = std::make_shared<view_frame>(_state);
@@ -708,8 +755,52 @@ app_frame::app_frame(ui::plat_app_ptr pa) :
 	_view_media = std::make_shared<media_view>(_state, _view_frame);
 }
 
+std::vector<std::u8string> format_queue_stats(const std::vector<platform::executor::lane_stats>& stats)
+{
+	std::vector<std::u8string> result;
+
+	for (const auto& s : stats)
+	{
+		if (s.completed == 0 && s.depth == 0) continue;
+
+		result.emplace_back(str::format(
+			u8"{} tasks={} coalesced={} depth={} max-depth={} | wait us avg={} p50={} p95={} p99={} max={} | run us avg={} p50={} p95={} p99={} max={}"sv,
+			s.name, s.completed, s.coalesced, s.depth, s.max_depth,
+			s.wait.count ? s.wait.total_us / s.wait.count : 0, s.wait.percentile_us(0.5), s.wait.percentile_us(0.95),
+			s.wait.percentile_us(0.99), s.wait.max_us,
+			s.run.count ? s.run.total_us / s.run.count : 0, s.run.percentile_us(0.5), s.run.percentile_us(0.95),
+			s.run.percentile_us(0.99), s.run.max_us));
+	}
+
+	return result;
+}
+
+static std::u8string format_thumbnail_cache_stats(const df::thumbnail_surface_cache::stats_t& s)
+{
+	const auto lookups = s.hits + s.misses;
+	return str::format(u8"thumbnails count={} mb={} budget-mb={} hits={} misses={} hit-rate={}% evictions={}"sv,
+		s.count, s.bytes / df::one_meg, s.budget / df::one_meg, s.hits, s.misses,
+		lookups ? (s.hits * 100) / lookups : 0, s.evictions);
+}
+
 app_frame::~app_frame()
 {
+	if (command_line.queue_stats)
+	{
+		for (const auto& line : format_queue_stats(_executor.stats()))
+		{
+			df::log(u8"queue_stats"sv, line);
+		}
+
+		for (const auto& stage : _state.item_index.stats.scan_stages)
+		{
+			if (stage.items) df::log(u8"queue_stats"sv, format_scan_stage(stage));
+		}
+
+		df::log(u8"queue_stats"sv, format_thumbnail_cache_stats(df::thumbnail_cache().stats()));
+	}
+
+	_executor.stop();
 	_threads.clear();
 	_state.close();
 
@@ -910,6 +1001,12 @@ static void start_database(database& db, platform::task_queue& database_task_que
 						{
 							t();
 						}
+
+						// a busy task queue should not hold back writes indefinitely
+						if (db.writes_due())
+						{
+							db.perform_writes();
+						}
 					}
 					catch (std::exception& e)
 					{
@@ -989,46 +1086,6 @@ static void start_media_preview()
 	}
 }
 
-static void start_worker(platform::task_queue& q, const std::u8string_view name)
-{
-	log_func lf(__FUNCTION__, name);
-	platform::set_thread_description(name);
-
-	if (!df::is_closing)
-	{
-		try
-		{
-			platform::thread_init c;
-			const std::vector<std::reference_wrapper<platform::thread_event>> events = { q._event, platform::event_exit };
-
-			while (!df::is_closing)
-			{
-				if (wait_for(events, 10000, false) == 0)
-				{
-					try
-					{
-						df::scope_locked_inc l(df::jobs_running);
-						const auto tasks = q.dequeue_all();
-
-						for (const auto& t : tasks)
-						{
-							t();
-						}
-					}
-					catch (std::exception& e)
-					{
-						df::log(__FUNCTION__, e.what());
-					}
-				}
-			}
-		}
-		catch (std::exception& e)
-		{
-			df::log(__FUNCTION__, e.what());
-		}
-	}
-}
-
 void app_frame::update_tooltip()
 {
 	_hover.clear();
@@ -1211,6 +1268,8 @@ void app_frame::update_overlay()
 
 void app_frame::tick()
 {
+	_state.item_index.resume_fingerprint_files();
+
 	const auto display = _state.display_state();
 
 	if (display && display->_session)
@@ -1796,13 +1855,14 @@ void app_frame::complete_pending_events()
 			{
 				auto token = df::cancel_token(index_version);
 
-				index_task_queue.reset_and_enqueue([this, token]
+				_executor.reset_and_enqueue(async_lane(async_queue::index), [this, token]
 					{
 						_state.item_index.index_roots(index_folders());
 						_state.item_index.index_folders(token);
 						invalidate_view(view_invalid::sidebar);
 
 						_state.item_index.scan_uncached(token);
+						_state.item_index.queue_fingerprint_files(token);
 						invalidate_view(view_invalid::sidebar | view_invalid::item_scan | view_invalid::refresh_items);
 					});
 
@@ -2380,7 +2440,12 @@ void app_frame::on_window_paint(ui::draw_context& dc)
 				_view_frame->frame_render_time * 1000.0, _frame_delay);
 		}
 
-		dc.draw_text(str::utf8_cast(text), _status_bounds, ui::style::font_face::dialog,
+		const auto thumbs = df::thumbnail_cache().stats();
+		const auto lookups = thumbs.hits + thumbs.misses;
+		const auto status_text = str::format(u8"{} | thumbnails {} MB {}% hit"sv, str::utf8_cast(text),
+			thumbs.bytes / df::one_meg, lookups ? (thumbs.hits * 100) / lookups : 0);
+
+		dc.draw_text(status_text, _status_bounds, ui::style::font_face::dialog,
 			ui::style::text_style::single_line_center, ui::color(dc.colors.foreground, dc.colors.alpha), {});
 	}
 
@@ -2456,65 +2521,24 @@ void app_frame::queue_async(const async_queue q, std::function<void()> f)
 {
 	switch (q)
 	{
-	case async_queue::crc:
-		crc_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::scan_folder:
-		scan_folder_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::scan_modified_items:
-		scan_modified_items_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::scan_displayed_items:
-		scan_displayed_items_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::load:
-		load_task_queue.enqueue(std::move(f));
-		break;
 	case async_queue::load_raw:
-		load_raw_task_queue.reset_and_enqueue(std::move(f));
-		break;
-	case async_queue::render:
-		render_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::query:
-		query_task_queue.enqueue(std::move(f));
-		break;
 	case async_queue::index_predictions_single:
-		predictions_task_queue.reset_and_enqueue(std::move(f));
-		break;
 	case async_queue::index_summary_single:
-		summary_task_queue.reset_and_enqueue(std::move(f));
-		break;
 	case async_queue::index_presence_single:
-		presence_task_queue.reset_and_enqueue(std::move(f));
-		break;
-	case async_queue::auto_complete:
-		auto_complete_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::cloud:
-		cloud_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::index:
-		index_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::sidebar:
-		sidebar_task_queue.enqueue(std::move(f));
-		break;
-	case async_queue::web:
-		web_task_queue.enqueue(std::move(f));
+	case async_queue::thumbnail_prefetch_single:
+		// only the latest request matters
+		_executor.reset_and_enqueue(async_lane(q), std::move(f));
 		break;
 
-	case async_queue::work:
 	default:
-		work_task_queue.enqueue(std::move(f));
+		_executor.enqueue(async_lane(q), std::move(f));
 		break;
 	}
 }
 
 void app_frame::queue_location(std::function<void(location_cache&)> f)
 {
-	location_task_queue.enqueue([f = std::move(f), &lc = _locations]() { f(lc); });
+	_executor.enqueue(_location_lane, [f = std::move(f), &lc = _locations]() { f(lc); });
 }
 
 void app_frame::queue_database(std::function<void(database&)> f)
@@ -3750,9 +3774,10 @@ void app_frame::start_workers()
 			{
 				auto token = df::cancel_token(index_version);
 
-				index_task_queue.enqueue([this, token]
+				_executor.enqueue(async_lane(async_queue::index), [this, token]
 					{
 						_state.item_index.scan_uncached(token);
+						_state.item_index.queue_fingerprint_files(token);
 
 						invalidate_view(view_invalid::sidebar |
 							view_invalid::command_state |
@@ -3761,13 +3786,13 @@ void app_frame::start_workers()
 							view_invalid::index_summary);
 					});
 
-				_threads.start([&q = crc_task_queue] { start_worker(q, u8"crc"sv); });
-				_threads.start([&q = scan_folder_task_queue] { start_worker(q, u8"scan_folder"sv); });
-				_threads.start([&q = scan_modified_items_task_queue] { start_worker(q, u8"scan_modified_items"sv); });
-				_threads.start([&q = scan_displayed_items_task_queue] { start_worker(q, u8"scan_displayed_items"sv); });
-				_threads.start([&q = predictions_task_queue] { start_worker(q, u8"predictions"sv); });
-				_threads.start([&q = summary_task_queue] { start_worker(q, u8"summary"sv); });
-				_threads.start([&q = presence_task_queue] { start_worker(q, u8"presence"sv); });
+				for (const auto q : {
+					async_queue::crc, async_queue::scan_folder, async_queue::scan_modified_items,
+					async_queue::scan_displayed_items, async_queue::index_predictions_single,
+					async_queue::index_summary_single, async_queue::index_presence_single })
+				{
+					_executor.resume(async_lane(q));
+				}
 			}
 
 			invalidate_view(view_invalid::sidebar |
@@ -3791,19 +3816,7 @@ void app_frame::start_workers()
 			start_database(db, q, async, app, index_loaded_func);
 		});
 
-	_threads.start([&q = load_task_queue] { start_worker(q, u8"load"sv); });
-	_threads.start([&q = load_raw_task_queue] { start_worker(q, u8"load_raw"sv); });
-	_threads.start([&q = render_task_queue] { start_worker(q, u8"render"sv); });
-	_threads.start([&q = query_task_queue] { start_worker(q, u8"query"sv); });
-	_threads.start([&q = auto_complete_task_queue] { start_worker(q, u8"auto_complete"sv); });
-	_threads.start([&q = location_task_queue] { start_worker(q, u8"locations"sv); });
-	_threads.start([&q = sidebar_task_queue] { start_worker(q, u8"sidebar"sv); });
-	_threads.start([&q = web_task_queue] { start_worker(q, u8"web"sv); });
-
-	_threads.start([&q = cloud_task_queue] { start_worker(q, u8"cloud"sv); });
-	_threads.start([&q = index_task_queue] { start_worker(q, u8"index"sv); });
-
-	index_task_queue.enqueue([this, scan_uncached_func]
+	_executor.enqueue(async_lane(async_queue::index), [this, scan_uncached_func]
 		{
 			_state.item_index.index_roots(index_folders());
 
@@ -3813,7 +3826,7 @@ void app_frame::start_workers()
 			invalidate_view(view_invalid::sidebar | view_invalid::command_state | view_invalid::index_summary);
 		});
 
-	location_task_queue.enqueue([&lc = _locations]() { lc.load_index(); });
+	_executor.enqueue(_location_lane, [&lc = _locations]() { lc.load_index(); });
 }
 
 void app_frame::update_font_size()
@@ -3895,12 +3908,12 @@ bool app_frame::init(const std::u8string_view command_line_text)
 	_search_completes = std::make_shared<search_auto_complete>(_state, _search_edit);
 	_bubble = _app_frame->create_bubble();
 	_state.view_mode(view_type::items);
-	_threads.start([&q = work_task_queue] { start_worker(q, u8"work"sv); });
+	_executor.start();
 
 	open_default_folder();
 	invalidate_view(view_invalid::address);
 
-	work_task_queue.enqueue([this, app = shared_from_this()]()
+	_executor.enqueue(async_lane(async_queue::work), [this, app = shared_from_this()]()
 		{
 			start_workers();
 			check_for_updates_and_location(app, _state);
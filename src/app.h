@@ -417,27 +417,19 @@ public:
 	const ui::plat_app_ptr _pa;
 
 	platform::queue<std::function<void()>> _ui_queue;
-	platform::task_queue cloud_task_queue;
 	platform::task_queue database_task_queue;
-	platform::task_queue index_task_queue;
-	platform::task_queue load_task_queue;
-	platform::task_queue load_raw_task_queue;
-	platform::task_queue location_task_queue;
-	platform::task_queue sidebar_task_queue;
-	platform::task_queue web_task_queue;
-	platform::task_queue predictions_task_queue;
-	platform::task_queue summary_task_queue;
-	platform::task_queue presence_task_queue;
-	platform::task_queue auto_complete_task_queue;
-	platform::task_queue query_task_queue;
-	platform::task_queue render_task_queue;
-	platform::task_queue scan_folder_task_queue;
-	platform::task_queue scan_modified_items_task_queue;
-	platform::task_queue scan_displayed_items_task_queue;
-	platform::task_queue crc_task_queue;
-	platform::task_queue work_task_queue;
 	platform::threads _threads;
 
+	// async queues are lanes of one shared executor
+	platform::executor _executor;
+	std::array<size_t, static_cast<size_t>(async_queue::web) + 1> _async_lanes = {};
+	size_t _location_lane = 0;
+
+	size_t async_lane(const async_queue q) const
+	{
+		return _async_lanes[static_cast<size_t>(q)];
+	}
+
 	ui::control_frame_ptr _app_frame;
 
 	ui::toolbar_ptr _navigate1;
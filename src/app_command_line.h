@@ -17,9 +17,13 @@ struct command_line_t
 	bool no_gpu = false;
 	bool no_indexing = false;
 	bool run_tests = false;
+	bool queue_stats = false; // log async queue latency stats on exit
 
 	void parse(std::u8string_view command_line_text);
 	std::u8string format_restart_cmd_line() const;
 };
 
 extern command_line_t command_line;
+
+// One line per async queue for the -queue-stats dump
+std::vector<std::u8string> format_queue_stats(const std::vector<platform::executor::lane_stats>& stats);
@@ -54,6 +54,7 @@ static constexpr std::u8string_view s_quality = u8"quality"sv;
 static constexpr std::u8string_view s_webp_quality = u8"webp_quality"sv;
 static constexpr std::u8string_view s_webp_lossless = u8"webp_lossless"sv;
 static constexpr std::u8string_view s_slideshow_delay = u8"slideshow_delay"sv;
+static constexpr std::u8string_view s_thumbnail_cache_mb = u8"thumbnail_cache_mb"sv;
 static constexpr std::u8string_view s_copyright = u8"copyright"sv;
 static constexpr std::u8string_view s_creator = u8"creator"sv;
 static constexpr std::u8string_view s_album_artist = u8"album_artist"sv;
@@ -219,6 +220,7 @@ settings_t::settings_t()
 
 	thumbnail_max_dimension = { 320, 256 };
 	resize_max_dimension = 2048;
+	thumbnail_cache_mb = 256;
 	media_volume = 1000;
 	jpeg_save_quality = 90;
 	webp_quality = 70;
@@ -553,6 +555,7 @@ void settings_t::read(const platform::setting_file_ptr& store_in)
 	store.read({}, s_webp_quality, webp_quality);
 	store.read({}, s_webp_lossless, webp_lossless);
 	store.read({}, s_slideshow_delay, slideshow_delay);
+	store.read({}, s_thumbnail_cache_mb, thumbnail_cache_mb);
 	store.read({}, s_items_scale, item_scale);
 	store.read({}, s_item_splitter, item_splitter_pos);
 	store.read({}, s_update_min, min_show_update_day);
@@ -707,6 +710,7 @@ void settings_t::write(const platform::setting_file_ptr& store_in) const
 	store.write({}, s_webp_quality, webp_quality);
 	store.write({}, s_webp_lossless, webp_lossless);
 	store.write({}, s_slideshow_delay, slideshow_delay);
+	store.write({}, s_thumbnail_cache_mb, thumbnail_cache_mb);
 	store.write({}, s_items_scale, item_scale);
 	store.write({}, s_item_splitter, item_splitter_pos);
 	store.write({}, s_update_min, min_show_update_day);
@@ -69,6 +69,7 @@ public:
 
 	sizei thumbnail_max_dimension;
 	int resize_max_dimension = 0;
+	int thumbnail_cache_mb = 0;
 	int media_volume = 0;
 	int slideshow_delay = 0;
 	int item_scale = 5;
@@ -413,81 +413,57 @@ sync_analysis_result sync_analysis(const df::index_roots& local_roots, const df:
 	const df::cancel_token& token)
 {
 	sync_analysis_result result;
-	std::map<std::u8string, df::folder_path, df::iless> local_roots_by_relative;
+	df::hash_map<std::u8string, df::folder_path, df::ihash, df::ieq> local_roots_by_relative;
 
-	std::vector<sync_analysis_folder> local_folders_to_scan;
+	std::vector<sync_analysis_folder> folders_to_scan;
 
 	for (const auto& f : local_roots.folders)
 	{
-		local_folders_to_scan.emplace_back(f, f);
+		folders_to_scan.emplace_back(f, f);
 	}
 
-	while (!local_folders_to_scan.empty())
-	{
-		if (token.is_cancelled()) return {};
-
-		const auto folder = local_folders_to_scan.back();
-		local_folders_to_scan.pop_back();
+	folders_to_scan.emplace_back(remote_path, remote_path, std::u8string{}, true);
 
-		if (!is_excluded(local_roots, folder.path))
+	// local and remote trees are listed together
+	platform::walk_folders(std::move(folders_to_scan), [&local_roots](const sync_analysis_folder& folder)
 		{
-			const auto contents = platform::iterate_file_items(folder.path, setting.show_hidden);
+			return is_excluded(local_roots, folder.path)
+				? platform::folder_contents{}
+				: platform::iterate_file_items(folder.path, setting.show_hidden);
+		},
+		[&](const sync_analysis_folder& folder, const platform::folder_contents& contents,
+			std::vector<sync_analysis_folder>& pending)
+		{
+			auto& items = result[folder.relative];
 
 			for (const auto& file : contents.files)
 			{
-				if (token.is_cancelled()) break;
+				auto& i = items[file.name];
 
-				auto& i = result[folder.relative][file.name.str()];
-				i.local_path = folder.path.combine_file(file.name);
-				i.local_fi = file;
-				i.local_root = folder.root;
+				if (folder.is_remote)
+				{
+					i.remote_path = folder.path.combine_file(file.name);
+					i.remote_fi = file;
+					i.remote_root = folder.root;
+				}
+				else
+				{
+					i.local_path = folder.path.combine_file(file.name);
+					i.local_fi = file;
+					i.local_root = folder.root;
+				}
 			}
 
 			for (const auto& sub_folder : contents.folders)
 			{
 				auto relative = relative_combine(folder.relative, sub_folder.name);
-				auto sub_folder_path = folder.path.combine(sub_folder.name);
-				sync_analysis_folder unknown = { sub_folder_path, folder.root, relative };
-				local_folders_to_scan.emplace_back(unknown);
-				local_roots_by_relative[relative] = folder.root;
+				if (!folder.is_remote) local_roots_by_relative[relative] = folder.root;
+				pending.emplace_back(folder.path.combine(sub_folder.name), folder.root, std::move(relative),
+					folder.is_remote);
 			}
-		}
-	}
-
-	std::vector<sync_analysis_folder> remote_folders_to_scan;
-	remote_folders_to_scan.emplace_back(remote_path, remote_path);
-
-	while (!remote_folders_to_scan.empty())
-	{
-		if (token.is_cancelled()) return {};
-
-		const auto folder = remote_folders_to_scan.back();
-		remote_folders_to_scan.pop_back();
+		}, token);
 
-		if (!is_excluded(local_roots, folder.path))
-		{
-			const auto contents = platform::iterate_file_items(folder.path, setting.show_hidden);
-
-			for (const auto& file : contents.files)
-			{
-				if (token.is_cancelled()) break;
-
-				auto& i = result[folder.relative][file.name.str()];
-				i.remote_path = folder.path.combine_file(file.name);
-				i.remote_fi = file;
-				i.remote_root = folder.root;
-			}
-
-			for (const auto& sub_folder : contents.folders)
-			{
-				sync_analysis_folder unknown = {
-					folder.path.combine(sub_folder.name), remote_path,
-					relative_combine(folder.relative, sub_folder.name)
-				};
-				remote_folders_to_scan.emplace_back(unknown);
-			}
-		}
-	}
+	if (token.is_cancelled()) return {};
 
 	for (auto&& i : result)
 	{
@@ -499,7 +475,7 @@ sync_analysis_result sync_analysis(const df::index_roots& local_roots, const df:
 
 			if (f.second.local_root.is_empty())
 			{
-				const auto found_relative = local_roots_by_relative.find(f.first);
+				const auto found_relative = local_roots_by_relative.find(i.first);
 
 				if (found_relative != local_roots_by_relative.end())
 				{
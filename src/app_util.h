@@ -136,10 +136,12 @@ struct sync_analysis_folder
 	df::folder_path path;
 	df::folder_path root;
 	std::u8string relative;
+	bool is_remote = false;
 };
 
-using sync_analysis_items = std::map<std::u8string, sync_analysis_item, df::iless>;
-using sync_analysis_result = std::map<std::u8string, sync_analysis_items, df::iless>;
+// files by name, grouped by folder path relative to the sync roots
+using sync_analysis_items = df::hash_map<str::cached, sync_analysis_item, df::ihash, df::ieq>;
+using sync_analysis_result = df::hash_map<std::u8string, sync_analysis_items, df::ihash, df::ieq>;
 
 sync_analysis_result sync_analysis(const df::index_roots& local_roots, const df::folder_path remote_path,
 	const bool sync_local_remote, const bool sync_remote_local,
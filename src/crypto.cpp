@@ -153,20 +153,40 @@ uint32_t crypto::fnv1a(const void* data, const size_t len)
 	return result;
 }
 
-uint32_t crypto::fnv1a_i(const std::u8string_view sv)
+// ASCII runs are lower cased a block at a time, other characters go through to_lower
+static uint32_t fnv1a_i_append(uint32_t result, const std::u8string_view sv)
 {
 	auto p = sv.begin();
-	uint32_t result = OFFSET_BASIS_32;
 
 	while (p < sv.end())
 	{
-		result ^= str::to_lower(str::pop_utf8_char(p, sv.end()));
-		result *= FNV_PRIME_32;
+		char8_t folded[64];
+		const auto len = std::min(sv.end() - p, static_cast<ptrdiff_t>(std::size(folded)));
+		const auto run = str::ascii_lower(folded, &*p, len);
+
+		for (size_t i = 0; i < run; ++i)
+		{
+			result ^= folded[i];
+			result *= FNV_PRIME_32;
+		}
+
+		p += run;
+
+		if (run < static_cast<size_t>(len))
+		{
+			result ^= str::to_lower(str::pop_utf8_char(p, sv.end()));
+			result *= FNV_PRIME_32;
+		}
 	}
 
 	return result;
 }
 
+uint32_t crypto::fnv1a_i(const std::u8string_view sv)
+{
+	return fnv1a_i_append(OFFSET_BASIS_32, sv);
+}
+
 uint32_t crypto::fnv1a_i(const std::string_view sv)
 {
 	uint32_t result = OFFSET_BASIS_32;
@@ -182,22 +202,5 @@ uint32_t crypto::fnv1a_i(const std::string_view sv)
 
 uint32_t crypto::fnv1a_i(const std::u8string_view sv1, const std::u8string_view sv2)
 {
-	auto p = sv1.begin();
-	uint32_t result = OFFSET_BASIS_32;
-
-	while (p < sv1.end())
-	{
-		result ^= str::to_lower(str::pop_utf8_char(p, sv1.end()));
-		result *= FNV_PRIME_32;
-	}
-
-	p = sv2.begin();
-
-	while (p < sv2.end())
-	{
-		result ^= str::to_lower(str::pop_utf8_char(p, sv2.end()));
-		result *= FNV_PRIME_32;
-	}
-
-	return result;
+	return fnv1a_i_append(fnv1a_i_append(OFFSET_BASIS_32, sv1), sv2);
 }
@@ -1414,6 +1414,32 @@ std::u8string normalize_string_trailing_null(std::u8string operand)
 	return operand;
 }
 
+// An embedded preview can stand in for the image if it has the same shape
+// and is at least as big as the thumbnail the full image would produce.
+static bool is_preview_big_enough(const file_scan_result& scanned, const sizei max_thumb_size)
+{
+	const auto image_extent = scanned.dimensions();
+	const auto preview_extent = is_valid(scanned.thumbnail_image)
+		? scanned.thumbnail_image->dimensions()
+		: (is_valid(scanned.thumbnail_surface) ? scanned.thumbnail_surface->dimensions() : sizei{});
+
+	if (image_extent.is_empty() || preview_extent.is_empty())
+	{
+		return false;
+	}
+
+	const auto image_aspect = image_extent.cx / static_cast<double>(image_extent.cy);
+	const auto preview_aspect = preview_extent.cx / static_cast<double>(preview_extent.cy);
+
+	if (fabs(image_aspect - preview_aspect) > image_aspect * 0.02)
+	{
+		return false;
+	}
+
+	const auto thumb_extent = ui::scale_dimensions(image_extent, max_thumb_size, true);
+	return preview_extent.cx >= thumb_extent.cx && preview_extent.cy >= thumb_extent.cy;
+}
+
 file_scan_result files::scan_file(const df::file_path path, const bool load_thumb, const file_type_ref ft,
 	const std::u8string_view xmp_sidecar, const sizei max_thumb_size)
 {
@@ -1433,6 +1459,25 @@ file_scan_result files::scan_file(const df::file_path path, const bool load_thum
 
 			df::blob data;
 
+			if (load_from_mem && !is_small_file)
+			{
+				// jpeg metadata is at the start of the file, if it carries a big enough
+				// preview the rest of the file is never read
+				file_read_stream stream;
+
+				if (stream.open(f) && detect_format(stream.peek128(0)) == detected_format::JPEG)
+				{
+					auto preview = scan_photo(stream);
+
+					if (preview.success && is_preview_big_enough(preview, max_thumb_size))
+					{
+						return preview;
+					}
+				}
+
+				f->seek(0, platform::file::whence::begin);
+			}
+
 			if (is_small_file || load_from_mem)
 			{
 				data.resize(file_len);
@@ -1452,9 +1497,27 @@ file_scan_result files::scan_file(const df::file_path path, const bool load_thum
 					mem_read_stream stream(data);
 					result = scan_photo(stream);
 
-					if (is_image_format(detect_format(stream.peek128(0))))
+					const auto format = detect_format(stream.peek128(0));
+
+					if (is_image_format(format))
 					{
-						result.thumbnail_image = load_image_file(data);
+						ui::surface_ptr s;
+
+						if (load_thumb && format == detected_format::JPEG)
+						{
+							// decode at thumbnail size, libjpeg scales by up to 1/8 while decoding
+							s = image_to_surface(data, max_thumb_size);
+						}
+
+						if (is_valid(s))
+						{
+							result.thumbnail_surface = std::move(s);
+							result.thumbnail_image.reset();
+						}
+						else
+						{
+							result.thumbnail_image = load_image_file(data);
+						}
 					}
 					else
 					{
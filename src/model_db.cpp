@@ -291,6 +291,332 @@ database::~database()
 	close();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Each record is a header followed by folder, name, thumbnail and cover art
+// bytes, padded to 8 bytes. Later records for the same path win.
+struct thumbnail_record
+{
+	static constexpr uint32_t marker = 0x48544644; // DFTH
+
+	uint32_t magic = marker;
+	uint32_t folder_len = 0;
+	uint32_t name_len = 0;
+	uint32_t thumb_len = 0;
+	uint32_t cover_art_len = 0;
+	uint32_t reserved = 0;
+	uint64_t last_scanned = 0;
+
+	uint64_t data_size() const
+	{
+		return static_cast<uint64_t>(folder_len) + name_len + thumb_len + cover_art_len;
+	}
+
+	uint64_t record_size() const
+	{
+		return (sizeof(thumbnail_record) + data_size() + 7) & ~7ull;
+	}
+};
+
+static_assert(sizeof(thumbnail_record) == 32);
+
+static std::u8string thumbnail_key(const std::u8string_view folder, const std::u8string_view name)
+{
+	std::u8string result;
+	result.reserve(folder.size() + name.size() + 1);
+	result += folder;
+	result += u8'\0';
+	result += name;
+	return result;
+}
+
+static df::file_path thumbnail_old_path(const df::file_path path)
+{
+	return df::file_path(path.folder(), path.file_name_without_extension(), u8".old"sv);
+}
+
+static bool read_thumbnail_record(const df::cspan data, const uint64_t offset, thumbnail_record& header)
+{
+	if (offset + sizeof(thumbnail_record) > data.size) return false;
+	memcpy(&header, data.data + offset, sizeof(header));
+	return header.magic == thumbnail_record::marker && offset + sizeof(header) + header.data_size() <= data.size;
+}
+
+void thumbnail_store::open(const df::file_path path)
+{
+	close();
+
+	_path = path;
+
+	// left behind when a reader still mapped it after compaction
+	platform::delete_file(thumbnail_old_path(path));
+
+	_file = platform::open_file(path, platform::file_open_mode::append);
+	load_index();
+}
+
+void thumbnail_store::close()
+{
+	platform::exclusive_lock lock(_rw);
+	_view.reset();
+	_items.clear();
+	_folders.clear();
+	_pending.clear();
+	_file.reset();
+	_end = 0;
+	_reserved = 0;
+}
+
+void thumbnail_store::load_index()
+{
+	auto view = platform::map_file(_path);
+	const auto data = view ? view->data() : df::cspan{};
+
+	df::hash_map<std::u8string, uint64_t> items;
+	df::hash_map<std::u8string, uint64_t> folders;
+	uint64_t offset = 0;
+	thumbnail_record header;
+
+	while (read_thumbnail_record(data, offset, header))
+	{
+		const auto* const text = std::bit_cast<const char8_t*>(data.data + offset + sizeof(header));
+		const std::u8string_view folder(text, header.folder_len);
+		const std::u8string_view name(text + header.folder_len, header.name_len);
+
+		items[thumbnail_key(folder, name)] = offset;
+		folders[std::u8string(folder)] = offset;
+		offset = std::min(offset + header.record_size(), static_cast<uint64_t>(data.size));
+	}
+
+	if (offset < data.size && _file)
+	{
+		// drop the space reserved for appends and any partly written record,
+		// the mapping must go first
+		if (data.size - offset >= sizeof(uint32_t) &&
+			*std::bit_cast<const uint32_t*>(data.data + offset) == thumbnail_record::marker)
+		{
+			df::log(__FUNCTION__, str::format(u8"Thumbnail store truncated at {} of {}"sv, offset, data.size));
+		}
+
+		view.reset();
+		_file->trunc(offset);
+		view = platform::map_file(_path);
+	}
+
+	_end = offset;
+	_reserved = _file ? _file->size() : offset;
+
+	platform::exclusive_lock lock(_rw);
+	_view = std::move(view);
+	_items = std::move(items);
+	_folders = std::move(folders);
+}
+
+bool thumbnail_store::read_entry(const platform::mapped_file_ptr& view, const uint64_t offset, entry& result) const
+{
+	thumbnail_record header;
+	const auto data = view ? view->data() : df::cspan{};
+
+	if (!read_thumbnail_record(data, offset, header))
+	{
+		return false;
+	}
+
+	const auto* const p = data.data + offset + sizeof(header) + header.folder_len + header.name_len;
+	result.view = view;
+	result.thumb = { p, header.thumb_len };
+	result.cover_art = { p + header.thumb_len, header.cover_art_len };
+	result.last_scanned = df::date_t(header.last_scanned);
+	return true;
+}
+
+bool thumbnail_store::find(const df::file_path id, entry& result) const
+{
+	platform::shared_lock lock(_rw);
+	const auto found = _items.find(thumbnail_key(id.folder().text(), id.name()));
+	return found != _items.end() && read_entry(_view, found->second, result);
+}
+
+bool thumbnail_store::find_folder(const df::folder_path folder, entry& result) const
+{
+	platform::shared_lock lock(_rw);
+	const auto found = _folders.find(folder.text().str());
+	return found != _folders.end() && read_entry(_view, found->second, result);
+}
+
+bool thumbnail_store::append(const df::file_path id, const df::cspan thumb, const df::cspan cover_art,
+	const df::date_t last_scanned)
+{
+	if (!_file) return false;
+
+	const auto folder = id.folder().text();
+	const auto name = id.name();
+
+	thumbnail_record header;
+	header.folder_len = static_cast<uint32_t>(folder.size());
+	header.name_len = static_cast<uint32_t>(name.size());
+	header.thumb_len = static_cast<uint32_t>(thumb.size);
+	header.cover_art_len = static_cast<uint32_t>(cover_art.size);
+	header.last_scanned = last_scanned.to_int64();
+
+	df::blob record(header.record_size(), 0);
+	auto* p = record.data();
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+	memcpy(p, folder.sz(), folder.size());
+	p += folder.size();
+	memcpy(p, name.sz(), name.size());
+	p += name.size();
+	if (thumb.size) memcpy(p, thumb.data, thumb.size);
+	p += thumb.size;
+	if (cover_art.size) memcpy(p, cover_art.data, cover_art.size);
+
+	if (_end + record.size() > _reserved)
+	{
+		// grow in steps so the mapping covers the next appends and flush
+		// rarely needs to map the file again
+		constexpr uint64_t min_reserve = 4_z * 1024_z * 1024_z;
+		const auto reserved = _end + std::max(static_cast<uint64_t>(record.size()), std::max(_end / 8, min_reserve));
+		if (_file->trunc(reserved)) _reserved = reserved;
+	}
+
+	_file->seek(_end, platform::file::whence::begin);
+
+	if (_file->write(record.data(), record.size()) != record.size())
+	{
+		df::log(__FUNCTION__, u8"Thumbnail store write failed"sv);
+		return false;
+	}
+
+	_pending.emplace_back(thumbnail_key(folder, name), _end);
+	_end += record.size();
+	return true;
+}
+
+bool thumbnail_store::flush()
+{
+	if (_pending.empty()) return true;
+
+	platform::mapped_file_ptr view;
+
+	{
+		platform::shared_lock lock(_rw);
+		view = _view;
+	}
+
+	// writes to a local file go through the same cache pages as its mapping,
+	// so records inside the mapped size are readable without mapping again.
+	// Readers keep using an old mapping until they release it.
+	if (!view || view->data().size < _end)
+	{
+		view = platform::map_file(_path);
+
+		if (!view || view->data().size < _end)
+		{
+			df::log(__FUNCTION__, u8"Thumbnail store map failed"sv);
+			return false;
+		}
+	}
+
+	platform::exclusive_lock lock(_rw);
+	_view = std::move(view);
+
+	for (auto&& p : _pending)
+	{
+		_folders[p.first.substr(0, p.first.find(u8'\0'))] = p.second;
+		_items[std::move(p.first)] = p.second;
+	}
+
+	_pending.clear();
+	return true;
+}
+
+void thumbnail_store::compact(const std::function<bool(std::u8string_view folder, std::u8string_view name)>& keep)
+{
+	flush();
+
+	const auto temp_path = df::file_path(_path.folder(), _path.file_name_without_extension(), u8".compact"sv);
+	platform::mapped_file_ptr view;
+	std::vector<uint64_t> offsets;
+
+	{
+		platform::shared_lock lock(_rw);
+		view = _view;
+		offsets.reserve(_items.size());
+		for (const auto& i : _items) offsets.emplace_back(i.second);
+	}
+
+	if (!view) return;
+
+	// keep file order so reads of neighbouring items stay close together
+	std::ranges::sort(offsets);
+
+	const auto data = view->data();
+	auto out = platform::open_file(temp_path, platform::file_open_mode::create);
+	bool success = out != nullptr;
+	uint64_t kept = 0;
+
+	for (const auto offset : offsets)
+	{
+		if (!success) break;
+
+		thumbnail_record header;
+
+		if (read_thumbnail_record(data, offset, header))
+		{
+			const auto* const text = std::bit_cast<const char8_t*>(data.data + offset + sizeof(header));
+
+			if (keep({ text, header.folder_len }, { text + header.folder_len, header.name_len }))
+			{
+				const auto size = header.record_size();
+				success = out->write(data.data + offset, size) == size;
+				kept += 1;
+			}
+		}
+	}
+
+	const auto removed = offsets.size() - kept;
+	const auto old_path = thumbnail_old_path(_path);
+
+	out.reset();
+	view.reset();
+
+	if (success)
+	{
+		// readers may still map the current file. A mapped file cannot be
+		// replaced or deleted but it can be renamed, so it is moved aside and
+		// the compacted file takes its name.
+		_file.reset();
+		platform::delete_file(old_path);
+		success = platform::move_file(_path, old_path, true).success();
+
+		if (success)
+		{
+			success = platform::move_file(temp_path, _path, true).success();
+			if (!success) platform::move_file(old_path, _path, true);
+		}
+
+		_file = platform::open_file(_path, platform::file_open_mode::append);
+	}
+
+	if (success)
+	{
+		// the new index is built before it replaces the old one, so lookups never miss
+		load_index();
+		df::log(__FUNCTION__, str::format(u8"Thumbnail store compacted {} kept {} removed"sv, kept, removed));
+	}
+	else
+	{
+		platform::delete_file(temp_path);
+		df::log(__FUNCTION__, u8"Thumbnail store compaction failed"sv);
+	}
+
+	// fails while a reader still maps the old file, open removes it later
+	platform::delete_file(old_path);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void database::open(const df::folder_path folder, const std::u8string_view file_name)
 {
 	sqlite3_initialize();
@@ -301,6 +627,16 @@ void database::open(const df::folder_path folder, const std::u8string_view file_
 	open();
 }
 
+static df::file_path thumbnails_path(const df::file_path db_path)
+{
+	return df::file_path(db_path.folder(), db_path.file_name_without_extension(), u8".thumbs"sv);
+}
+
+static df::file_size database_size(const df::file_path db_path, const thumbnail_store& thumbnails)
+{
+	return platform::file_attributes(db_path).size + df::file_size(thumbnails.size());
+}
+
 static std::u8string load_create_sql()
 {
 	auto sql = load_resource(platform::resource_item::sql);
@@ -345,21 +681,28 @@ void database::open()
 			throw app_exception(message);
 		}
 
+		// schema upgrades, before anything reads the added columns
+		sqlite3_exec(_db, "ALTER TABLE item_properties ADD COLUMN crc INTEGER;", nullptr, nullptr, nullptr);
+		sqlite3_exec(_db, "ALTER TABLE item_properties ADD COLUMN phash INTEGER;", nullptr, nullptr, nullptr);
+		sqlite3_exec(_db, "ALTER TABLE item_thumbnails ADD COLUMN cover_art BLOB NULL;", nullptr, nullptr, nullptr);
+
 		load_index_values();
 		df::log(__FUNCTION__, str::format(u8"Loaded index in {} ms"sv, _state.stats.index_load_ms));
 	}
 
-	// schema upgrades
-	sqlite3_exec(_db, "ALTER TABLE item_properties ADD COLUMN crc INTEGER;", nullptr, nullptr, nullptr);
-	sqlite3_exec(_db, "ALTER TABLE item_thumbnails ADD COLUMN cover_art BLOB NULL;", nullptr, nullptr, nullptr);
-
 	find_web_request = std::make_unique<db_statement>(_db, u8"select value from web_service_cache where key=?"s);
 	find_folder_thumbnail = std::make_unique<db_statement>(
 		_db, u8"select bitmap, cover_art, last_scanned from item_thumbnails where folder=?"s);
 	find_thumbnail = std::make_unique<db_statement>(
 		_db, u8"select bitmap, cover_art, last_scanned from item_thumbnails where folder=? AND name=?"s);
+	replace_properties = std::make_unique<db_statement>(
+		_db, u8"insert or replace into item_properties (folder, name, properties, crc, media_position, last_scanned, last_indexed, phash) values (?, ?, ?, ?, ?, ?, ?, ?)"s);
+	update_properties = std::make_unique<db_statement>(
+		_db, u8"update item_properties set crc = coalesce(?, crc), media_position = coalesce(?, media_position), phash = coalesce(?, phash) where folder=? and name=?"s);
+
+	_thumbnails.open(thumbnails_path(_db_path));
 
-	_state.stats.database_size = platform::file_attributes(_db_path).size;
+	_state.stats.database_size = database_size(_db_path, _thumbnails);
 	_state.stats.database_path = _db_path;
 	df::log(__FUNCTION__, str::format(u8"Index open {}"sv, _state.stats.database_size));
 }
@@ -374,6 +717,9 @@ void database::close()
 	find_web_request.reset();
 	find_folder_thumbnail.reset();
 	find_thumbnail.reset();
+	replace_properties.reset();
+	update_properties.reset();
+	_thumbnails.close();
 
 	if (_db != nullptr)
 	{
@@ -385,78 +731,58 @@ void database::close()
 
 inline void metadata_packer::pack(const prop::item_metadata_ptr& md)
 {
-	reset_to_header();
-
-	if (!prop::is_null(md->album)) write(prop::album.id, md->album);
-	if (!prop::is_null(md->album_artist)) write(prop::album_artist.id, md->album_artist);
-	if (!prop::is_null(md->artist)) write(prop::artist.id, md->artist);
-	if (!prop::is_null(md->audio_codec)) write(prop::audio_codec.id, md->audio_codec);
-	if (!prop::is_null(md->bitrate)) write(prop::bitrate.id, md->bitrate);
-	if (!prop::is_null(md->camera_manufacturer)) write(prop::camera_manufacturer.id, md->camera_manufacturer);
-	if (!prop::is_null(md->camera_model)) write(prop::camera_model.id, md->camera_model);
-	if (!prop::is_null(md->location_place)) write(prop::location_place.id, md->location_place);
-	if (!prop::is_null(md->comment)) write(prop::comment.id, md->comment);
-	if (!prop::is_null(md->copyright_creator)) write(prop::copyright_creator.id, md->copyright_creator);
-	if (!prop::is_null(md->copyright_credit)) write(prop::copyright_credit.id, md->copyright_credit);
-	if (!prop::is_null(md->copyright_notice)) write(prop::copyright_notice.id, md->copyright_notice);
-	if (!prop::is_null(md->copyright_source)) write(prop::copyright_source.id, md->copyright_source);
-	if (!prop::is_null(md->copyright_url)) write(prop::copyright_url.id, md->copyright_url);
-	if (!prop::is_null(md->location_country)) write(prop::location_country.id, md->location_country);
-	if (!prop::is_null(md->description)) write(prop::description.id, md->description);
-	if (!prop::is_null(md->file_name)) write(prop::file_name.id, md->file_name);
-	if (!prop::is_null(md->raw_file_name)) write(prop::raw_file_name.id, md->file_name);
-	if (!prop::is_null(md->genre)) write(prop::genre.id, md->genre);
-	if (!prop::is_null(md->lens)) write(prop::lens.id, md->lens);
-	if (!prop::is_null(md->pixel_format)) write(prop::pixel_format.id, md->pixel_format);
-	if (!prop::is_null(md->show)) write(prop::show.id, md->show);
-	if (!prop::is_null(md->location_state)) write(prop::location_state.id, md->location_state);
-	if (!prop::is_null(md->synopsis)) write(prop::synopsis.id, md->synopsis);
-	if (!prop::is_null(md->composer)) write(prop::composer.id, md->composer);
-	if (!prop::is_null(md->encoder)) write(prop::encoder.id, md->encoder);
-	if (!prop::is_null(md->publisher)) write(prop::publisher.id, md->publisher);
-	if (!prop::is_null(md->performer)) write(prop::performer.id, md->performer);
-	if (!prop::is_null(md->title)) write(prop::title.id, md->title);
-	if (!prop::is_null(md->tags)) write(prop::tag.id, md->tags);
-	if (!prop::is_null(md->video_codec)) write(prop::video_codec.id, md->video_codec);
-	if (!prop::is_null(md->game)) write(prop::game.id, md->game);
-	if (!prop::is_null(md->system)) write(prop::system.id, md->system);
-	if (!prop::is_null(md->label)) write(prop::label.id, md->label);
-	if (!prop::is_null(md->doc_id)) write(prop::doc_id.id, md->doc_id);
-
-	if (!prop::is_null(md->width) || !prop::is_null(md->height))
-		write(prop::dimensions.id,
-			df::xy32::make(md->width, md->height));
-	if (!prop::is_null(md->iso_speed)) write(prop::iso_speed.id, md->iso_speed);
-	if (!prop::is_null(md->focal_length)) write(prop::focal_length.id, md->focal_length);
-	if (!prop::is_null(md->focal_length_35mm_equivalent))
-		write(prop::focal_length_35mm_equivalent.id,
-			md->focal_length_35mm_equivalent);
-	if (!prop::is_null(md->rating)) write(prop::rating.id, md->rating);
-	if (!prop::is_null(md->audio_sample_rate)) write(prop::audio_sample_rate.id, md->audio_sample_rate);
-	if (!prop::is_null(md->audio_sample_type)) write(prop::audio_sample_type.id, md->audio_sample_type);
-	if (!prop::is_null(md->season)) write(prop::season.id, md->season);
-	if (!prop::is_null(md->track)) write(prop::track_num.id, md->track);
-	if (!prop::is_null(md->disk)) write(prop::disk_num.id, md->disk);
-	if (!prop::is_null(md->duration)) write(prop::duration.id, md->duration);
-	if (!prop::is_null(md->episode)) write(prop::episode.id, md->episode);
-	if (!prop::is_null(md->exposure_time)) write(prop::exposure_time.id, md->exposure_time);
-	if (!prop::is_null(md->f_number)) write(prop::f_number.id, md->f_number);
-
-	if (!prop::is_null(md->created_exif)) write(prop::created_exif.id, md->created_exif.to_int64());
-	if (!prop::is_null(md->created_digitized)) write(prop::created_digitized.id, md->created_digitized.to_int64());
-	if (!prop::is_null(md->created_utc)) write(prop::created_utc.id, md->created_utc.to_int64());
-	if (!prop::is_null(md->year)) write(prop::year.id, md->year);
-
-	if (md->coordinate.is_valid())
-	{
-		write(prop::latitude.id, md->coordinate.latitude());
-		write(prop::longitude.id, md->coordinate.longitude());
-	}
-
-	if (md->orientation != ui::orientation::top_left && md->orientation != ui::orientation::none)
-	{
-		const auto val = static_cast<uint8_t>(md->orientation);
-		write(prop::orientation.id, val);
+	// numbers are compared with a default item to find the ones worth writing
+	static const prop::item_metadata defaults;
+	static const auto default_numbers = []
+		{
+			std::array<const void*, 32> result{};
+			size_t n = 0;
+			metadata_pack_v2::for_each_number(defaults, [&](const auto& v) { result[n++] = &v; });
+			return result;
+		}();
+
+	reset_to_header(metadata_pack_v2::version);
+
+	uint64_t present = 0;
+
+	for (size_t i = 0; i < metadata_pack_v2::strings.size(); ++i)
+	{
+		const auto& v = (*md).*metadata_pack_v2::strings[i];
+		if (!prop::is_null(v) && v.size() < df::one_meg) present |= 1ull << i;
+	}
+
+	uint32_t present_numbers = 0;
+	size_t n = 0;
+
+	metadata_pack_v2::for_each_number(*md, [&](const auto& v)
+		{
+			if (memcmp(&v, default_numbers[n], sizeof(v)) != 0) present_numbers |= 1u << n;
+			n += 1;
+		});
+
+	if (present_numbers) present |= metadata_pack_v2::has_numbers;
+	write_bytes(&present, sizeof(present));
+
+	if (present_numbers)
+	{
+		write_bytes(&present_numbers, sizeof(present_numbers));
+		n = 0;
+
+		metadata_pack_v2::for_each_number(*md, [&](const auto& v)
+			{
+				if (present_numbers & (1u << n)) write_bytes(&v, sizeof(v));
+				n += 1;
+			});
+	}
+
+	for (size_t i = 0; i < metadata_pack_v2::strings.size(); ++i)
+	{
+		if (present & (1ull << i))
+		{
+			const auto& v = (*md).*metadata_pack_v2::strings[i];
+			write_len(v.size());
+			write_bytes(v.sz(), v.size());
+		}
 	}
 }
 
@@ -488,6 +814,93 @@ void database::clean(const std::vector<df::file_path>& indexed_items) const
 }
 
 void metadata_unpacker::unpack(const prop::item_metadata_ptr& md)
+{
+	if (_version == metadata_pack_v2::version)
+	{
+		unpack_v2(md);
+	}
+	else
+	{
+		unpack_v1(md);
+	}
+}
+
+str::cached metadata_unpacker::intern(const size_t field, const std::u8string_view text)
+{
+	if (_recent)
+	{
+		auto& recent = (*_recent)[field];
+		if (recent != text) recent = str::cache(text);
+		return recent;
+	}
+
+	return str::cache(text);
+}
+
+void metadata_unpacker::unpack_v2(const prop::item_metadata_ptr& md)
+{
+	if (remaining() < sizeof(uint64_t))
+	{
+		return;
+	}
+
+	uint64_t present = 0;
+	memcpy(&present, _data.data + _pos, sizeof(present));
+	_pos += sizeof(present);
+
+	if (present & metadata_pack_v2::has_numbers)
+	{
+		uint32_t present_numbers = 0;
+
+		if (remaining() < sizeof(present_numbers))
+		{
+			return;
+		}
+
+		memcpy(&present_numbers, _data.data + _pos, sizeof(present_numbers));
+		_pos += sizeof(present_numbers);
+
+		size_t n = 0;
+		auto is_valid = true;
+
+		metadata_pack_v2::for_each_number(*md, [&](auto& v)
+			{
+				if (is_valid && (present_numbers & (1u << n)))
+				{
+					if (remaining() < sizeof(v))
+					{
+						is_valid = false;
+					}
+					else
+					{
+						memcpy(&v, _data.data + _pos, sizeof(v));
+						_pos += sizeof(v);
+					}
+				}
+
+				n += 1;
+			});
+
+		if (!is_valid)
+		{
+			return;
+		}
+	}
+
+	for (size_t i = 0; i < metadata_pack_v2::strings.size(); ++i)
+	{
+		if (present & (1ull << i))
+		{
+			size_t len = 0;
+			if (!read_len_checked(len)) break;
+
+			(*md).*metadata_pack_v2::strings[i] = intern(i, { std::bit_cast<const char8_t*>(_data.data + _pos), len });
+			_pos += len;
+		}
+	}
+}
+
+void metadata_unpacker::unpack_v1(const prop::item_metadata_ptr& md)
 {
 	prop::key_ref t;
 
@@ -566,57 +979,69 @@ void metadata_unpacker::unpack(const prop::item_metadata_ptr& md)
 	}
 }
 
-void database::load_index_values()
+// Rows read from item_properties are copied into batches of whole folders so
+// the statement can keep stepping while workers unpack and merge them.
+struct index_load_row
 {
-	df::assert_true(is_db_thread());
-
-	df::measure_ms ms(_state.stats.index_load_ms);
+	uint32_t name_offset = 0;
+	uint32_t name_size = 0;
+	uint32_t properties_offset = 0;
+	uint32_t properties_size = 0;
+	uint32_t crc32c = 0;
+	uint64_t phash = 0;
+	int media_position = 0;
+	df::date_t last_scanned;
+};
 
-	df::folder_path last_group_name;
-	db_items_t cached_items;
-	cached_items.reserve(1000);
+struct index_load_folder
+{
+	df::folder_path path;
+	size_t first = 0;
+	size_t last = 0;
+};
 
-	const db_statement items(
-		_db,
-		u8"select folder, name, properties, crc, media_position, last_scanned from item_properties order by folder"s);
+struct index_load_batch
+{
+	std::vector<index_load_folder> folders;
+	std::vector<index_load_row> rows;
+	std::vector<uint8_t> data;
 
-	while (items.read() && !df::is_closing)
+	uint32_t append(const uint8_t* p, const size_t size)
 	{
-		const auto folder = df::folder_path(items.text(0));
-		const auto name = str::cache(items.text(1));
-		const auto properties = items.data(2);
-		const auto crc = static_cast<uint32_t>(items.int32(3));
-		const auto media_position = items.int32(4);
-		const auto last_scanned = df::date_t(items.int64(5));
+		const auto offset = static_cast<uint32_t>(data.size());
+		data.insert(data.end(), p, p + size);
+		return offset;
+	}
 
-		if (last_group_name != folder)
-		{
-			if (!cached_items.empty())
-			{
-				std::ranges::sort(cached_items, [](const db_item_t& left, const db_item_t& right)
-					{
-						return icmp(left.path, right.path) < 0;
-					});
-				_state.merge_folder(last_group_name, cached_items);
-			}
+	bool empty() const
+	{
+		return rows.empty();
+	}
+};
 
-			cached_items.clear();
-			last_group_name = folder;
-		}
+static void load_index_folder(index_state& state, const index_load_batch& batch, const index_load_folder& folder)
+{
+	db_items_t cached_items;
+	cached_items.reserve(folder.last - folder.first);
+	metadata_pack_v2::recent_strings recent;
 
+	for (auto r = folder.first; r < folder.last; ++r)
+	{
+		const auto& row = batch.rows[r];
+		const auto name = str::cache(std::u8string_view(
+			std::bit_cast<const char8_t*>(batch.data.data() + row.name_offset), row.name_size));
 		const auto* const ft = files::file_type_from_name(name);
 
 		if (ft->can_cache())
 		{
-			metadata_unpacker unpacker(properties);
-
 			db_item_t i;
 			i.path = name;
-			i.metadata_scanned = last_scanned;
-			i.crc32c = static_cast<uint32_t>(crc);
+			i.metadata_scanned = row.last_scanned;
+			i.crc32c = row.crc32c;
+			i.phash = row.phash;
 
-			const auto has_properties = properties.size > 0;
-			const auto has_med_pos = media_position != 0;
+			const auto has_properties = row.properties_size > 0;
+			const auto has_med_pos = row.media_position != 0;
 
 			if (has_properties || has_med_pos)
 			{
@@ -624,12 +1049,13 @@ void database::load_index_values()
 
 				if (has_properties)
 				{
+					metadata_unpacker unpacker({ batch.data.data() + row.properties_offset, row.properties_size }, &recent);
 					unpacker.unpack(i.metadata);
 				}
 
 				if (has_med_pos)
 				{
-					i.metadata->media_position = media_position;
+					i.metadata->media_position = row.media_position;
 				}
 			}
 
@@ -643,22 +1069,165 @@ void database::load_index_values()
 			{
 				return icmp(left.path, right.path) < 0;
 			});
-		_state.merge_folder(last_group_name, cached_items);
-		cached_items.clear();
+		state.merge_folder(folder.path, cached_items);
 	}
+}
+
+static void load_index_batch(index_state& state, const index_load_batch& batch)
+{
+	for (const auto& folder : batch.folders)
+	{
+		if (df::is_closing) break;
+		load_index_folder(state, batch, folder);
+	}
+}
+
+void database::load_index_values(const size_t max_workers)
+{
+	df::assert_true(is_db_thread());
+
+	df::measure_ms ms(_state.stats.index_load_ms);
+
+	constexpr size_t batch_rows = 4096;
+
+	const db_statement items(
+		_db,
+		u8"select folder, name, properties, crc, media_position, last_scanned, phash from item_properties order by folder"s);
+
+	auto& pool = platform::default_work_pool();
+	const auto worker_count = max_workers ? std::min(max_workers, pool.worker_count()) : pool.worker_count();
+	const auto max_queued = worker_count * 2;
+
+	platform::queue<index_load_batch> batches;
+	platform::thread_event batch_ready(false, false);
+	std::atomic<size_t> queued = 0;
+	std::atomic_bool reading = true;
+
+	auto process_next = [this, &batches, &queued]
+		{
+			index_load_batch batch;
+			if (!batches.dequeue(batch)) return false;
+			--queued;
+			load_index_batch(_state, batch);
+			return true;
+		};
+
+	auto read_items = [&]
+		{
+			index_load_batch batch;
+			df::folder_path last_folder;
+
+			auto close_folder = [&batch]
+				{
+					if (!batch.folders.empty()) batch.folders.back().last = batch.rows.size();
+				};
+
+			auto submit = [&]
+				{
+					close_folder();
+					batches.enqueue(std::move(batch));
+					batch = {};
+					++queued;
+					batch_ready.set();
+
+					// the reader helps out rather than letting batches pile up
+					while (queued >= max_queued && process_next())
+					{
+					}
+				};
+
+			while (items.read() && !df::is_closing)
+			{
+				const auto folder = df::folder_path(items.text(0));
+
+				if (batch.folders.empty() || last_folder != folder)
+				{
+					if (batch.rows.size() >= batch_rows)
+					{
+						submit();
+					}
+
+					close_folder();
+					batch.folders.emplace_back(index_load_folder{ folder, batch.rows.size() });
+					last_folder = folder;
+				}
+
+				const auto name = items.text(1);
+				const auto properties = items.data(2);
+
+				index_load_row row;
+				row.name_size = static_cast<uint32_t>(name.size());
+				row.name_offset = batch.append(std::bit_cast<const uint8_t*>(name.data()), name.size());
+				row.properties_size = static_cast<uint32_t>(properties.size);
+				row.properties_offset = batch.append(properties.data, properties.size);
+				row.crc32c = static_cast<uint32_t>(items.int32(3));
+				row.media_position = items.int32(4);
+				row.last_scanned = df::date_t(items.int64(5));
+				row.phash = static_cast<uint64_t>(items.int64(6));
+				batch.rows.emplace_back(row);
+			}
+
+			if (!batch.empty())
+			{
+				submit();
+			}
+
+			reading = false;
+			batch_ready.set();
+
+			while (process_next())
+			{
+			}
+		};
+
+	// index 0 is the reader on this thread, the rest decode and merge folders as
+	// batches arrive. If the pool is busy everything runs here in order.
+	pool.parallel_for(worker_count, 1, [&](size_t, const size_t begin, const size_t end)
+		{
+			for (auto i = begin; i < end; ++i)
+			{
+				if (i == 0)
+				{
+					read_items();
+				}
+				else
+				{
+					while (process_next() || reading)
+					{
+						if (queued == 0 && reading)
+						{
+							platform::wait_for({ batch_ready }, 10, false);
+						}
+					}
+				}
+			}
+		});
 
 	_state.cache_load_complete();
 }
 
 database::db_thumbnail database::load_thumbnail(const df::file_path id) const
 {
-	df::assert_true(is_db_thread());
+	db_thumbnail result;
+	thumbnail_store::entry found;
+
+	if (_thumbnails.find(id, found))
+	{
+		result.thumb = load_image_file(found.thumb);
+		result.cover_art = load_image_file(found.cover_art);
+		result.last_indexed = found.last_scanned;
+		return result;
+	}
+
+	// rows written before the thumbnail store are read until maintenance moves them
+	if (!is_db_thread())
+	{
+		return result;
+	}
 
 	find_thumbnail->bind(1, id.folder().text());
 	find_thumbnail->bind(2, id.name());
 
-	db_thumbnail result;
-
 	while (find_thumbnail->read())
 	{
 		result.thumb = load_image_file(find_thumbnail->blob(0));
@@ -673,9 +1242,21 @@ database::db_thumbnail database::load_thumbnail(const df::file_path id) const
 
 database::db_thumbnail database::load_folder_thumbnail(const str::cached folder) const
 {
-	df::assert_true(is_db_thread());
-
 	db_thumbnail result;
+	thumbnail_store::entry found;
+
+	if (_thumbnails.find_folder(df::folder_path(folder), found))
+	{
+		result.thumb = load_image_file(found.thumb);
+		result.cover_art = load_image_file(found.cover_art);
+		result.last_indexed = found.last_scanned;
+		return result;
+	}
+
+	if (!is_db_thread())
+	{
+		return result;
+	}
 
 	find_folder_thumbnail->bind(1, folder);
 
@@ -770,7 +1351,6 @@ bool database::is_db_thread() const
 
 void database::load_thumbnails(const index_state& index, const df::item_set& items)
 {
-	df::assert_true(is_db_thread());
 	bool cover_art_loaded = false;
 
 	for (const auto& i : items.items())
@@ -830,101 +1410,243 @@ void database::perform_writes()
 	perform_writes(_state.db_writes().dequeue_all());
 }
 
+// All queued writes for a path folded into one row. A metadata write or a
+// bare metadata_scanned write replaces the whole row, crc, phash and media
+// position writes only update it.
+struct coalesced_write
+{
+	df::file_path path;
+	bool replace = false;
+	std::optional<prop::item_metadata_ptr> md;
+	std::optional<uint32_t> crc32c;
+	std::optional<uint64_t> phash;
+	std::optional<double> media_position;
+	std::optional<df::date_t> metadata_scanned;
+
+	void apply(item_db_write& write)
+	{
+		if (write.md.has_value())
+		{
+			const auto& md = write.md.value();
+			replace = true;
+			this->md = md;
+			crc32c = write.crc32c.value_or(0);
+			phash = write.phash;
+			media_position = write.media_position.value_or(md ? md->media_position : 0.0);
+			metadata_scanned = write.metadata_scanned.value_or(df::date_t());
+			return;
+		}
+
+		if (write.metadata_scanned.has_value())
+		{
+			replace = true;
+			md.reset();
+			crc32c.reset();
+			phash.reset();
+			media_position.reset();
+			metadata_scanned = write.metadata_scanned;
+		}
+
+		if (write.crc32c.has_value()) crc32c = write.crc32c;
+		if (write.phash.has_value()) phash = write.phash;
+		if (write.media_position.has_value()) media_position = write.media_position;
+	}
+};
+
+struct coalesced_thumbnail
+{
+	df::file_path path;
+	ui::const_image_ptr thumb;
+	ui::const_image_ptr cover_art;
+	df::date_t thumb_scanned;
+};
+
+constexpr int64_t write_interval_ms = 1000;
+constexpr size_t max_pending_writes = 4096;
+constexpr int64_t database_size_interval_ms = 10000;
+
+bool database::writes_due() const
+{
+	return (df::now_ms() - _last_write_ms) >= write_interval_ms ||
+		_state.db_writes().size() >= max_pending_writes;
+}
+
 void database::perform_writes(std::deque<item_db_write> writes)
 {
+	df::assert_true(is_db_thread());
+
+	const auto now_ms = df::now_ms();
+	_last_write_ms = now_ms;
+
+	if (writes.empty() || !_db)
+	{
+		return;
+	}
+
 	const auto today = platform::now().to_days();
 
-	transaction t(_db);
-	const db_statement insert_properties(
-		_db,
-		u8"insert or replace into item_properties (folder, name, properties, hash, crc, media_position, last_scanned, last_indexed) values (?, ?, ?, ?, ?, ?, ?, ?)"s);
-	const db_statement update_metadata_scanned(
-		_db, u8"insert or replace into item_properties (folder, name, last_scanned, last_indexed) values (?, ?, ?, ?)"s);
-	const db_statement update_hash(_db, u8"update item_properties set hash = ? where folder=? and name=?"s);
-	const db_statement update_crc(_db, u8"update item_properties set crc = ? where folder=? and name=?"s);
-	const db_statement update_media_position(
-		_db, u8"update item_properties set media_position = ? where folder=? and name=?"s);
-	const db_statement insert_thumbnails(
-		_db, u8"insert or replace into item_thumbnails (folder, name, bitmap, cover_art, last_scanned) values (?, ?, ?, ?, ?)"s);
-
-	metadata_packer packer;
+	std::vector<coalesced_write> rows;
+	std::vector<coalesced_thumbnail> thumbnails;
+	df::hash_map<df::file_path, size_t, df::ihash, df::ieq> row_index;
+	df::hash_map<df::file_path, size_t, df::ihash, df::ieq> thumbnail_index;
 
 	for (auto&& write : writes)
 	{
-		const auto path = write.path;
+		if (write.md.has_value() || write.metadata_scanned.has_value() || write.crc32c.has_value() ||
+			write.phash.has_value() || write.media_position.has_value())
+		{
+			const auto inserted = row_index.try_emplace(write.path, rows.size());
+			if (inserted.second) rows.emplace_back().path = write.path;
+			rows[inserted.first->second].apply(write);
+		}
 
-		if (write.md.has_value())
+		if (write.thumb.has_value() && is_valid(write.thumb.value()))
 		{
-			const auto md = write.md.value();
+			const auto inserted = thumbnail_index.try_emplace(write.path, thumbnails.size());
+			if (inserted.second) thumbnails.emplace_back().path = write.path;
 
-			if (md)
-			{
-				packer.pack(md);
-			}
+			auto& t = thumbnails[inserted.first->second];
+			t.thumb = write.thumb.value();
+			t.cover_art = write.cover_art.has_value() ? write.cover_art.value() : nullptr;
+			t.thumb_scanned = write.thumb_scanned.value_or(df::date_t());
+		}
+	}
 
-			// df::log(__FUNCTION__, "write to db "sv << id.Name << "sv "sv << id.Modified.to_int64() << "sv "sv << properties_row.count();
+	_state.stats.writes_received += static_cast<int>(writes.size());
 
-			insert_properties.bind(1, path.folder().text());
-			insert_properties.bind(2, path.name());
-			insert_properties.bind(3, packer.cdata());
-			insert_properties.bind(4, df::cspan{ nullptr, 0 });
-			insert_properties.bind(5, static_cast<int>(write.crc32c.value_or(0)));
-			insert_properties.bind(6, static_cast<int>(write.media_position.value_or(md->media_position)));
-			insert_properties.bind(7, write.metadata_scanned.value_or(df::date_t()).to_int64());
-			insert_properties.bind(8, today);
-			insert_properties.exec();
-			insert_properties.reset();
+	if (!rows.empty())
+	{
+		transaction t(_db);
+		metadata_packer packer;
 
-			write.crc32c.reset();
-			write.metadata_scanned.reset();
-			write.media_position.reset();
+		for (const auto& row : rows)
+		{
+			const auto folder = row.path.folder();
 
-			++_state.stats.items_saved;
-		}
+			if (row.replace)
+			{
+				// unbound parameters are null
+				replace_properties->bind(1, folder.text());
+				replace_properties->bind(2, row.path.name());
 
-		if (write.metadata_scanned.has_value())
-		{
-			update_metadata_scanned.bind(1, path.folder().text());
-			update_metadata_scanned.bind(2, path.name());
-			update_metadata_scanned.bind(3, write.metadata_scanned.value().to_int64());
-			update_metadata_scanned.bind(4, today);
-			update_metadata_scanned.exec();
-			update_metadata_scanned.reset();
+				if (row.md.has_value())
+				{
+					if (row.md.value())
+					{
+						packer.pack(row.md.value());
+					}
+					else
+					{
+						packer.reset_to_header();
+					}
+
+					replace_properties->bind(3, packer.cdata());
+					++_state.stats.items_saved;
+				}
+
+				if (row.crc32c.has_value()) replace_properties->bind(4, static_cast<int>(row.crc32c.value()));
+				if (row.media_position.has_value())
+					replace_properties->bind(
+						5, static_cast<int>(row.media_position.value()));
+				if (row.metadata_scanned.has_value())
+					replace_properties->bind(
+						6, row.metadata_scanned.value().to_int64());
+				replace_properties->bind(7, today);
+				if (row.phash.has_value()) replace_properties->bind(8, row.phash.value());
+				replace_properties->exec();
+				replace_properties->reset();
+			}
+			else
+			{
+				if (row.crc32c.has_value()) update_properties->bind(1, static_cast<int>(row.crc32c.value()));
+				if (row.media_position.has_value())
+					update_properties->bind(
+						2, static_cast<int>(row.media_position.value()));
+				if (row.phash.has_value()) update_properties->bind(3, row.phash.value());
+				update_properties->bind(4, folder.text());
+				update_properties->bind(5, row.path.name());
+				update_properties->exec();
+				update_properties->reset();
+			}
 		}
 
-		if (write.crc32c.has_value())
+		_state.stats.write_statements += static_cast<int>(rows.size());
+	}
+
+	// thumbnails are large so they go to the thumbnail store, not SQLite
+	if (!thumbnails.empty())
+	{
+		for (const auto& thumbnail : thumbnails)
 		{
-			update_crc.bind(1, static_cast<int>(write.crc32c.value()));
-			update_crc.bind(2, path.folder().text());
-			update_crc.bind(3, path.name());
-			update_crc.exec();
-			update_crc.reset();
+			_thumbnails.append(thumbnail.path, thumbnail.thumb->data(),
+				is_valid(thumbnail.cover_art) ? thumbnail.cover_art->data() : df::cspan{}, thumbnail.thumb_scanned);
+
+			++_state.stats.thumbs_saved;
 		}
 
-		if (write.media_position.has_value())
+		_thumbnails.flush();
+	}
+
+	if (now_ms - _last_size_ms >= database_size_interval_ms)
+	{
+		_state.stats.database_size = database_size(_db_path, _thumbnails);
+		_last_size_ms = now_ms;
+	}
+}
+
+void database::migrate_thumbnails()
+{
+	df::assert_true(is_db_thread());
+
+	if (!_thumbnails.is_open())
+	{
+		return;
+	}
+
+	int count = 0;
+	std::vector<std::pair<std::u8string, std::u8string>> moved;
+
+	{
+		const db_statement thumbnails(_db, u8"select folder, name, bitmap, cover_art, last_scanned from item_thumbnails"s);
+
+		while (thumbnails.read() && !df::is_closing)
 		{
-			update_media_position.bind(1, static_cast<int>(write.media_position.value()));
-			update_media_position.bind(2, path.folder().text());
-			update_media_position.bind(3, path.name());
-			update_media_position.exec();
-			update_media_position.reset();
+			const auto folder = thumbnails.text(0);
+			const auto name = thumbnails.text(1);
+			const auto id = df::file_path(df::folder_path(folder), name);
+			thumbnail_store::entry existing;
+
+			if (_thumbnails.find(id, existing))
+			{
+				moved.emplace_back(folder, name);
+			}
+			else if (_thumbnails.append(id, thumbnails.data(2), thumbnails.data(3), df::date_t(thumbnails.int64(4))))
+			{
+				moved.emplace_back(folder, name);
+				count += 1;
+			}
 		}
+	}
 
-		if (write.thumb.has_value() && is_valid(write.thumb.value()))
-		{
-			insert_thumbnails.bind(1, path.folder().text());
-			insert_thumbnails.bind(2, path.name());
-			insert_thumbnails.bind(3, write.thumb.value()->data());
-			insert_thumbnails.bind(4, (write.cover_art.has_value() && is_valid(write.cover_art.value())) ? write.cover_art.value()->data() : df::cspan{});
-			insert_thumbnails.bind(5, write.thumb_scanned.has_value() ? write.thumb_scanned.value().to_int64() : 0);
-			insert_thumbnails.exec();
-			insert_thumbnails.reset();
+	// rows are only dropped once their thumbnails can be read back from the store
+	if (_thumbnails.flush() && !moved.empty())
+	{
+		transaction t(_db);
+		const db_statement remove(_db, u8"DELETE FROM item_thumbnails WHERE folder = ? AND name = ?"s);
 
-			++_state.stats.thumbs_saved;
+		for (const auto& m : moved)
+		{
+			remove.bind(1, m.first);
+			remove.bind(2, m.second);
+			remove.exec();
+			remove.reset();
 		}
 	}
 
-	_state.stats.database_size = platform::file_attributes(_db_path).size;
+	if (count > 0)
+	{
+		df::log(__FUNCTION__, str::format(u8"Moved {} thumbnails to the thumbnail store"sv, count));
+	}
 }
 
 bool database::has_errors() const
@@ -941,6 +1663,7 @@ void database::maintenance(bool is_reset)
 		close();
 
 		const auto delete_result = platform::delete_file(_db_path);
+		platform::delete_file(thumbnails_path(_db_path));
 
 		if (delete_result.success())
 		{
@@ -951,8 +1674,26 @@ void database::maintenance(bool is_reset)
 		open();
 	}
 
+	migrate_thumbnails();
+
+	df::hash_set<std::u8string> known_items;
+
+	{
+		const db_statement items(_db, u8"select folder, name from item_properties"s);
+
+		while (items.read())
+		{
+			known_items.emplace(thumbnail_key(items.text(0), items.text(1)));
+		}
+	}
+
+	_thumbnails.compact([&known_items](const std::u8string_view folder, const std::u8string_view name)
+		{
+			return known_items.contains(thumbnail_key(folder, name));
+		});
+
 	db_exec(_db, u8"vacuum;"s);
-	_state.stats.database_size = platform::file_attributes(_db_path).size;
+	_state.stats.database_size = database_size(_db_path, _thumbnails);
 
 	close();
 	open();
@@ -57,6 +57,56 @@ struct item_import_eq
 
 using item_import_set = df::hash_set<item_import, item_import_hash, item_import_eq>;
 
+// Append-only pack of thumbnail and cover art images kept next to the
+// database. Records are read through a memory mapping so lookups never touch
+// SQLite and can run on any thread. Appends and compaction are db thread only.
+class thumbnail_store : public df::no_copy
+{
+public:
+	struct entry
+	{
+		platform::mapped_file_ptr view; // keeps thumb and cover_art valid
+		df::cspan thumb;
+		df::cspan cover_art;
+		df::date_t last_scanned;
+	};
+
+	void open(df::file_path path);
+	void close();
+
+	bool find(df::file_path id, entry& result) const;
+	bool find_folder(df::folder_path folder, entry& result) const;
+
+	bool is_open() const
+	{
+		return _file != nullptr;
+	}
+
+	bool append(df::file_path id, df::cspan thumb, df::cspan cover_art, df::date_t last_scanned);
+	bool flush();
+	void compact(const std::function<bool(std::u8string_view folder, std::u8string_view name)>& keep);
+
+	uint64_t size() const
+	{
+		return _end;
+	}
+
+private:
+	bool read_entry(const platform::mapped_file_ptr& view, uint64_t offset, entry& result) const;
+	void load_index();
+
+	mutable platform::mutex _rw;
+	df::file_path _path;
+	platform::file_ptr _file;
+	uint64_t _end = 0;
+	uint64_t _reserved = 0; // file size including zeroed space kept for appends
+	std::vector<std::pair<std::u8string, uint64_t>> _pending;
+
+	_Guarded_by_(_rw) platform::mapped_file_ptr _view;
+	_Guarded_by_(_rw) df::hash_map<std::u8string, uint64_t> _items;
+	_Guarded_by_(_rw) df::hash_map<std::u8string, uint64_t> _folders;
+};
+
 class database : public df::no_copy
 {
 	index_state& _state;
@@ -67,8 +117,16 @@ class database : public df::no_copy
 	std::unique_ptr<db_statement> find_web_request;
 	std::unique_ptr<db_statement> find_folder_thumbnail;
 	std::unique_ptr<db_statement> find_thumbnail;
+	std::unique_ptr<db_statement> replace_properties;
+	std::unique_ptr<db_statement> update_properties;
+
+	thumbnail_store _thumbnails;
+
+	int64_t _last_write_ms = 0;
+	int64_t _last_size_ms = 0;
 
 	bool is_db_thread() const;
+	void migrate_thumbnails();
 
 public:
 	struct db_thumbnail
@@ -89,7 +147,7 @@ public:
 	~database();
 
 	bool is_open() const;
-	void load_index_values();
+	void load_index_values(size_t max_workers = 0);
 
 	bool has_errors() const;
 
@@ -107,6 +165,7 @@ public:
 	void load_thumbnails(const index_state& index, const df::item_set& items);
 	void open();
 	void open(df::folder_path folder, std::u8string_view file_name);
+	bool writes_due() const;
 	void perform_writes();
 	void perform_writes(std::deque<item_db_write> writes);
 	void maintenance(bool is_reset);
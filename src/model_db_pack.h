@@ -9,6 +9,94 @@
 
 #pragma once
 
+// Version 2 blobs start with a presence bitmap. Bit i marks strings[i] as
+// present and has_numbers marks a numbers block that follows the bitmap. The
+// block is a 32 bit mask, bit i marking number i of for_each_number, followed
+// by the raw bytes of each number that differs from its default. Present
+// strings follow as length + text in bitmap order. The on-disk order of
+// strings and numbers must not change, new fields go at the end.
+namespace metadata_pack_v2
+{
+	constexpr uint8_t version = 2;
+	constexpr uint64_t has_numbers = 1ull << 63;
+
+	template <typename MD, typename F>
+	void for_each_number(MD& md, F&& f)
+	{
+		f(md.coordinate._latitude);
+		f(md.coordinate._longitude);
+		f(md.created_digitized._i);
+		f(md.created_exif._i);
+		f(md.created_utc._i);
+		f(md.exposure_time);
+		f(md.f_number);
+		f(md.focal_length);
+		f(md.duration);
+		f(md.focal_length_35mm_equivalent);
+		f(md.width);
+		f(md.height);
+		f(md.iso_speed);
+		f(md.rating);
+		f(md.audio_channels);
+		f(md.audio_sample_rate);
+		f(md.audio_sample_type);
+		f(md.year);
+		f(md.season);
+		f(md.orientation);
+		f(md.disk.x);
+		f(md.disk.y);
+		f(md.episode.x);
+		f(md.episode.y);
+		f(md.track.x);
+		f(md.track.y);
+	}
+
+	using string_member = str::cached prop::item_metadata::*;
+
+	constexpr std::array<string_member, 35> strings = {
+		&prop::item_metadata::album,
+		&prop::item_metadata::album_artist,
+		&prop::item_metadata::artist,
+		&prop::item_metadata::audio_codec,
+		&prop::item_metadata::bitrate,
+		&prop::item_metadata::camera_manufacturer,
+		&prop::item_metadata::camera_model,
+		&prop::item_metadata::comment,
+		&prop::item_metadata::composer,
+		&prop::item_metadata::copyright_creator,
+		&prop::item_metadata::copyright_credit,
+		&prop::item_metadata::copyright_url,
+		&prop::item_metadata::copyright_notice,
+		&prop::item_metadata::copyright_source,
+		&prop::item_metadata::description,
+		&prop::item_metadata::encoder,
+		&prop::item_metadata::file_name,
+		&prop::item_metadata::genre,
+		&prop::item_metadata::lens,
+		&prop::item_metadata::location_place,
+		&prop::item_metadata::location_country,
+		&prop::item_metadata::location_state,
+		&prop::item_metadata::performer,
+		&prop::item_metadata::pixel_format,
+		&prop::item_metadata::publisher,
+		&prop::item_metadata::show,
+		&prop::item_metadata::synopsis,
+		&prop::item_metadata::title,
+		&prop::item_metadata::video_codec,
+		&prop::item_metadata::raw_file_name,
+		&prop::item_metadata::tags,
+		&prop::item_metadata::game,
+		&prop::item_metadata::system,
+		&prop::item_metadata::label,
+		&prop::item_metadata::doc_id,
+	};
+
+	static_assert(strings.size() < 63);
+
+	// Values interned by the previous unpack. Neighbouring rows often repeat the
+	// same camera, codec or album so this skips most string table lookups.
+	using recent_strings = std::array<str::cached, strings.size()>;
+}
 
 class metadata_packer
 {
@@ -16,12 +104,12 @@ public:
 	std::vector<uint8_t> _data;
 
 public:
-	void reset_to_header()
+	void reset_to_header(const uint8_t version = metadata_pack_v2::version)
 	{
 		_data.clear();
 		_data.reserve(256);
 		_data.push_back(0xff); // marker
-		_data.push_back(0x01); // version
+		_data.push_back(version);
 	}
 
 	metadata_packer()
@@ -96,6 +184,12 @@ public:
 		}
 	}
 
+	void write_bytes(const void* data, const size_t size)
+	{
+		const auto* const src = static_cast<const uint8_t*>(data);
+		_data.insert(_data.end(), src, src + size);
+	}
+
 	void pack(const prop::item_metadata_ptr& md);
 };
 
@@ -105,9 +199,11 @@ class metadata_unpacker
 	const df::cspan _data;
 	size_t _pos = 2;
 	uint32_t _version = 0;
+	metadata_pack_v2::recent_strings* _recent = nullptr;
 
 public:
-	metadata_unpacker(const df::cspan data) : _data(data)
+	metadata_unpacker(const df::cspan data, metadata_pack_v2::recent_strings* recent = nullptr) : _data(data),
+		_recent(recent)
 	{
 		if (_data.size >= 2 && _data.data[0] == 0xFF)
 		{
@@ -115,6 +211,11 @@ public:
 		}
 	}
 
+	uint32_t version() const
+	{
+		return _version;
+	}
+
 	size_t remaining() const
 	{
 		return (_pos >= _data.size) ? 0 : _data.size - _pos;
@@ -173,5 +274,20 @@ public:
 		_pos += ser_len;
 	}
 
+	bool read_len_checked(size_t& result)
+	{
+		if (remaining() < 1) return false;
+		const auto marker = _data.data[_pos];
+		const size_t needed = marker == 0xFF ? 3 : (marker == 0xFE ? 5 : 1);
+		if (remaining() < needed) return false;
+		result = read_len();
+		return remaining() >= result;
+	}
+
 	void unpack(const prop::item_metadata_ptr& md);
+
+private:
+	void unpack_v1(const prop::item_metadata_ptr& md);
+	void unpack_v2(const prop::item_metadata_ptr& md);
+	str::cached intern(size_t field, std::u8string_view text);
 };
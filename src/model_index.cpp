@@ -92,12 +92,534 @@ struct dup_index_eq
 
 static auto next_dup_group = 1000u;
 
-static __forceinline uint32_t x64to32(const uint64_t n)
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+// Words break on ascii punctuation and white space only. Non-ascii characters
+// can normalize to ascii letters so they must stay inside a word.
+static constexpr bool is_term_char(const char8_t c)
+{
+	return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static constexpr bool is_ascii_term_char(const char8_t c)
+{
+	return c < 0x80 && is_term_char(c);
+}
+
+template <typename P, typename F>
+static void split_terms(const std::u8string_view text, const P& pred, F&& f)
+{
+	size_t start = 0;
+
+	for (size_t i = 0; i <= text.size(); ++i)
+	{
+		if (i == text.size() || !pred(text[i]))
+		{
+			if (i > start) f(text.substr(start, i - start));
+			start = i + 1;
+		}
+	}
+}
+
+// The longest run of ascii letters and digits in a search term.
+// Any text that contains, equals or wildcard matches the term contains this run
+// inside a single word.
+static std::u8string_view longest_term_run(const std::u8string_view text)
+{
+	std::u8string_view result;
+
+	split_terms(text, is_ascii_term_char, [&result](const std::u8string_view run)
+		{
+			if (run.size() > result.size()) result = run;
+		});
+
+	return result;
+}
+
+template <typename F>
+static void iterate_item_words(const str::cached name, const prop::item_metadata* md, F&& f)
+{
+	split_terms(name, is_term_char, f);
+
+	if (md)
+	{
+		for (const auto& text : {
+			     md->album, md->album_artist, md->artist, md->audio_codec, md->bitrate, md->camera_manufacturer,
+			     md->camera_model, md->comment, md->composer, md->copyright_creator, md->copyright_credit,
+			     md->copyright_url, md->copyright_notice, md->copyright_source, md->description, md->encoder,
+			     md->file_name, md->genre, md->lens, md->location_place, md->location_country, md->location_state,
+			     md->performer, md->pixel_format, md->publisher, md->show, md->synopsis, md->title, md->video_codec,
+			     md->raw_file_name, md->tags, md->game, md->system, md->label, md->doc_id
+		     })
+		{
+			split_terms(text, is_term_char, f);
+		}
+	}
+}
+
+// Must format values exactly as compare_text does
+static std::u8string format_value(const index_value_key& k, const uint64_t sample)
+{
+	const auto v = k.val;
+
+	switch (k.kind)
+	{
+	case index_value_kind::size:
+		return prop::format_size(df::file_size(sample));
+	case index_value_kind::dimensions:
+		return prop::format_dimensions({ static_cast<int>(v >> 16), static_cast<int>(v & 0xffff) });
+	case index_value_kind::pixels:
+		return prop::format_pixels({ static_cast<int>(v >> 16), static_cast<int>(v & 0xffff) },
+			std::bit_cast<file_type_ref>(k.extra));
+	case index_value_kind::exposure:
+		return prop::format_exposure(std::bit_cast<float>(static_cast<uint32_t>(v)));
+	case index_value_kind::f_number:
+		return prop::format_f_num(std::bit_cast<float>(static_cast<uint32_t>(v)));
+	case index_value_kind::focal_length:
+		return prop::format_focal_length(std::bit_cast<float>(static_cast<uint32_t>(v >> 16)),
+			static_cast<uint16_t>(v & 0xffff));
+	case index_value_kind::duration:
+		return prop::format_duration(static_cast<uint16_t>(v));
+	case index_value_kind::iso:
+		return prop::format_iso(static_cast<uint16_t>(v));
+	case index_value_kind::audio_channels:
+		return prop::format_audio_channels(static_cast<uint16_t>(v));
+	case index_value_kind::audio_sample_rate:
+		return prop::format_audio_sample_rate(static_cast<uint16_t>(v));
+	case index_value_kind::audio_sample_type:
+		return prop::format_audio_sample_type(static_cast<prop::audio_sample_t>(v));
+	case index_value_kind::year:
+		return str::to_string(static_cast<int>(v));
+	}
+
+	return {};
+}
+
+// Code point trigrams of text, folded the way str::ifind compares
+static void text_trigrams(const std::u8string_view text, std::vector<uint64_t>& result)
+{
+	result.clear();
+
+	uint64_t c0 = 0;
+	uint64_t c1 = 0;
+	size_t count = 0;
+	auto p = text.begin();
+
+	while (p < text.end())
+	{
+		const uint64_t c = str::normalze_for_compare(str::pop_utf8_char(p, text.end())) & 0x1FFFFF;
+		if (++count >= 3) result.emplace_back((c0 << 42) | (c1 << 21) | c);
+		c0 = c1;
+		c1 = c;
+	}
+
+	std::ranges::sort(result);
+	result.erase(std::ranges::unique(result).begin(), result.end());
+}
+
+static bool less_text_address(const std::u8string_view l, const std::u8string_view r)
+{
+	return std::less<const char8_t*>()(l.data(), r.data());
+}
+
+static void add_trigrams(index_trigram_texts& texts, const std::u8string_view text)
+{
+	std::vector<uint64_t> grams;
+	text_trigrams(text, grams);
+
+	for (const auto g : grams)
+	{
+		auto& list = texts[g];
+		const auto lb = std::lower_bound(list.begin(), list.end(), text, less_text_address);
+		if (lb == list.end() || lb->data() != text.data()) list.insert(lb, text);
+	}
+}
+
+static void remove_trigrams(index_trigram_texts& texts, const std::u8string_view text)
+{
+	std::vector<uint64_t> grams;
+	text_trigrams(text, grams);
+
+	for (const auto g : grams)
+	{
+		const auto found = texts.find(g);
+
+		if (found != texts.end())
+		{
+			auto& list = found->second;
+			const auto lb = std::lower_bound(list.begin(), list.end(), text, less_text_address);
+			if (lb != list.end() && lb->data() == text.data()) list.erase(lb);
+			if (list.empty()) texts.erase(found);
+		}
+	}
+}
+
+// Any text containing run contains each of its trigrams, so the list of the
+// rarest one holds every text worth checking
+static const std::vector<std::u8string_view>& rarest_trigram_texts(const index_trigram_texts& texts,
+	const std::u8string_view run)
+{
+	static const std::vector<std::u8string_view> none;
+
+	std::vector<uint64_t> grams;
+	text_trigrams(run, grams);
+
+	const std::vector<std::u8string_view>* result = nullptr;
+
+	for (const auto g : grams)
+	{
+		const auto found = texts.find(g);
+		if (found == texts.end()) return none;
+		if (!result || found->second.size() < result->size()) result = &found->second;
+	}
+
+	return result ? *result : none;
+}
+
+uint32_t index_terms::id_of(const df::file_path path)
+{
+	const auto found = _ids.find(path);
+	if (found != _ids.end()) return found->second;
+
+	uint32_t id;
+
+	if (_free_ids.empty())
+	{
+		id = static_cast<uint32_t>(_paths.size());
+		_paths.emplace_back(path);
+	}
+	else
+	{
+		id = _free_ids.back();
+		_free_ids.pop_back();
+		_paths[id] = path;
+	}
+
+	_ids.emplace(path, id);
+	return id;
+}
+
+void index_terms::release_id(const uint32_t id)
+{
+	_paths[id] = {};
+	_free_ids.emplace_back(id);
+}
+
+void index_terms::add_words(const uint32_t id, const df::index_file_item& file)
+{
+	const auto md = file.metadata.load();
+
+	iterate_item_words(file.name, md.get(), [this, id](const std::u8string_view word)
+		{
+			const auto [found, inserted] = _words.try_emplace(word);
+			auto& posting = found->second;
+
+			if (inserted)
+			{
+				add_trigrams(_word_trigrams, found->first);
+			}
+
+			// ids are allocated in order so this is usually an append
+			if (posting.empty() || posting.back() < id)
+			{
+				posting.emplace_back(id);
+			}
+			else
+			{
+				const auto lb = std::lower_bound(posting.begin(), posting.end(), id);
+				if (lb == posting.end() || *lb != id) posting.insert(lb, id);
+			}
+		});
+}
+
+void index_terms::remove_words(const uint32_t id, const str::cached name, const prop::item_metadata* md)
+{
+	iterate_item_words(name, md, [this, id](const std::u8string_view word)
+		{
+			const auto found = _words.find(word);
+
+			if (found != _words.end())
+			{
+				auto& posting = found->second;
+				const auto lb = std::lower_bound(posting.begin(), posting.end(), id);
+				if (lb != posting.end() && *lb == id) posting.erase(lb);
+
+				if (posting.empty())
+				{
+					remove_trigrams(_word_trigrams, found->first);
+					_words.erase(found);
+				}
+			}
+		});
+}
+
+void index_terms::add_values(const df::index_file_item& file)
+{
+	// values are formatted once, when first seen
+	auto add_value = [this](const index_value_key& k, const uint64_t sample)
+		{
+			if (_values.try_emplace(k, sample).second)
+			{
+				const auto text = str::cache(format_value(k, sample));
+				if (_value_texts.emplace(text).second) add_trigrams(_value_trigrams, text);
+			}
+		};
+
+	const auto size = file.size.to_int64();
+	const auto rounded = prop::round_size(size);
+	add_value(index_value_key{ index_value_kind::size, (rounded.n << 8) | rounded.dec, static_cast<uintptr_t>(rounded.div) }, size);
+
+	const auto md = file.metadata.load();
+
+	if (md)
+	{
+		auto add = [&add_value](const index_value_kind kind, const uint64_t val, const uintptr_t extra = 0)
+			{
+				add_value(index_value_key{ kind, val, extra }, val);
+			};
+
+		const auto dims = (static_cast<uint64_t>(md->width) << 16) | md->height;
+
+		add(index_value_kind::dimensions, dims);
+		add(index_value_kind::pixels, dims, std::bit_cast<uintptr_t>(file.ft));
+		add(index_value_kind::exposure, std::bit_cast<uint32_t>(md->exposure_time));
+		add(index_value_kind::f_number, std::bit_cast<uint32_t>(md->f_number));
+		add(index_value_kind::focal_length,
+			(static_cast<uint64_t>(std::bit_cast<uint32_t>(md->focal_length)) << 16) | md->focal_length_35mm_equivalent);
+		add(index_value_kind::duration, md->duration);
+		add(index_value_kind::iso, md->iso_speed);
+		add(index_value_kind::audio_channels, md->audio_channels);
+		add(index_value_kind::audio_sample_rate, md->audio_sample_rate);
+		add(index_value_kind::audio_sample_type, md->audio_sample_type);
+		add(index_value_kind::year, md->year);
+	}
+}
+
+bool index_terms::match_words(const std::u8string_view run, const size_t limit, posting_t& result) const
+{
+	auto add = [limit, &result](const posting_t& posting)
+		{
+			result.insert(result.end(), posting.begin(), posting.end());
+
+			if (result.size() > limit)
+			{
+				std::ranges::sort(result);
+				result.erase(std::ranges::unique(result).begin(), result.end());
+				if (result.size() > limit) return false;
+			}
+
+			return true;
+		};
+
+	if (run.size() >= 3)
+	{
+		for (const auto w : rarest_trigram_texts(_word_trigrams, run))
+		{
+			if (str::contains(w, run))
+			{
+				const auto found = _words.find(w);
+				if (found != _words.end() && !add(found->second)) return false;
+			}
+		}
+	}
+	else
+	{
+		for (const auto& w : _words)
+		{
+			if (str::contains(w.first, run) && !add(w.second)) return false;
+		}
+	}
+
+	std::ranges::sort(result);
+	result.erase(std::ranges::unique(result).begin(), result.end());
+	return true;
+}
+
+bool index_terms::match_values(const df::search_term& term, const std::u8string_view run) const
 {
-	constexpr uint64_t fnv_prime = 1099511628211u;
-	constexpr uint64_t fnv_offset_basis = 14695981039346656037u;
-	const auto result = (fnv_offset_basis ^ n) * fnv_prime;
-	return static_cast<uint32_t>(result);
+	auto is_match = [&term](const std::u8string_view text)
+		{
+			return term._is_wildcard ? str::wildcard_icmp(text, term.text) : str::same(text, term.text);
+		};
+
+	if (run.size() >= 3)
+	{
+		for (const auto text : rarest_trigram_texts(_value_trigrams, run))
+		{
+			if (is_match(text)) return true;
+		}
+	}
+	else
+	{
+		for (const auto& text : _value_texts)
+		{
+			if (is_match(text)) return true;
+		}
+	}
+
+	return false;
+}
+
+void index_terms::add(const df::file_path path, const df::index_file_item& file)
+{
+	platform::exclusive_lock lock(_rw);
+	add_words(id_of(path), file);
+	add_values(file);
+}
+
+void index_terms::add(const df::folder_path folder, const df::index_item_infos& files)
+{
+	platform::exclusive_lock lock(_rw);
+
+	for (const auto& f : files)
+	{
+		add_words(id_of(folder.combine_file(f.name)), f);
+		add_values(f);
+	}
+}
+
+void index_terms::update(const df::file_path path, const prop::item_metadata* previous,
+	const df::index_file_item& file)
+{
+	platform::exclusive_lock lock(_rw);
+	const auto id = id_of(path);
+	if (previous) remove_words(id, {}, previous);
+	add_words(id, file);
+	add_values(file);
+}
+
+void index_terms::erase(const df::file_path path, const df::index_file_item& file)
+{
+	platform::exclusive_lock lock(_rw);
+	const auto found = _ids.find(path);
+
+	if (found != _ids.end())
+	{
+		const auto md = file.metadata.load();
+		remove_words(found->second, file.name, md.get());
+		release_id(found->second);
+		_ids.erase(found);
+	}
+}
+
+void index_terms::erase(const df::folder_path folder, const df::index_item_infos& files)
+{
+	platform::exclusive_lock lock(_rw);
+
+	for (const auto& f : files)
+	{
+		const auto found = _ids.find(folder.combine_file(f.name));
+
+		if (found != _ids.end())
+		{
+			const auto md = f.metadata.load();
+			remove_words(found->second, f.name, md.get());
+			release_id(found->second);
+			_ids.erase(found);
+		}
+	}
+}
+
+void index_terms::clear()
+{
+	platform::exclusive_lock lock(_rw);
+	_words.clear();
+	_word_trigrams.clear();
+	_ids.clear();
+	_paths.clear();
+	_free_ids.clear();
+	_values.clear();
+	_value_texts.clear();
+	_value_trigrams.clear();
+}
+
+index_term_candidates index_terms::candidates(const df::search_t& search) const
+{
+	index_term_candidates result;
+
+	if (search.has_related() || search.can_match_folder())
+	{
+		return result;
+	}
+
+	const auto& terms = search.terms();
+
+	for (const auto& t : terms)
+	{
+		// only a conjunction of terms can be narrowed
+		if (t.modifiers.logical_op == df::search_term_modifier_bool::m_or ||
+			t.modifiers.begin_group > 0 ||
+			t.modifiers.end_group > 0)
+		{
+			return result;
+		}
+	}
+
+	platform::shared_lock lock(_rw);
+
+	// Large candidate sets are slower than scanning
+	const auto limit = _ids.size() / 4;
+	auto has_matches = false;
+	posting_t matches;
+
+	for (const auto& t : terms)
+	{
+		const auto is_text = t.type == df::search_term_type::text;
+		const auto is_string_value = t.type == df::search_term_type::value &&
+			t.key->data_type == prop::data_type::string;
+
+		if (!t.modifiers.positive || !(is_text || is_string_value))
+			continue;
+
+		const auto run = longest_term_run(t.text);
+
+		// text terms also match formatted numbers that are not in the word postings
+		if (run.size() < 2 || (is_text && match_values(t, run)))
+			continue;
+
+		posting_t postings;
+
+		if (match_words(run, limit, postings))
+		{
+			if (has_matches)
+			{
+				posting_t intersection;
+				std::ranges::set_intersection(matches, postings, std::back_inserter(intersection));
+				matches = std::move(intersection);
+			}
+			else
+			{
+				matches = std::move(postings);
+				has_matches = true;
+			}
+
+			if (matches.empty())
+				break;
+		}
+	}
+
+	if (has_matches)
+	{
+		result.is_constrained = true;
+
+		for (const auto id : matches)
+		{
+			const auto path = _paths[id];
+
+			if (!path.is_empty())
+			{
+				result.folders.emplace(path.folder());
+				result.files.emplace(path);
+			}
+		}
+	}
+
+	return result;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -129,28 +651,95 @@ struct query_items_result
 		results.add(found);
 	}
 
-	void match_folder(const df::folder_path folder_path, const df::index_folder_item_ptr& folder)
+	void match_row(const df::folder_path folder_path, const df::index_columns& columns, const size_t row,
+		const df::search_result& match)
+	{
+		const auto& file = *columns.items[row];
+		match_item(folder_path.combine_file(file.name), file, match);
+	}
+
+	void match_folder(const df::folder_path folder_path, const df::index_folder_item_ptr& folder)
+	{
+		const auto path = folder_path;
+		const auto found = existing.find(path);
+		const auto ii = found ? found : std::make_shared<df::item_element>(folder_path, folder);
+		results.add(ii);
+	}
+
+	query_items_result fork() const
+	{
+		return { existing, {} };
+	}
+
+	void merge(const query_items_result& other)
+	{
+		results.append(other.results);
+	}
+};
+
+struct count_items_result
+{
+	df::file_group_histogram summary;
+
+	void match_item(const df::file_path id, const df::index_file_item& file, const df::search_result& match)
+	{
+		summary.record(file);
+	}
+
+	void match_row(const df::folder_path folder_path, const df::index_columns& columns, const size_t row,
+		const df::search_result& match)
+	{
+		summary.record(columns.ft[row], df::file_size(columns.size[row]));
+	}
+
+	void match_folder(const df::folder_path folder_path, const df::index_folder_item_ptr& folder)
+	{
+	}
+
+	count_items_result fork() const
+	{
+		return {};
+	}
+
+	void merge(const count_items_result& other)
 	{
-		const auto path = folder_path;
-		const auto found = existing.find(path);
-		const auto ii = found ? found : std::make_shared<df::item_element>(folder_path, folder);
-		results.add(ii);
+		summary.add(other.summary);
 	}
 };
 
-struct count_items_result
+// Collection queries are split into chunks of folders run on the work pool.
+// Each worker matches into its own result that is merged at the end.
+template <typename T, typename F>
+static void parallel_folders(T& results, const size_t folder_count, const size_t max_workers,
+	df::cancel_token token, F&& match_folder)
 {
-	df::file_group_histogram summary;
+	constexpr size_t folder_chunk_size = 8;
 
-	void match_item(const df::file_path id, const df::index_file_item& file, const df::search_result& match)
+	auto& pool = platform::default_work_pool();
+	std::vector<T> worker_results;
+	worker_results.reserve(pool.worker_count());
+
+	for (size_t i = 0; i < pool.worker_count(); ++i)
 	{
-		summary.record(file);
+		worker_results.emplace_back(results.fork());
 	}
 
-	void match_folder(const df::folder_path folder_path, const df::index_folder_item_ptr& folder)
+	pool.parallel_for(folder_count, folder_chunk_size,
+		[&worker_results, &match_folder, token](const size_t worker, const size_t begin, const size_t end)
+		{
+			if (token.is_cancelled()) return;
+
+			for (auto i = begin; i < end; ++i)
+			{
+				match_folder(worker_results[worker], i);
+			}
+		}, max_workers, token);
+
+	for (const auto& r : worker_results)
 	{
+		results.merge(r);
 	}
-};
+}
 
 template <typename T>
 static void iterate_items(const df::search_t& search,
@@ -163,6 +752,11 @@ static void iterate_items(const df::search_t& search,
 {
 	df::search_matcher matcher(search);
 
+	if (search.has_related())
+	{
+		matcher.similar = state.similar_items(search.related().path);
+	}
+
 	const auto now = platform::now();
 	const auto& selectors = search.selectors();
 	const auto has_selector = !selectors.empty();
@@ -261,46 +855,92 @@ static void iterate_items(const df::search_t& search,
 			}
 		}
 	}
-	else
+	else if (matcher.can_match_columns)
 	{
-		const auto has_related = search.has_related();
-		const auto folders = index.all_folders();
-
-		for (const auto& folder_node : folders)
-		{
-			if (token.is_cancelled()) break;
+		// numeric, date and location terms only need the columnar snapshot
+		const auto columns = state.columns();
 
-			if (folder_node.second->is_in_collection)
+		parallel_folders(results, columns->folder_count(), state.query_workers, token,
+			[&](T& worker_results, const size_t f)
 			{
-				if (has_related ||
-					matcher.can_match_folder ||
-					matcher.potential_match(folder_node.second->bloom_filter))
+				const auto& folder = columns->folders[f];
+
+				if (folder->is_in_collection)
 				{
-					for (const auto& file_node : folder_node.second->files)
+					const auto folder_path = columns->folder_paths[f];
+
+					if (matcher.potential_match(folder->bloom_filter))
 					{
-						if (token.is_cancelled()) break;
+						const auto last = columns->last_row(f);
 
-						if (!(file_node.flags && df::index_item_flags::is_sidecar) || show_sidecars)
+						for (auto row = columns->first_row(f); row < last; ++row)
 						{
-							const auto path = folder_node.first.combine_file(file_node.name);
-							const auto match = matcher.match_item(path, file_node);
-
-							if (match.is_match())
+							if (!(columns->flags[row] && df::index_item_flags::is_sidecar) || show_sidecars)
 							{
-								results.match_item(path, file_node, match);
+								const auto match = matcher.match_row(*columns, row);
+
+								if (match.is_match())
+								{
+									worker_results.match_row(folder_path, *columns, row, match);
+								}
 							}
 						}
 					}
+
+					const auto match = matcher.match_folder(folder_path.text(), folder_path.name());
+
+					if (match.is_match())
+					{
+						worker_results.match_folder(folder_path, folder);
+					}
 				}
+			});
+	}
+	else
+	{
+		const auto has_related = search.has_related();
+		const auto candidates = state.use_term_candidates ? state.term_candidates(search) : index_term_candidates{};
+		const auto folders = index.all_folders();
 
-				const auto match = matcher.match_folder(folder_node.first.text(), folder_node.first.name());
+		parallel_folders(results, folders.size(), state.query_workers, token,
+			[&](T& worker_results, const size_t f)
+			{
+				const auto& folder_node = folders[f];
 
-				if (match.is_match())
+				if (folder_node.second->is_in_collection)
 				{
-					results.match_folder(folder_node.first, folder_node.second);
+					if (candidates.can_match(folder_node.first) &&
+						(has_related ||
+							matcher.can_match_folder ||
+							matcher.potential_match(folder_node.second->bloom_filter)))
+					{
+						for (const auto& file_node : folder_node.second->files)
+						{
+							if (!(file_node.flags && df::index_item_flags::is_sidecar) || show_sidecars)
+							{
+								const auto path = folder_node.first.combine_file(file_node.name);
+
+								if (candidates.can_match(path))
+								{
+									const auto match = matcher.match_item(path, file_node);
+
+									if (match.is_match())
+									{
+										worker_results.match_item(path, file_node, match);
+									}
+								}
+							}
+						}
+					}
+
+					const auto match = matcher.match_folder(folder_node.first.text(), folder_node.first.name());
+
+					if (match.is_match())
+					{
+						worker_results.match_folder(folder_node.first, folder_node.second);
+					}
 				}
-			}
-		}
+			});
 	}
 }
 
@@ -400,15 +1040,20 @@ index_state::index_state(async_strategy& as, const location_cache& locations) :
 {
 }
 
-void index_state::init_item_index()
+static void record_file_group_words(df::dense_string_counts& distinct_words)
 {
-	platform::exclusive_lock lock(_summary_rw);
-
 	for (const auto& f : all_file_groups())
 	{
-		++_summary._distinct_words[str::cache(str::format(u8"@{}"sv, f->name))];
-		++_summary._distinct_words[str::cache(str::format(u8"@{}"sv, f->plural_name))];
+		++distinct_words[str::cache(str::format(u8"@{}"sv, f->name))];
+		++distinct_words[str::cache(str::format(u8"@{}"sv, f->plural_name))];
 	}
+}
+
+void index_state::init_item_index()
+{
+	platform::exclusive_lock lock(_summary_rw);
+	record_file_group_words(_summary._distinct_words);
+	_auto_complete_changes += 1;
 
 	_summary._distinct_text[prop::genre] = df::dense_unique_strings
 	{
@@ -530,9 +1175,494 @@ void index_state::init_item_index()
 	};
 }
 
-void index_state::reset()
+void index_state::reset()
+{
+	_items.clear();
+	_terms.clear();
+	invalidate_columns();
+	invalidate_summary();
+}
+
+df::index_columns_ptr index_state::columns()
+{
+	platform::exclusive_lock lock(_columns_rw);
+
+	const auto version = _items.version();
+
+	if (_columns && !_columns_all_dirty && _columns_dirty.empty() && _columns_version == version)
+	{
+		return _columns;
+	}
+
+	df::measure_ms ms(stats.columns_ms);
+
+	// folders whose node is unchanged and not marked dirty are copied from the previous snapshot
+	const auto folders = _items.all_folders();
+	const auto previous = _columns_all_dirty ? nullptr : _columns;
+	df::hash_map<const df::index_folder_item*, size_t> previous_folders;
+
+	if (previous)
+	{
+		previous_folders.reserve(previous->folder_count());
+
+		for (size_t i = 0; i < previous->folder_count(); ++i)
+		{
+			previous_folders[previous->folders[i].get()] = i;
+		}
+	}
+
+	size_t row_count = 0;
+
+	for (const auto& f : folders)
+	{
+		row_count += f.second->files.size();
+	}
+
+	auto result = std::make_shared<df::index_columns>();
+	result->reserve(folders.size(), row_count);
+
+	for (const auto& f : folders)
+	{
+		const auto found = previous_folders.find(f.second.get());
+
+		if (found != previous_folders.end() && !_columns_dirty.contains(f.first))
+		{
+			result->append(f.first, f.second, *previous, found->second);
+		}
+		else
+		{
+			result->append(f.first, f.second);
+		}
+	}
+
+	_columns = result;
+	_columns_dirty.clear();
+	_columns_version = version;
+	_columns_all_dirty = false;
+
+	return _columns;
+}
+
+void index_state::invalidate_columns(const df::folder_path folder)
+{
+	platform::exclusive_lock lock(_columns_rw);
+	_columns_dirty.emplace(folder);
+}
+
+void index_state::invalidate_columns()
+{
+	platform::exclusive_lock lock(_columns_rw);
+	_columns_dirty.clear();
+	_columns_all_dirty = true;
+}
+
+void phash_index::build(const df::index_columns_ptr& c)
+{
+	constexpr size_t bucket_count = 1_z << band_bits;
+	constexpr uint64_t band_mask = bucket_count - 1;
+
+	columns = c;
+	const auto& hashes = c->phash;
+
+	for (int b = 0; b < band_count; ++b)
+	{
+		const auto shift = b * band_bits;
+		auto& offsets = _offsets[b];
+		auto& rows = _rows[b];
+
+		// counting sort of the hashed rows by band value
+		offsets.assign(bucket_count + 1, 0);
+
+		for (const auto h : hashes)
+		{
+			if (h) ++offsets[((h >> shift) & band_mask) + 1];
+		}
+
+		for (size_t i = 1; i <= bucket_count; ++i)
+		{
+			offsets[i] += offsets[i - 1];
+		}
+
+		auto next = offsets;
+		rows.resize(offsets[bucket_count]);
+
+		for (uint32_t row = 0; row < hashes.size(); ++row)
+		{
+			const auto h = hashes[row];
+			if (h) rows[next[(h >> shift) & band_mask]++] = row;
+		}
+	}
+}
+
+std::vector<uint32_t> phash_index::find(const uint64_t hash, const int max_distance) const
+{
+	constexpr uint64_t band_mask = (1_z << band_bits) - 1;
+
+	std::vector<uint32_t> result;
+
+	if (!hash || !columns)
+	{
+		return result;
+	}
+
+	const auto& hashes = columns->phash;
+	const auto band_distance = max_distance / band_count;
+
+	for (int b = 0; b < band_count; ++b)
+	{
+		const auto& offsets = _offsets[b];
+		const auto& rows = _rows[b];
+
+		// visits every band value within band_distance bits of the query band
+		auto probe = [&](auto&& self, const uint32_t value, const int first_bit, const int flips) -> void
+			{
+				for (auto i = offsets[value]; i < offsets[value + 1]; ++i)
+				{
+					const auto row = rows[i];
+
+					if (ui::perceptual_distance(hashes[row], hash) <= max_distance)
+					{
+						result.emplace_back(row);
+					}
+				}
+
+				if (flips < band_distance)
+				{
+					for (auto bit = first_bit; bit < band_bits; ++bit)
+					{
+						self(self, value ^ (1u << bit), bit + 1, flips + 1);
+					}
+				}
+			};
+
+		probe(probe, static_cast<uint32_t>((hash >> (b * band_bits)) & band_mask), 0, 0);
+	}
+
+	// a row close in several bands is found once per band
+	std::ranges::sort(result);
+	result.erase(std::ranges::unique(result).begin(), result.end());
+	return result;
+}
+
+// normalized code points, the characters ifind2 and starts compare
+static void auto_complete_code_points(const std::u8string_view text, std::vector<uint32_t>& result)
+{
+	result.clear();
+	auto p = text.begin();
+
+	while (p < text.end())
+	{
+		result.emplace_back(str::normalze_for_compare(str::pop_utf8_char(p, text.end())) & 0x1FFFFF);
+	}
+}
+
+// trigrams of the runs between spaces, ifind2 matches each run of the query contiguously
+static void auto_complete_trigrams(const std::vector<uint32_t>& cps, std::vector<uint64_t>& result)
+{
+	result.clear();
+
+	for (size_t i = 2; i < cps.size(); ++i)
+	{
+		if (cps[i - 2] != 0x20 && cps[i - 1] != 0x20 && cps[i] != 0x20)
+		{
+			result.emplace_back((static_cast<uint64_t>(cps[i - 2]) << 42) | (static_cast<uint64_t>(cps[i - 1]) << 21) | cps[i]);
+		}
+	}
+
+	std::ranges::sort(result);
+	result.erase(std::ranges::unique(result).begin(), result.end());
+}
+
+// first character in the high bits and the second plus one in the low 22 bits,
+// so a one character prefix covers every key with the same high bits
+static uint64_t auto_complete_prefix(const std::u8string_view text)
+{
+	auto p = text.begin();
+	uint64_t first = 0;
+	uint64_t second = 0;
+
+	if (p < text.end()) first = str::normalze_for_compare(str::pop_utf8_char(p, text.end())) & 0x1FFFFF;
+	if (p < text.end()) second = (str::normalze_for_compare(str::pop_utf8_char(p, text.end())) & 0x1FFFFF) + 1;
+
+	return (first << 22) | second;
+}
+
+void auto_complete_index::build(std::vector<entry> e)
+{
+	std::ranges::sort(e, [](const entry& l, const entry& r)
+		{
+			if (l.rank != r.rank) return l.rank > r.rank;
+			return str::icmp(l.text, r.text) < 0;
+		});
+
+	entries = std::move(e);
+
+	std::vector<std::pair<uint64_t, uint32_t>> grams;
+	std::vector<uint64_t> entry_grams;
+	std::vector<uint32_t> cps;
+
+	_prefixes.clear();
+	_prefixes.reserve(entries.size());
+
+	for (uint32_t i = 0; i < entries.size(); ++i)
+	{
+		const auto& en = entries[i];
+
+		auto_complete_code_points(en.text, cps);
+		auto_complete_trigrams(cps, entry_grams);
+
+		for (const auto g : entry_grams)
+		{
+			grams.emplace_back(g, i);
+		}
+
+		_prefixes.emplace_back(auto_complete_prefix(en.text), i);
+
+		if (en.name_pos != 0)
+		{
+			_prefixes.emplace_back(auto_complete_prefix(en.text.substr(en.name_pos)), i);
+		}
+	}
+
+	// postings of each trigram end up in entry and so rank order
+	std::ranges::sort(grams);
+
+	_trigrams.clear();
+	_offsets.clear();
+	_postings.clear();
+	_postings.reserve(grams.size());
+
+	for (const auto& g : grams)
+	{
+		if (_trigrams.empty() || _trigrams.back() != g.first)
+		{
+			_trigrams.emplace_back(g.first);
+			_offsets.emplace_back(static_cast<uint32_t>(_postings.size()));
+		}
+
+		_postings.emplace_back(g.second);
+	}
+
+	_offsets.emplace_back(static_cast<uint32_t>(_postings.size()));
+
+	std::ranges::sort(_prefixes);
+	_prefixes.erase(std::ranges::unique(_prefixes).begin(), _prefixes.end());
+}
+
+bool auto_complete_index::match_entry(const uint32_t e, const std::u8string_view query,
+	std::vector<match>& results) const
+{
+	const auto& en = entries[e];
+
+	if (query.size() > 2)
+	{
+		auto found = str::ifind2(en.text.substr(en.name_pos), query, en.name_pos);
+
+		if (!found.found && en.name_pos != 0)
+		{
+			found = str::ifind2(en.text, query, 0);
+		}
+
+		if (found.found)
+		{
+			results.emplace_back(e, std::move(found.parts));
+			return true;
+		}
+	}
+	else if (str::starts(en.text.substr(en.name_pos), query))
+	{
+		results.emplace_back(e, std::vector<str::part_t>{{en.name_pos, query.size()}});
+		return true;
+	}
+	else if (en.name_pos != 0 && str::starts(en.text, query))
+	{
+		results.emplace_back(e, std::vector<str::part_t>{{0, query.size()}});
+		return true;
+	}
+
+	return false;
+}
+
+std::vector<auto_complete_index::match> auto_complete_index::find(const std::u8string_view query,
+	const size_t max_results) const
+{
+	constexpr size_t max_prefix_candidates = 4096;
+
+	std::vector<match> results;
+
+	if (max_results == 0)
+	{
+		return results;
+	}
+
+	// entries are in rank order so the first matches found are the best ones
+	const auto scan = [&](const auto& candidates)
+		{
+			for (const auto e : candidates)
+			{
+				if (match_entry(e, query, results) && results.size() >= max_results)
+				{
+					break;
+				}
+			}
+		};
+
+	const auto scan_all = [&]()
+		{
+			for (uint32_t e = 0; e < entries.size(); ++e)
+			{
+				if (match_entry(e, query, results) && results.size() >= max_results)
+				{
+					break;
+				}
+			}
+		};
+
+	if (query.size() > 2)
+	{
+		std::vector<uint32_t> cps;
+		std::vector<uint64_t> grams;
+
+		auto_complete_code_points(query, cps);
+		auto_complete_trigrams(cps, grams);
+
+		if (grams.empty())
+		{
+			scan_all();
+			return results;
+		}
+
+		std::vector<std::pair<const uint32_t*, const uint32_t*>> lists;
+
+		for (const auto g : grams)
+		{
+			const auto found = std::ranges::lower_bound(_trigrams, g);
+
+			if (found == _trigrams.end() || *found != g)
+			{
+				return results;
+			}
+
+			const auto t = found - _trigrams.begin();
+			lists.emplace_back(_postings.data() + _offsets[t], _postings.data() + _offsets[t + 1]);
+		}
+
+		// walk the shortest posting list and look up the rest with a moving lower bound
+		std::ranges::sort(lists, [](const auto& l, const auto& r)
+			{
+				return (l.second - l.first) < (r.second - r.first);
+			});
+
+		for (auto p = lists[0].first; p < lists[0].second; ++p)
+		{
+			const auto e = *p;
+			auto in_all = true;
+
+			for (size_t i = 1; in_all && i < lists.size(); ++i)
+			{
+				auto& l = lists[i];
+				l.first = std::lower_bound(l.first, l.second, e);
+				in_all = l.first < l.second && *l.first == e;
+			}
+
+			if (in_all && match_entry(e, query, results) && results.size() >= max_results)
+			{
+				break;
+			}
+		}
+	}
+	else if (query.empty())
+	{
+		scan_all();
+	}
+	else
+	{
+		const auto key = auto_complete_prefix(query);
+		const auto last = (key & 0x3FFFFF) == 0 ? key + (1_z << 22) : key + 1;
+		const auto begin = std::ranges::lower_bound(_prefixes, std::make_pair(key, 0u));
+		const auto end = std::ranges::lower_bound(_prefixes, std::make_pair(last, 0u));
+
+		if (static_cast<size_t>(end - begin) <= max_prefix_candidates)
+		{
+			std::vector<uint32_t> candidates;
+			candidates.reserve(end - begin);
+
+			for (auto i = begin; i < end; ++i)
+			{
+				candidates.emplace_back(i->second);
+			}
+
+			std::ranges::sort(candidates);
+			candidates.erase(std::ranges::unique(candidates).begin(), candidates.end());
+			scan(candidates);
+		}
+		else
+		{
+			// a common prefix finds enough matches early in rank order
+			scan_all();
+		}
+	}
+
+	return results;
+}
+
+phash_index_ptr index_state::similar_index()
 {
-	_items.clear();
+	const auto c = columns();
+
+	platform::exclusive_lock lock(_phash_rw);
+
+	if (!_phash_index || _phash_index->columns != c)
+	{
+		auto index = std::make_shared<phash_index>();
+		index->build(c);
+		_phash_index = std::move(index);
+		_similar_cache.clear();
+	}
+
+	return _phash_index;
+}
+
+df::unique_paths index_state::similar_items(const df::file_path id, const int max_distance)
+{
+	constexpr size_t max_similar_cache = 64;
+
+	df::unique_paths result;
+	const auto hash = find_item(id).phash;
+
+	if (hash)
+	{
+		const auto index = similar_index();
+
+		{
+			platform::shared_lock lock(_phash_rw);
+			const auto found = _similar_cache.find(id);
+
+			if (found != _similar_cache.end() && found->second.hash == hash &&
+				found->second.max_distance == max_distance && _phash_index == index)
+			{
+				return found->second.items;
+			}
+		}
+
+		const auto& c = *index->columns;
+
+		for (const auto row : index->find(hash, max_distance))
+		{
+			result.emplace(c.folder_paths[c.folder_of_row(row)].combine_file(c.items[row]->name));
+		}
+
+		platform::exclusive_lock lock(_phash_rw);
+
+		// results of an index replaced meanwhile are not kept
+		if (_phash_index == index)
+		{
+			if (_similar_cache.size() >= max_similar_cache) _similar_cache.clear();
+			_similar_cache[id] = { hash, max_distance, result };
+		}
+	}
+
+	return result;
 }
 
 void index_state::invalidate_view(view_invalid invalid) const
@@ -588,6 +1718,20 @@ static df::index_item_infos::const_iterator find_file(const df::index_item_infos
 	return files.end();
 }
 
+static df::index_item_infos::iterator find_file(df::index_item_infos& files, const str::cached name)
+{
+	const auto lb = std::lower_bound(files.begin(), files.end(), name);
+	if (lb != files.end() && *lb == name) return lb;
+	return files.end();
+}
+
+static df::index_item_infos::const_iterator find_file(const df::index_item_infos& files, const str::cached name)
+{
+	const auto lb = std::lower_bound(files.begin(), files.end(), name);
+	if (lb != files.end() && *lb == name) return lb;
+	return files.end();
+}
+
 static df::index_folder_item_ptr find_or_create_folder(index_items& items, const df::folder_path path,
 	const platform::folder_info& fd)
 {
@@ -657,6 +1801,7 @@ index_state::validate_folder_result index_state::validate_folder(const df::folde
 		df::index_item_infos updated_files;
 		df::index_folder_infos updated_folders;
 		std::vector<df::folder_path> removed_folders;
+		std::vector<const df::index_file_item*> removed_files;
 		std::unordered_multimap<std::u8string_view, str::cached, df::ihash, df::ieq> sidecars;
 		df::hash_set<std::u8string_view, df::ihash, df::ieq> sidecar_extensions;
 
@@ -758,6 +1903,7 @@ index_state::validate_folder_result index_state::validate_folder(const df::folde
 				else if (d > 0)
 				{
 					// remove: only in old
+					removed_files.emplace_back(&*old_first);
 					changes_detected = true;
 					++old_first;
 				}
@@ -773,6 +1919,7 @@ index_state::validate_folder_result index_state::validate_folder(const df::folde
 					info.metadata.store(old_first->metadata);
 					info.metadata_scanned = old_first->metadata_scanned;
 					info.crc32c = old_first->crc32c;
+					info.phash = old_first->phash;
 					populate_file_info(info, *file_first, _cache_items_loaded);
 					updated_files.emplace_back(info);
 					++file_first;
@@ -821,8 +1968,22 @@ index_state::validate_folder_result index_state::validate_folder(const df::folde
 
 						if (f.metadata_scanned < f.file_modified)
 						{
+							const auto previous = *ps;
 							metadata_xmp::parse(*ps, path);
 							f.metadata_scanned = timestamp;
+							_terms.update(path, &previous, f);
+
+							// metadata is shared with the existing file so the folder delta below removes the
+							// parsed values, correct that with the existing file's size and dates
+							if (existing_folder && existing_folder->is_in_collection)
+							{
+								const auto existing_file = find_file(existing_folder->files, f.name);
+
+								if (existing_file != existing_folder->files.end())
+								{
+									update_summary(*existing_file, &previous, ps.get());
+								}
+							}
 							changes_detected = true;
 						}
 
@@ -919,362 +2080,860 @@ index_state::validate_folder_result index_state::validate_folder(const df::folde
 			}
 			else
 			{
-				folder_node->name = folder_path.name();
+				folder_node->name = folder_path.name();
+			}
+
+			df::assert_true(!is_empty(folder_node->name));
+			folder_node->reset_bloom_bits();
+
+			for (const auto* f : removed_files)
+			{
+				_terms.erase(folder_path.combine_file(f->name), *f);
+			}
+
+			for (const auto& removed : removed_folders)
+			{
+				const auto removed_node = _items.find(removed);
+				if (removed_node) _terms.erase(removed, removed_node->files);
+				if (removed_node && removed_node->is_in_collection) update_summary(removed_node->files, {});
+			}
+
+			if (existing_folder && existing_folder->is_in_collection)
+			{
+				update_summary(existing_folder->files, folder_node->files);
+			}
+
+			_terms.add(folder_path, folder_node->files);
+			_items.replace(folder_path, folder_node);
+			_items.erase(removed_folders);
+
+			return { folder_node, changes_detected };
+		}
+	}
+
+	{
+		platform::exclusive_lock lock(_summary_rw);
+
+		if (_summary._distinct_other_folders.emplace(folder_path).second)
+		{
+			_auto_complete_changes += 1;
+		}
+	}
+
+	return { existing_folder, false };
+}
+
+std::vector<std::pair<df::file_path, df::index_file_item>> index_state::duplicate_list(const uint32_t group) const
+{
+	std::vector<std::pair<df::file_path, df::index_file_item>> result;
+	const auto folders = _items.all_folders();
+
+	for (const auto& ifn : folders)
+	{
+		if (ifn.second->is_in_collection)
+		{
+			for (const auto& file : ifn.second->files)
+			{
+				if (file.duplicates.group == group)
+				{
+					result.emplace_back(df::file_path(ifn.first, file.name), file);
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+static bool is_dup_match(const df::index_columns& columns, const uint32_t row, const uint32_t other_row)
+{
+	if (columns.crc32c[row] != 0 && columns.crc32c[row] == columns.crc32c[other_row])
+	{
+		return true;
+	}
+
+	const auto name_match = icmp(columns.items[row]->name, columns.items[other_row]->name) == 0;
+
+	if (name_match && columns.ft[row]->has_trait(file_traits::av))
+	{
+		if (columns.size[row] == columns.size[other_row])
+		{
+			return true;
+		}
+	}
+
+	return name_match && columns.dup_created(row) == columns.dup_created(other_row);
+}
+
+// Files are duplicates if they share a crc32c, or a name and created date,
+// or a name and size for audio/video. Each rule is an equality, so every
+// file gets one key per rule and files with equal keys form chains that
+// union-find merges into groups without comparing every pair.
+static uint64_t mix_duplicate_key(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+
+template <typename F>
+static void duplicate_keys_for_row(const df::index_columns& columns, const uint32_t row, F&& f)
+{
+	const auto name = columns.items[row]->name.folded_hash();
+
+	if (columns.crc32c[row])
+	{
+		f(mix_duplicate_key(columns.crc32c[row]));
+	}
+
+	f(mix_duplicate_key(mix_duplicate_key((1ull << 32) | name) ^ columns.dup_created(row).to_int64()));
+
+	if (columns.ft[row]->has_trait(file_traits::av))
+	{
+		f(mix_duplicate_key(mix_duplicate_key((2ull << 32) | name) ^ columns.size[row]));
+	}
+}
+
+// Same keys as duplicate_keys_for_row for an item that may not be indexed
+template <typename F>
+static void duplicate_keys_for_item(const df::item_element_ptr& i, F&& f)
+{
+	const auto name = i->path().name().folded_hash();
+
+	if (i->crc32c())
+	{
+		f(mix_duplicate_key(i->crc32c()));
+	}
+
+	f(mix_duplicate_key(mix_duplicate_key((1ull << 32) | name) ^ i->media_created().to_int64()));
+
+	if (i->file_type()->has_trait(file_traits::av))
+	{
+		f(mix_duplicate_key(mix_duplicate_key((2ull << 32) | name) ^ i->file_size().to_int64()));
+	}
+}
+
+class duplicate_sets
+{
+	std::vector<uint32_t> _parent;
+	std::vector<uint32_t> _size;
+
+public:
+	explicit duplicate_sets(const size_t count) : _parent(count), _size(count, 1)
+	{
+		std::iota(_parent.begin(), _parent.end(), 0u);
+	}
+
+	uint32_t find(uint32_t i)
+	{
+		while (_parent[i] != i)
+		{
+			_parent[i] = _parent[_parent[i]];
+			i = _parent[i];
+		}
+
+		return i;
+	}
+
+	void unite(const uint32_t a, const uint32_t b)
+	{
+		auto ra = find(a);
+		auto rb = find(b);
+
+		if (ra != rb)
+		{
+			if (_size[ra] < _size[rb]) std::swap(ra, rb);
+			_parent[rb] = ra;
+			_size[ra] += _size[rb];
+		}
+	}
+
+	uint32_t size(const uint32_t i)
+	{
+		return _size[find(i)];
+	}
+};
+
+using duplicate_key_rows = std::vector<std::pair<uint64_t, uint32_t>>;
+
+static duplicate_key_rows calc_duplicate_keys(const df::index_columns& columns, const std::vector<bool>& in_collection)
+{
+	constexpr size_t bucket_count = 256;
+	using buckets_t = std::array<duplicate_key_rows, bucket_count>;
+
+	auto& pool = platform::default_work_pool();
+	std::vector<buckets_t> worker_buckets(pool.worker_count());
+
+	// radix partition on the top key bits so each bucket can be sorted on its own
+	pool.parallel_for(columns.folder_count(), 8,
+		[&columns, &in_collection, &worker_buckets](const size_t worker, const size_t begin, const size_t end)
+		{
+			auto& buckets = worker_buckets[worker];
+
+			for (auto f = begin; f < end; ++f)
+			{
+				if (in_collection[f])
+				{
+					const auto last = columns.last_row(f);
+
+					for (auto row = columns.first_row(f); row < last; ++row)
+					{
+						duplicate_keys_for_row(columns, row, [&buckets, row](const uint64_t key)
+							{
+								buckets[key >> 56].emplace_back(key, row);
+							});
+					}
+				}
+			}
+		});
+
+	buckets_t buckets;
+
+	pool.parallel_for(bucket_count, 1, [&worker_buckets, &buckets](const size_t, const size_t begin, const size_t end)
+		{
+			for (auto b = begin; b < end; ++b)
+			{
+				size_t count = 0;
+				for (const auto& wb : worker_buckets) count += wb[b].size();
+
+				auto& bucket = buckets[b];
+				bucket.reserve(count);
+
+				for (auto& wb : worker_buckets)
+				{
+					bucket.insert(bucket.end(), wb[b].begin(), wb[b].end());
+					wb[b] = {};
+				}
+
+				std::ranges::sort(bucket);
+			}
+		});
+
+	size_t total = 0;
+	for (const auto& b : buckets) total += b.size();
+
+	duplicate_key_rows result;
+	result.reserve(total);
+
+	for (const auto& b : buckets)
+	{
+		result.insert(result.end(), b.begin(), b.end());
+	}
+
+	return result;
+}
+
+// Reuses keys from the previous snapshot for folders whose rows and collection
+// membership are unchanged and only calculates keys for the rest. Returns
+// false if too much has changed.
+static bool update_duplicate_keys(const duplicate_keys& previous, duplicate_keys& result, const df::index_columns& columns)
+{
+	if (!previous.columns || previous.keys.empty())
+		return false;
+
+	const auto& old_columns = *previous.columns;
+
+	df::hash_map<const df::index_folder_item*, size_t> old_folders;
+	old_folders.reserve(old_columns.folder_count());
+
+	for (size_t f = 0; f < old_columns.folder_count(); ++f)
+	{
+		old_folders[old_columns.folders[f].get()] = f;
+	}
+
+	constexpr auto no_row = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(old_columns.row_count(), no_row);
+	std::vector<size_t> changed;
+	size_t changed_rows = 0;
+
+	for (size_t f = 0; f < columns.folder_count(); ++f)
+	{
+		if (!result.in_collection[f])
+			continue;
+
+		const auto first = columns.first_row(f);
+		const auto last = columns.last_row(f);
+		const auto found = old_folders.find(columns.folders[f].get());
+
+		// a folder that just joined the collection has no keys yet
+		auto same = found != old_folders.end() && previous.in_collection[found->second] &&
+			old_columns.last_row(found->second) - old_columns.first_row(found->second) == last - first;
+
+		if (same)
+		{
+			const auto old_first = old_columns.first_row(found->second);
+
+			for (auto row = first; same && row < last; ++row)
+			{
+				const auto old_row = old_first + (row - first);
+				same = old_columns.crc32c[old_row] == columns.crc32c[row] &&
+					old_columns.size[old_row] == columns.size[row] &&
+					old_columns.dup_created(old_row) == columns.dup_created(row);
+			}
+
+			if (same)
+			{
+				for (auto row = first; row < last; ++row)
+				{
+					remap[old_first + (row - first)] = row;
+				}
 			}
+		}
 
-			df::assert_true(!is_empty(folder_node->name));
-			folder_node->reset_bloom_bits();
+		if (!same)
+		{
+			changed.emplace_back(f);
+			changed_rows += last - first;
+		}
+	}
 
-			_items.replace(folder_path, folder_node);
-			_items.erase(removed_folders);
+	if (changed_rows > columns.row_count() / 8)
+		return false;
 
-			return { folder_node, changes_detected };
+	duplicate_key_rows added;
+
+	for (const auto f : changed)
+	{
+		const auto last = columns.last_row(f);
+
+		for (auto row = columns.first_row(f); row < last; ++row)
+		{
+			duplicate_keys_for_row(columns, row, [&added, row](const uint64_t key) { added.emplace_back(key, row); });
 		}
 	}
 
+	std::ranges::sort(added);
+
+	duplicate_key_rows kept;
+	kept.reserve(previous.keys.size());
+
+	for (const auto& k : previous.keys)
 	{
-		platform::exclusive_lock lock(_summary_rw);
-		_summary._distinct_other_folders.emplace(folder_path);
+		const auto row = remap[k.second];
+		if (row != no_row) kept.emplace_back(k.first, row);
 	}
 
-	return { existing_folder, false };
+	result.keys.reserve(kept.size() + added.size());
+	std::ranges::merge(kept, added, std::back_inserter(result.keys));
+	result.changed_folders = static_cast<int>(changed.size());
+	return true;
 }
 
-std::vector<std::pair<df::file_path, df::index_file_item>> index_state::duplicate_list(const uint32_t group) const
+duplicate_keys_ptr index_state::duplicate_index()
 {
-	std::vector<std::pair<df::file_path, df::index_file_item>> result;
-	const auto folders = _items.all_folders();
+	const auto columns = this->columns();
 
-	for (const auto& ifn : folders)
+	const auto folder_count = columns->folder_count();
+
+	// index_folders changes membership on existing folder nodes without a new snapshot
+	std::vector<bool> in_collection(folder_count);
+
+	for (size_t f = 0; f < folder_count; ++f)
 	{
-		if (ifn.second->is_in_collection)
+		in_collection[f] = columns->folders[f]->is_in_collection;
+	}
+
+	platform::exclusive_lock lock(_duplicate_keys_rw);
+
+	if (!_duplicate_keys || _duplicate_keys->columns != columns || _duplicate_keys->in_collection != in_collection)
+	{
+		auto index = std::make_shared<duplicate_keys>();
+		index->columns = columns;
+		index->in_collection = std::move(in_collection);
+		index->changed_folders = static_cast<int>(folder_count);
+
+		if (!_duplicate_keys || !update_duplicate_keys(*_duplicate_keys, *index, *columns))
 		{
-			for (const auto& file : ifn.second->files)
-			{
-				if (file.duplicates.group == group)
-				{
-					result.emplace_back(df::file_path(ifn.first, file.name), file);
-				}
-			}
+			index->keys = calc_duplicate_keys(*columns, index->in_collection);
 		}
+
+		_duplicate_keys = std::move(index);
 	}
 
-	return result;
+	return _duplicate_keys;
 }
 
 void index_state::update_predictions()
 {
-	const auto folders = _items.all_folders();
 	const auto start_ms = df::now_ms();
-	const auto folder_count = folders.size();
-	// dup on:
-	// filename
-	// metadata created
-	// file created and size
-	// bitmap hash
-	// crc32c
-
+	const auto index = duplicate_index();
+	const auto& columns = index->columns;
+	const auto folder_count = columns->folder_count();
+	const auto changed_folders = index->changed_folders;
 
-	//std::unordered_multimap<uint32_t, const df::index_file_item*, dup_index_hash, dup_index_eq> dups;
-	std::vector<std::pair<uint32_t, const df::index_file_item*>> dups;
-	dups.reserve(1000000);
+	if (df::is_closing) return;
 
+	const auto& keys = index->keys;
+	duplicate_sets sets(columns->row_count());
+	int max_compare_count = 0;
 	int indexed_crc_count = 0;
 
-	for (const auto& ifn : folders)
+	for (size_t i = 0; i < keys.size();)
 	{
-		if (ifn.second->is_in_collection)
+		auto run_end = i + 1;
+
+		while (run_end < keys.size() && keys[run_end].first == keys[i].first)
 		{
-			for (const auto& file : ifn.second->files)
+			// verify in case of a key collision, rows of a true run match the one before
+			const auto row = keys[run_end].second;
+
+			for (auto j = run_end; j-- > i;)
 			{
-				if (df::is_closing) return;
-				const auto file_item_p = &file;
-				const auto md = file.metadata.load(); // important to hold ref
+				if (is_dup_match(*columns, keys[j].second, row))
+				{
+					sets.unite(keys[j].second, row);
+					break;
+				}
+			}
 
-				if (md)
+			++run_end;
+		}
+
+		max_compare_count = std::max(max_compare_count, static_cast<int>(run_end - i));
+		i = run_end;
+	}
+
+	if (df::is_closing) return;
+
+	// keep existing group numbers where possible so views stay stable
+	df::hash_map<uint32_t, uint32_t> root_groups;
+	df::hash_set<uint32_t> used_groups;
+
+	for (size_t f = 0; f < folder_count; ++f)
+	{
+		if (columns->folders[f]->is_in_collection)
+		{
+			const auto last = columns->last_row(f);
+
+			for (auto row = columns->first_row(f); row < last; ++row)
+			{
+				const auto group = columns->items[row]->duplicates.group;
+				if (columns->crc32c[row]) ++indexed_crc_count;
+
+				if (group != 0 && sets.size(row) > 1 && !used_groups.contains(group))
 				{
-					const auto cd = md->created();
+					const auto root = sets.find(row);
 
-					if (cd.is_valid())
+					if (!root_groups.contains(root))
 					{
-						dups.emplace_back(x64to32(cd.to_int64()), file_item_p);
+						root_groups[root] = group;
+						used_groups.emplace(group);
 					}
 				}
+			}
+		}
+	}
 
-				dups.emplace_back(crypto::fnv1a_i(file.name), file_item_p);
-				dups.emplace_back(x64to32(file.file_created.to_int64()), file_item_p);
+	for (size_t f = 0; f < folder_count; ++f)
+	{
+		if (columns->folders[f]->is_in_collection)
+		{
+			if (df::is_closing) return;
 
-				if (file.crc32c)
-				{
-					dups.emplace_back(file.crc32c, file_item_p);
-					++indexed_crc_count;
-				}
-				else
+			const auto& folder = columns->folders[f];
+			const auto last = columns->last_row(f);
+			auto bloom_changed = false;
+
+			for (auto row = columns->first_row(f); row < last; ++row)
+			{
+				const auto& file = *columns->items[row];
+				const auto count = sets.size(row);
+				uint32_t group = 0;
+
+				if (count > 1)
 				{
-					dups.emplace_back(x64to32(file.size.to_int64()), file_item_p);
+					const auto root = sets.find(row);
+					const auto found = root_groups.find(root);
+
+					if (found != root_groups.end())
+					{
+						group = found->second;
+					}
+					else
+					{
+						group = root_groups[root] = ++next_dup_group;
+					}
 				}
+
+				file.update_duplicates(folder, { group, count });
+				bloom_changed |= file.bloom.types != columns->bloom[row].types;
+			}
+
+			if (bloom_changed)
+			{
+				invalidate_columns(columns->folder_paths[f]);
 			}
 		}
 	}
 
-	std::ranges::sort(dups, [](auto&& left, auto&& right) { return left.first < right.first; });
+	stats.indexed_dup_folder_count = static_cast<int>(root_groups.size());
+	stats.indexed_crc_count = indexed_crc_count;
+	stats.indexed_max_compare_count = max_compare_count;
+	stats.indexed_dup_key_count = static_cast<int>(keys.size());
+	stats.predictions_changed_folders = changed_folders;
+	stats.predictions_ms = static_cast<int>(df::now_ms() - start_ms);
 
-	df::hash_map<uint32_t, df::int_counter> group_counts;
-	df::hash_map<uint32_t, uint32_t> group_coalesce;
-	const auto& cdups = dups;
+	df::trace(str::format(u8"Index update predictions: {} folders ({} changed) in {} ms"sv, folder_count,
+		changed_folders, stats.predictions_ms));
+}
 
-	int max_compare_count = 0;
-	const auto dup_size = cdups.size();
 
-	for (auto i = 0u; i < dup_size; ++i)
+static void record_words(df::dense_string_counts& distinct_words, const std::u8string_view text, const int delta)
+{
+	if (delta > 0)
 	{
-		if (df::is_closing) return;
-
-		int compare_count = 0;
-		const auto it = cdups[i];
+		count_ranges(distinct_words, text);
+	}
+	else
+	{
+		df::dense_string_counts words;
+		count_ranges(words, text);
 
-		for (auto hi = i; hi < dup_size; ++hi)
+		for (const auto& w : words)
 		{
-			const auto hit = cdups[hi];
+			const auto found = distinct_words.find(w.first);
 
-			if (hit.first != it.first)
+			if (found != distinct_words.end())
 			{
-				max_compare_count = std::max(max_compare_count, compare_count);
-				break;
+				found->second += -w.second;
+				if (found->second <= 0) distinct_words.erase(found);
 			}
+		}
+	}
+}
 
-			compare_count += 1;
+static void record_histogram(prop_text_summary& summary, const std::u8string_view text, const df::file_type_ref ft,
+	const df::file_size size, const int delta)
+{
+	if (delta > 0)
+	{
+		summary[text].record(ft, size);
+	}
+	else
+	{
+		const auto found = summary.find(text);
 
-			const auto* const file = it.second;
-			const auto* const other_file = hit.second;
+		if (found != summary.end())
+		{
+			found->second.remove(ft, size);
+			if (found->second.is_empty()) summary.erase(found);
+		}
+	}
+}
 
-			if (file != other_file && is_dup_match(file, other_file))
+void index_summary::record(const prop::item_metadata& md, const df::file_type_ref ft, const df::file_size size,
+	const int delta)
+{
+	// distinct text is only added to, a full rebuild removes unused values;
+	// words are counted so they are erased as soon as no item uses them
+	auto add_words = [this, delta](const str::cached text, const prop::key_ref key)
+		{
+			if (!prop::is_null(text))
 			{
-				if (file->duplicates.group == other_file->duplicates.group)
-				{
-					if (file->duplicates.group == 0)
-					{
-						other_file->duplicates.group = file->duplicates.group = ++next_dup_group;
-					}
-				}
-				else
+				record_words(_distinct_words, text, delta);
+				if (delta > 0) _distinct_text[key].emplace(text);
+			}
+		};
+
+	split2(md.tags, true, [this, ft, size, delta](const std::u8string_view part)
+		{
+			const auto cached_tag = str::cache(part);
+			const auto tag_word = str::cache(str::format(u8"#{}"sv, part));
+
+			if (delta > 0)
+			{
+				_distinct_text[prop::tag].emplace(cached_tag);
+				_distinct_words[tag_word] += 1;
+			}
+			else
+			{
+				const auto found = _distinct_words.find(tag_word);
+
+				if (found != _distinct_words.end())
 				{
-					if (file->duplicates.group == 0)
-					{
-						file->duplicates.group = other_file->duplicates.group;
-					}
-					else if (other_file->duplicates.group == 0)
-					{
-						other_file->duplicates.group = file->duplicates.group;
-					}
-					else
-					{
-						if (!group_coalesce.contains(other_file->duplicates.group))
-						{
-							group_coalesce[file->duplicates.group] = other_file->duplicates.group;
-						}
-						else if (!group_coalesce.contains(file->duplicates.group))
-						{
-							group_coalesce[other_file->duplicates.group] = file->duplicates.group;
-						}
-					}
+					found->second += -1;
+					if (found->second <= 0) _distinct_words.erase(found);
 				}
 			}
-		}
+
+			record_histogram(_distinct_tags, cached_tag, ft, size, delta);
+		});
+
+	add_words(md.album, prop::album);
+	add_words(md.album_artist, prop::album_artist);
+	add_words(md.artist, prop::artist);
+	add_words(md.audio_codec, prop::audio_codec);
+	add_words(md.bitrate, prop::bitrate);
+	add_words(md.camera_manufacturer, prop::camera_manufacturer);
+	add_words(md.camera_model, prop::camera_model);
+	add_words(md.comment, prop::comment);
+	add_words(md.composer, prop::composer);
+	add_words(md.copyright_creator, prop::copyright_creator);
+	add_words(md.copyright_credit, prop::copyright_credit);
+	add_words(md.copyright_notice, prop::copyright_notice);
+	add_words(md.copyright_source, prop::copyright_source);
+	add_words(md.copyright_url, prop::copyright_url);
+	add_words(md.description, prop::description);
+	add_words(md.encoder, prop::encoder);
+	add_words(md.file_name, prop::file_name);
+	add_words(md.genre, prop::genre);
+	add_words(md.lens, prop::lens);
+	add_words(md.location_place, prop::location_place);
+	add_words(md.location_country, prop::location_country);
+	add_words(md.location_state, prop::location_state);
+	add_words(md.performer, prop::performer);
+	add_words(md.pixel_format, prop::pixel_format);
+	add_words(md.publisher, prop::publisher);
+	add_words(md.show, prop::show);
+	add_words(md.synopsis, prop::synopsis);
+	add_words(md.title, prop::title);
+	add_words(md.video_codec, prop::video_codec);
+	add_words(md.raw_file_name, prop::raw_file_name);
+
+	if (!prop::is_null(md.label)) record_histogram(_distinct_labels, md.label, ft, size, delta);
+}
+
+void index_summary::record_rating(int rating, const df::file_type_ref ft, const df::file_size size, const int delta)
+{
+	if (rating != 0 && rating < 6)
+	{
+		if (rating == -1) rating = 0;
+		if (delta > 0) _distinct_ratings[rating].record(ft, size);
+		else _distinct_ratings[rating].remove(ft, size);
 	}
+}
 
-	for (const auto& ifn : folders)
+// file supplies the type, size and dates counted so a -1 pass must be given the
+// item as it was recorded, not as it is now
+static void record_summary(index_summary& summary, const location_cache& locations, const df::index_file_item& file,
+	const prop::item_metadata* md, const int delta)
+{
+	summary._histograms.record(locations, file, md, delta);
+
+	if (md)
 	{
-		if (ifn.second->is_in_collection)
-		{
-			for (const auto& file : ifn.second->files)
-			{
-				if (df::is_closing) return;
+		summary.record(*md, file.ft, file.size, delta);
+		summary.record_rating(md->rating, file.ft, file.size, delta);
+	}
+}
 
-				if (file.duplicates.group)
-				{
-					const auto found = group_coalesce.find(file.duplicates.group);
+void index_state::update_summary(const df::index_file_item& file, const prop::item_metadata* previous,
+	const prop::item_metadata* current)
+{
+	platform::exclusive_lock lock(_summary_rw);
+	_summary_changes += 1;
+	_auto_complete_changes += 1;
 
-					if (found != group_coalesce.end())
-					{
-						file.duplicates.group = found->second;
-					}
-				}
+	if (!_summary_stale)
+	{
+		record_summary(_summary, _locations, file, previous, -1);
+		record_summary(_summary, _locations, file, current, 1);
+	}
+}
 
-				++group_counts[file.duplicates.group];
-			}
+void index_state::update_summary(const df::index_item_infos& previous, const df::index_item_infos& current)
+{
+	platform::exclusive_lock lock(_summary_rw);
+	_summary_changes += 1;
+	_auto_complete_changes += 1;
+
+	if (!_summary_stale)
+	{
+		for (const auto& file : previous)
+		{
+			const auto md = file.metadata.load();
+			record_summary(_summary, _locations, file, md.get(), -1);
 		}
+
+		for (const auto& file : current)
+		{
+			const auto md = file.metadata.load();
+			record_summary(_summary, _locations, file, md.get(), 1);
+		}
+	}
+}
+
+void index_state::update_collection_membership(const df::index_folder_item_ptr& folder, const bool is_in_collection)
+{
+	if (folder->is_in_collection != is_in_collection)
+	{
+		folder->is_in_collection = is_in_collection;
+
+		if (is_in_collection) update_summary({}, folder->files);
+		else update_summary(folder->files, {});
 	}
+}
+
+void index_state::invalidate_summary()
+{
+	platform::exclusive_lock lock(_summary_rw);
+	_summary_stale = true;
+}
+
+// Rebuilds the auto-complete indexes from a snapshot of the summary. Building
+// runs outside the lock and queries keep using the previous indexes until the
+// new ones are swapped in.
+void index_state::update_auto_complete()
+{
+	const auto start_ms = df::now_ms();
 
-	group_counts[0] = 1;
+	std::vector<auto_complete_index::entry> words;
+	std::vector<auto_complete_index::entry> folders;
+	uint32_t changes = 0;
 
-	for (const auto& ifn : folders)
 	{
-		if (ifn.second->is_in_collection)
+		platform::shared_lock lock(_summary_rw);
+		changes = _auto_complete_changes;
+
+		if (_auto_complete_words && _auto_complete_words->changes == changes)
 		{
-			for (const auto& file : ifn.second->files)
+			return;
+		}
+
+		words.reserve(_summary._distinct_words.size());
+
+		for (const auto& w : _summary._distinct_words)
+		{
+			words.emplace_back(w.first, static_cast<uint32_t>(w.second), 0u);
+		}
+
+		// folders have no counts so prime folders rank first, then indexed folders, then others
+		df::unique_folders seen;
+		uint32_t rank = 3;
+
+		for (const auto* distinct : {
+				 &_summary._distinct_prime_folders, &_summary._distinct_folders, &_summary._distinct_other_folders
+			 })
+		{
+			for (const auto& folder : *distinct)
 			{
-				if (df::is_closing) return;
-				const auto count = static_cast<uint32_t>(group_counts[file.duplicates.group]);
-				file.update_duplicates(ifn.second, { file.duplicates.group, count });
+				if (seen.emplace(folder).second)
+				{
+					const auto name_pos = folder.is_root() ? 0_z : folder.find_last_slash() + 1;
+					folders.emplace_back(folder.text(), rank, static_cast<uint32_t>(name_pos));
+				}
 			}
+
+			rank -= 1;
 		}
 	}
 
-	stats.indexed_dup_folder_count = static_cast<int>(group_counts.size()) - 1;
-	stats.indexed_crc_count = indexed_crc_count;
-	stats.indexed_max_compare_count = max_compare_count;
-	stats.update_presence_ms = static_cast<int>(df::now_ms() - start_ms);
+	auto word_index = std::make_shared<auto_complete_index>();
+	word_index->build(std::move(words));
+	word_index->changes = changes;
 
-	df::trace(str::format(u8"Index update predictions: {} folders in {} ms"sv, folder_count, stats.update_presence_ms));
-}
+	auto folder_index = std::make_shared<auto_complete_index>();
+	folder_index->build(std::move(folders));
+	folder_index->changes = changes;
 
+	{
+		platform::exclusive_lock lock(_summary_rw);
+		_auto_complete_words = std::move(word_index);
+		_auto_complete_folders = std::move(folder_index);
+	}
 
-static void add_words(df::dense_string_counts& distinct_words, strings_by_prop& distinct_text, const str::cached text,
-	const prop::key_ref key)
-{
-	count_ranges(distinct_words, text);
-	distinct_text[key].emplace(text);
+	df::trace(str::format(u8"Index update auto complete in {} ms"sv, df::now_ms() - start_ms));
 }
 
-
 void index_state::update_summary()
 {
 	const auto start_ms = df::now_ms();
+	uint32_t changes = 0;
 
-	prop_text_summary distinct_labels;
-	prop_num_summary distinct_ratings;
-	prop_text_summary distinct_tags;
+	{
+		platform::shared_lock lock(_summary_rw);
+		changes = _summary_changes;
+	}
 
-	df::dense_string_counts distinct_words;
-	strings_by_prop distinct_text;
+	index_summary summary;
 	df::unique_folders distinct_other_folders;
-
-	index_histograms histograms;
-
-	auto& distinct_tag_texts = distinct_text[prop::tag];
+	record_file_group_words(summary._distinct_words);
 
 	const auto folders = _items.all_folders();
 
 	for (const auto& ifn : folders)
 	{
-		const auto is_indexed = ifn.second->is_in_collection;
-
-		if (is_indexed)
+		if (ifn.second->is_in_collection)
 		{
 			for (const auto& file : ifn.second->files)
 			{
 				if (df::is_closing) return;
 
-				histograms.record(_locations, file);
 				const auto md = file.metadata.load();
 
 				if (md)
 				{
-					split2(md->tags, true,
-						[&distinct_words, &distinct_tags, &distinct_tag_texts, &file](const std::u8string_view part)
-						{
-							const auto cached_tag = str::cache(part);
-							distinct_tag_texts.emplace(cached_tag);
-							distinct_words[str::cache(str::format(u8"#{}"sv, part))] += 1;
-							distinct_tags[cached_tag].record(file);
-						});
-
-					if (!prop::is_null(md->album)) add_words(distinct_words, distinct_text, md->album, prop::album);
-					if (!prop::is_null(md->album_artist))
-						add_words(distinct_words, distinct_text, md->album_artist,
-							prop::album_artist);
-					if (!prop::is_null(md->artist)) add_words(distinct_words, distinct_text, md->artist, prop::artist);
-					if (!prop::is_null(md->audio_codec))
-						add_words(distinct_words, distinct_text, md->audio_codec,
-							prop::audio_codec);
-					if (!prop::is_null(md->bitrate))
-						add_words(distinct_words, distinct_text, md->bitrate,
-							prop::bitrate);
-					if (!prop::is_null(md->camera_manufacturer))
-						add_words(
-							distinct_words, distinct_text, md->camera_manufacturer, prop::camera_manufacturer);
-					if (!prop::is_null(md->camera_model))
-						add_words(distinct_words, distinct_text, md->camera_model,
-							prop::camera_model);
-					if (!prop::is_null(md->comment))
-						add_words(distinct_words, distinct_text, md->comment,
-							prop::comment);
-					if (!prop::is_null(md->composer))
-						add_words(distinct_words, distinct_text, md->composer,
-							prop::composer);
-					if (!prop::is_null(md->copyright_creator))
-						add_words(
-							distinct_words, distinct_text, md->copyright_creator, prop::copyright_creator);
-					if (!prop::is_null(md->copyright_credit))
-						add_words(distinct_words, distinct_text,
-							md->copyright_credit, prop::copyright_credit);
-					if (!prop::is_null(md->copyright_notice))
-						add_words(distinct_words, distinct_text,
-							md->copyright_notice, prop::copyright_notice);
-					if (!prop::is_null(md->copyright_source))
-						add_words(distinct_words, distinct_text,
-							md->copyright_source, prop::copyright_source);
-					if (!prop::is_null(md->copyright_url))
-						add_words(distinct_words, distinct_text, md->copyright_url,
-							prop::copyright_url);
-					if (!prop::is_null(md->description))
-						add_words(distinct_words, distinct_text, md->description,
-							prop::description);
-					if (!prop::is_null(md->encoder))
-						add_words(distinct_words, distinct_text, md->encoder,
-							prop::encoder);
-					if (!prop::is_null(md->file_name))
-						add_words(distinct_words, distinct_text, md->file_name,
-							prop::file_name);
-					if (!prop::is_null(md->genre)) add_words(distinct_words, distinct_text, md->genre, prop::genre);
-					if (!prop::is_null(md->lens)) add_words(distinct_words, distinct_text, md->lens, prop::lens);
-					if (!prop::is_null(md->location_place))
-						add_words(distinct_words, distinct_text, md->location_place,
-							prop::location_place);
-					if (!prop::is_null(md->location_country))
-						add_words(distinct_words, distinct_text,
-							md->location_country, prop::location_country);
-					if (!prop::is_null(md->location_state))
-						add_words(distinct_words, distinct_text, md->location_state,
-							prop::location_state);
-					if (!prop::is_null(md->performer))
-						add_words(distinct_words, distinct_text, md->performer,
-							prop::performer);
-					if (!prop::is_null(md->pixel_format))
-						add_words(distinct_words, distinct_text, md->pixel_format,
-							prop::pixel_format);
-					if (!prop::is_null(md->publisher))
-						add_words(distinct_words, distinct_text, md->publisher,
-							prop::publisher);
-					if (!prop::is_null(md->show)) add_words(distinct_words, distinct_text, md->show, prop::show);
-					if (!prop::is_null(md->synopsis))
-						add_words(distinct_words, distinct_text, md->synopsis,
-							prop::synopsis);
-					if (!prop::is_null(md->title)) add_words(distinct_words, distinct_text, md->title, prop::title);
-					if (!prop::is_null(md->video_codec))
-						add_words(distinct_words, distinct_text, md->video_codec,
-							prop::video_codec);
-					if (!prop::is_null(md->raw_file_name))
-						add_words(distinct_words, distinct_text, md->raw_file_name,
-							prop::raw_file_name);
-
-					if (!prop::is_null(md->label)) distinct_labels[md->label].record(file);
-
-					auto r = md->rating;
-
-					if (r != 0 && r < 6)
-					{
-						if (r == -1) r = 0;
-						distinct_ratings[r].record(file);
-					}
+					summary.record(*md, file.ft, file.size, 1);
+				}
+			}
+		}
+		else
+		{
+			distinct_other_folders.emplace(ifn.first);
+		}
+	}
+
+	// histograms and ratings only need the columnar snapshot
+	const auto columns = this->columns();
+
+	// reverse geocode every geotagged row in one batch
+	std::vector<gps_coordinate> coords;
+	std::vector<size_t> coord_rows;
+
+	for (size_t f = 0; f < columns->folder_count(); ++f)
+	{
+		if (columns->folders[f]->is_in_collection)
+		{
+			const auto last = columns->last_row(f);
+
+			for (auto row = columns->first_row(f); row < last; ++row)
+			{
+				if (columns->coordinate[row].is_valid())
+				{
+					coords.emplace_back(columns->coordinate[row]);
+					coord_rows.emplace_back(row);
 				}
 			}
 		}
+	}
+
+	const auto places = _locations.find_closest_places(coords);
+	df::hash_map<uint32_t, country_loc> countries;
+	size_t next_place = 0;
+
+	for (size_t f = 0; f < columns->folder_count(); ++f)
+	{
+		if (columns->folders[f]->is_in_collection)
+		{
+			if (df::is_closing) return;
+
+			const auto last = columns->last_row(f);
+
+			for (auto row = columns->first_row(f); row < last; ++row)
+			{
+				const auto ft = columns->ft[row];
+				const auto size = df::file_size(columns->size[row]);
+				country_loc country;
+
+				if (next_place < coord_rows.size() && coord_rows[next_place] == row)
+				{
+					const auto code = places[next_place++].country;
+					auto found = countries.find(code);
+
+					if (found == countries.end())
+					{
+						found = countries.emplace(code, _locations.find_country_loc(code)).first;
+					}
+
+					country = found->second;
+				}
 
-		if (!is_indexed)
-		{
-			distinct_other_folders.emplace(ifn.first);
+				summary._histograms.record(country, *columns, row);
+				summary.record_rating(columns->rating[row], ft, size, 1);
+			}
 		}
 	}
 
@@ -1286,7 +2945,7 @@ void index_state::update_summary()
 			_summary._distinct_other_folders.insert(v);
 		}
 
-		for (const auto& kv : distinct_text)
+		for (const auto& kv : summary._distinct_text)
 		{
 			auto& dest = _summary._distinct_text[kv.first];
 
@@ -1296,15 +2955,15 @@ void index_state::update_summary()
 			}
 		}
 
-		for (const auto& kv : distinct_words)
-		{
-			_summary._distinct_words[kv.first] = kv.second;
-		}
+		_summary._distinct_words = std::move(summary._distinct_words);
+		_summary._distinct_labels = std::move(summary._distinct_labels);
+		_summary._distinct_ratings = summary._distinct_ratings;
+		_summary._distinct_tags = std::move(summary._distinct_tags);
+		_summary._histograms = std::move(summary._histograms);
 
-		_summary._distinct_labels = std::move(distinct_labels);
-		_summary._distinct_ratings = distinct_ratings;
-		_summary._distinct_tags = std::move(distinct_tags);
-		_summary._histograms = std::move(histograms);
+		// changes made while rebuilding may have been missed
+		_summary_stale = _summary_changes != changes;
+		_auto_complete_changes += 1;
 	}
 
 	_async.invalidate_view(view_invalid::sidebar | view_invalid::tooltip);
@@ -1351,7 +3010,7 @@ static bool needs_scan_impl(const df::index_folder_item_ptr& f, const df::index_
 void index_state::scan_uncached(df::cancel_token token)
 {
 	df::scope_locked_inc l(indexing);
-	std::vector<df::file_path> uncached;
+	std::vector<scan_request> uncached;
 
 	size_t items_in_index = 0;
 
@@ -1371,7 +3030,7 @@ void index_state::scan_uncached(df::cancel_token token)
 
 						if (needs_scan_impl(folder.second, file, false, false, nullptr))
 						{
-							uncached.emplace_back(folder.first, file.name);
+							uncached.push_back({ folder.second, df::file_path(folder.first, file.name), nullptr, file.ft });
 						}
 					}
 				}
@@ -1384,24 +3043,157 @@ void index_state::scan_uncached(df::cancel_token token)
 
 	_async.invalidate_view(view_invalid::view_layout);
 
-	for (const auto& id : uncached)
+	scan_pipeline(uncached, false, false, token);
+
+	stats.index_item_remaining = 0;
+
+	_async.invalidate_view(view_invalid::view_layout | view_invalid::group_layout);
+	_fully_loaded = true;
+}
+
+void index_state::fingerprint_files(df::cancel_token token)
+{
+	// Files up to full_hash_limit are hashed whole. Larger files are only
+	// hashed when another file has the same size and head+tail hash, so a
+	// multi-GB video with a unique size is never read in full.
+	constexpr uint64_t full_hash_limit = 256ull * df::one_meg;
+	constexpr uint32_t head_tail_span = 64u * 1024u;
+
+	using fingerprint_file = fingerprint_pass::file;
+
+	auto pass = std::make_shared<fingerprint_pass>(token);
+	auto& files = pass->files;
+	df::hash_map<uint64_t, std::vector<fingerprint_file>> large_by_size;
+
+	for (const auto& folder : _items.all_folders())
 	{
-		if (token.is_cancelled()) break;
+		if (!folder.second->is_in_collection) continue;
+
+		for (const auto& file : folder.second->files)
+		{
+			const auto size = file.size.to_int64();
+			if (size == 0) continue;
+
+			if (size > full_hash_limit)
+			{
+				large_by_size[size].emplace_back(fingerprint_file{ df::file_path(folder.first, file.name), size, file.crc32c != 0 });
+			}
+			else if (file.crc32c == 0)
+			{
+				files.emplace_back(fingerprint_file{ df::file_path(folder.first, file.name), size, false });
+			}
+		}
+	}
 
-		const auto f = _items.find(id.folder());
+	for (auto& same_size : large_by_size)
+	{
+		if (same_size.second.size() < 2) continue;
+
+		df::hash_map<uint32_t, std::vector<fingerprint_file>> by_head_tail;
 
-		if (f)
+		for (const auto& f : same_size.second)
 		{
-			scan_item(f, id, false, false, nullptr, files::file_type_from_name(id.name()));
+			if (token.is_cancelled()) return;
+			const auto partial = platform::file_head_tail_crc32(f.path, head_tail_span);
+			if (partial) by_head_tail[partial].emplace_back(f);
 		}
 
-		--stats.index_item_remaining;
+		for (const auto& candidates : by_head_tail)
+		{
+			if (candidates.second.size() < 2) continue;
+
+			for (const auto& f : candidates.second)
+			{
+				if (!f.has_crc) files.emplace_back(f);
+			}
+		}
 	}
 
-	stats.index_item_remaining = 0;
+	stats.fingerprint_remaining = static_cast<int>(files.size());
+	pass->start_ms = df::now_ms();
 
-	_async.invalidate_view(view_invalid::view_layout | view_invalid::group_layout);
-	_fully_loaded = true;
+	_fingerprint = std::move(pass);
+	_fingerprint_resume_ms = 0;
+	fingerprint_chunk();
+}
+
+// Hashes files of the current pass until it has to yield. Waits leave the
+// worker free: the chunk records when it is due and returns.
+void index_state::fingerprint_chunk()
+{
+	constexpr uint64_t max_bytes_per_second = 64ull * df::one_meg;
+	constexpr int64_t slice_ms = 500;
+	constexpr int64_t thumbnail_wait_ms = 100;
+
+	const auto pass = _fingerprint;
+	if (!pass) return;
+
+	const auto& token = pass->token;
+	const auto slice_start_ms = df::now_ms();
+
+	while (pass->next < pass->files.size())
+	{
+		if (token.is_cancelled() || df::is_closing)
+		{
+			_fingerprint.reset();
+			stats.fingerprint_remaining = 0;
+			return;
+		}
+
+		// interactive thumbnail loads get the disk first
+		if (thumbnailing_items > 0)
+		{
+			_fingerprint_resume_ms = df::now_ms() + thumbnail_wait_ms;
+			return;
+		}
+
+		// throttle to max_bytes_per_second averaged over the pass
+		const auto now_ms = df::now_ms();
+		const auto due_ms = static_cast<int64_t>(pass->bytes_read * 1000 / max_bytes_per_second);
+		const auto elapsed_ms = now_ms - pass->start_ms;
+
+		if (due_ms > elapsed_ms)
+		{
+			_fingerprint_resume_ms = now_ms + std::min(due_ms - elapsed_ms, int64_t{ 1000 });
+			return;
+		}
+
+		// other background lanes get a turn between slices
+		if (now_ms - slice_start_ms > slice_ms)
+		{
+			queue_fingerprint_chunk();
+			return;
+		}
+
+		const auto& f = pass->files[pass->next++];
+		const auto crc = platform::file_crc32(f.path);
+
+		if (crc)
+		{
+			update_crc(f.path, crc);
+
+			item_db_write write;
+			write.path = f.path;
+			write.crc32c = crc;
+			_db_writes.enqueue(std::move(write));
+			++pass->hashed;
+		}
+
+		--stats.fingerprint_remaining;
+		pass->bytes_read += f.size;
+	}
+
+	_fingerprint.reset();
+	stats.fingerprint_remaining = 0;
+	stats.fingerprint_hashed += pass->hashed;
+
+	df::trace(str::format(u8"Index fingerprinted {} files in {} ms"sv, pass->hashed, df::now_ms() - pass->start_ms));
+
+	if (pass->hashed > 0)
+	{
+		queue_update_predictions();
+		_async.invalidate_view(view_invalid::index_summary);
+	}
 }
 
 std::vector<folder_scan_item> index_state::scan_items(const df::index_roots& roots, const bool recursive,
@@ -1414,21 +3206,29 @@ std::vector<folder_scan_item> index_state::scan_items(const df::index_roots& roo
 
 	auto update_index_summary = false;
 
-	while (!folders_to_scan.empty())
-	{
-		if (token.is_cancelled()) break;
-
-		const auto folder_path = folders_to_scan.back();
-		folders_to_scan.pop_back();
-
-		if (!is_excluded(roots, folder_path))
+	// items are scanned with their folder listing, several folders at a time
+	platform::walk_folders(std::move(folders_to_scan),
+		[this, &roots, now, scan_if_offline, &token](const df::folder_path& folder_path)
 		{
-			const auto node = validate_folder(folder_path, true, now);
+			if (is_excluded(roots, folder_path)) return validate_folder_result{};
+
+			auto node = validate_folder(folder_path, true, now);
 
 			for (const auto& file : node.folder->files)
 			{
 				if (token.is_cancelled()) break;
 				scan_item(node.folder, folder_path.combine_file(file.name), false, scan_if_offline, nullptr, file.ft);
+			}
+
+			return node;
+		},
+		[&](const df::folder_path& folder_path, const validate_folder_result& node,
+			std::vector<df::folder_path>& pending)
+		{
+			if (!node.folder) return;
+
+			for (const auto& file : node.folder->files)
+			{
 				results.emplace_back(folder_path, file);
 			}
 
@@ -1436,13 +3236,12 @@ std::vector<folder_scan_item> index_state::scan_items(const df::index_roots& roo
 			{
 				for (const auto& sub_folder : node.folder->folders)
 				{
-					folders_to_scan.emplace_back(folder_path.combine(sub_folder->name));
+					pending.emplace_back(folder_path.combine(sub_folder->name));
 				}
 			}
 
 			update_index_summary = update_index_summary || (node.folder->is_in_collection && node.was_updated);
-		}
-	}
+		}, token);
 
 	for (const auto& file_path : roots.files)
 	{
@@ -1481,250 +3280,519 @@ struct scope_locked_loading_thumbnail
 	}
 };
 
-void index_state::scan_item(const df::index_folder_item_ptr& folder,
-	const df::file_path file_path,
-	const bool load_thumb,
-	const bool scan_if_offline,
-	const df::item_element_ptr& item,
-	const file_type_ref ft)
+struct index_scan_job
 {
-	const auto now = platform::now();
-	const auto found_file = find_file(folder->files, file_path.name());
+	df::index_folder_item_ptr folder;
+	df::file_path path;
+	df::item_element_ptr item;
+	file_type_ref ft = nullptr;
+	bool load_thumb = false;
+	bool scan_if_offline = false;
+
+	df::date_t now;
+	bool scanned = false;
+	uint64_t phash = 0;
+	std::shared_ptr<scope_locked_loading_thumbnail> loading_lock;
+	file_scan_result sr;
+	item_db_write write;
+	ui::const_image_ptr cover_art;
+	ui::const_image_ptr thumbnail_image;
+};
+
+// Reads and parses the file if it needs scanning. Returns false if the file
+// is no longer in its folder.
+bool index_state::scan_item_read(index_scan_job& job)
+{
+	const auto found_file = find_file(job.folder->files, job.path.name());
+
+	if (found_file == job.folder->files.end())
+	{
+		return false;
+	}
+
+	const auto& file = *found_file;
+	job.now = platform::now();
+	job.phash = file.phash;
+
+	if (needs_scan_impl(job.folder, file, job.load_thumb, job.scan_if_offline, job.item) &&
+		!crash_files.is_known_crash_file(job.path))
+	{
+		df::assert_true(job.ft->is_media());
+
+		record_open_path record(crash_files, job.path, str::utf8_cast(__FUNCTION__));
+
+		if (job.load_thumb && job.item && job.item->should_load_thumbnail())
+		{
+			job.loading_lock = std::make_shared<scope_locked_loading_thumbnail>(job.item);
+		}
+
+		files ff;
+		job.sr = ff.scan_file(job.path, job.load_thumb, job.ft, file.xmp(), setting.thumbnail_max_dimension);
+		job.scanned = true;
+	}
+
+	return true;
+}
+
+// Scales and encodes the thumbnail and cover art for the database.
+void index_state::scan_item_encode(index_scan_job& job)
+{
+	if (!job.scanned || !job.sr.success)
+	{
+		return;
+	}
+
+	record_open_path record(crash_files, job.path, str::utf8_cast(__FUNCTION__));
+
+	files ff;
+	const auto& sr = job.sr;
+	auto& write = job.write;
+	auto& cover_art = job.cover_art;
+	auto& thumbnail_image = job.thumbnail_image;
+
+	file_encode_params encode_params;
+	encode_params.jpeg_save_quality = thumbnail_quality;
+
+	ui::const_surface_ptr thumbnail_surface;
+
+	if (is_valid(sr.cover_art))
+	{
+		cover_art = sr.cover_art;
+		const auto max_extent = setting.thumbnail_max_dimension;
+		const auto cover_art_extent = cover_art->dimensions();
+
+		if (max_extent.cx < cover_art_extent.cx || max_extent.cy < cover_art_extent.cy)
+		{
+			auto surf = ff.image_to_surface(cover_art, max_extent);
+			cover_art = ff.surface_to_image(surf, {}, encode_params,
+				ui::image_format::Unknown);
+		}
+
+		df::assert_true(cover_art->data().size() < df::two_fifty_six_k);
+
+		if (is_valid(cover_art))
+		{
+			write.cover_art = cover_art;
+		}
+	}
+
+	if (is_valid(sr.thumbnail_surface))
+	{
+		const auto max_extent = setting.thumbnail_max_dimension;
+		const auto thumb_extent = sr.thumbnail_surface->dimensions();
+
+		if (max_extent.cx < thumb_extent.cx || max_extent.cy < thumb_extent.cy)
+		{
+			av_scaler scaler;
+			const auto dims = ui::scale_dimensions(thumb_extent, max_extent, true);
+			auto surf = std::make_shared<ui::surface>();
+			scaler.scale_surface(sr.thumbnail_surface, surf, dims);
+			thumbnail_image = ff.surface_to_image(surf, {}, encode_params, ui::image_format::Unknown);
+			thumbnail_surface = surf;
+		}
+		else
+		{
+			auto surf = sr.thumbnail_surface;
+			thumbnail_image = ff.surface_to_image(surf, {}, encode_params, ui::image_format::Unknown);
+			thumbnail_surface = surf;
+		}
+
+		df::assert_true(thumbnail_image->data().size() < df::two_fifty_six_k);
 
-	if (found_file != folder->files.end())
+		if (is_valid(thumbnail_image))
+		{
+			write.thumb = thumbnail_image;
+		}
+	}
+	else if (is_valid(sr.thumbnail_image))
 	{
-		const auto& file = *found_file;
+		thumbnail_image = sr.thumbnail_image;
 
-		if (needs_scan_impl(folder, file, load_thumb, scan_if_offline, item))
+		if (is_valid(thumbnail_image))
 		{
-			if (!crash_files.is_known_crash_file(file_path))
+			const auto max_extent = setting.thumbnail_max_dimension;
+			const auto thumb_extent = thumbnail_image->dimensions();
+
+			if (max_extent.cx < thumb_extent.cx || max_extent.cy < thumb_extent.cy)
 			{
-				df::assert_true(ft->is_media());
+				auto surf = ff.image_to_surface(thumbnail_image, max_extent);
+				thumbnail_image = ff.surface_to_image(surf, {}, encode_params,
+					ui::image_format::Unknown);
+				thumbnail_surface = surf;
+			}
 
-				record_open_path record(crash_files, file_path, str::utf8_cast(__FUNCTION__));
-				std::shared_ptr<scope_locked_loading_thumbnail> loading_lock;
+			df::assert_true(thumbnail_image->data().size() < df::two_fifty_six_k);
 
-				if (load_thumb && item && item->should_load_thumbnail())
-				{
-					loading_lock = std::make_shared<scope_locked_loading_thumbnail>(item);
-				}
+			if (is_valid(thumbnail_image))
+			{
+				write.thumb = thumbnail_image;
+			}
+		}
+		else
+		{
+			// TODO - why
+			// df::assert_true(false);
+			thumbnail_image.reset();
 
-				files ff;
-				const auto sr = ff.scan_file(file_path, load_thumb, ft, file.xmp(), setting.thumbnail_max_dimension);
+			if (job.item)
+			{
+				job.item->failed_loading_thumbnail(true);
+			}
+		}
+	}
+	else if (job.load_thumb)
+	{
+		if (job.item)
+		{
+			job.item->failed_loading_thumbnail(true);
+		}
+	}
 
-				if (sr.success)
-				{
-					df::scope_locked_inc l(scanning_items);
-					const auto* const mt = files::file_type_from_name(file_path);
-					const auto metadata = sr.to_props();
-					const auto thumbnail_was_loaded = is_valid(sr.thumbnail_surface) || is_valid(sr.thumbnail_image);
+	// thumbnails stored as is were never decoded, a small decode is enough to hash them
+	if (!is_valid(thumbnail_surface) && is_valid(thumbnail_image))
+	{
+		thumbnail_surface = ff.image_to_surface(thumbnail_image, { 64, 64 });
+	}
 
-					if (mt->has_trait(file_traits::video_metadata))
-					{
-						const auto name_props = scan_info_from_title(file_path.file_name_without_extension());
-
-						if (is_empty(metadata->show) && !str::is_empty(name_props.show))
-							metadata->show = str::cache(
-								name_props.show);
-						if (is_empty(metadata->title) && !str::is_empty(name_props.title))
-							metadata->title = str::cache(
-								name_props.title);
-						if (metadata->year == 0 && name_props.year != 0) metadata->year = name_props.year;
-						if (metadata->episode == df::xy8::make(0, 0) && name_props.episode != 0)
-							metadata->episode =
-							df::xy8::make(name_props.episode, name_props.episode_of);
-						if (metadata->season == 0 && name_props.season != 0) metadata->season = name_props.season;
-					}
+	if (is_valid(thumbnail_surface))
+	{
+		job.phash = thumbnail_surface->perceptual_hash();
+	}
+}
 
-					item_db_write write;
-					write.path = file_path;
-					write.md = metadata;
-					write.metadata_scanned = now;
+// Updates the index with the scan results and queues the database write.
+void index_state::scan_item_apply(index_scan_job& job)
+{
+	const auto found_file = find_file(job.folder->files, job.path.name());
 
-					file_encode_params encode_params;
-					encode_params.jpeg_save_quality = thumbnail_quality;
+	if (found_file == job.folder->files.end())
+	{
+		return;
+	}
 
-					ui::const_image_ptr cover_art;
-					ui::const_image_ptr thumbnail_image;
-					ui::const_surface_ptr thumbnail_surface;
+	const auto& file = *found_file;
+	const auto& file_path = job.path;
+	const auto& folder = job.folder;
+	const auto& item = job.item;
+	const auto& sr = job.sr;
+	const auto now = job.now;
 
-					if (is_valid(sr.cover_art))
-					{
-						cover_art = sr.cover_art;
-						const auto max_extent = setting.thumbnail_max_dimension;
-						const auto cover_art_extent = cover_art->dimensions();
+	if (job.scanned)
+	{
+		if (sr.success)
+		{
+			df::scope_locked_inc l(scanning_items);
+			const auto* const mt = files::file_type_from_name(file_path);
+			const auto metadata = sr.to_props();
+			const auto thumbnail_was_loaded = is_valid(sr.thumbnail_surface) || is_valid(sr.thumbnail_image);
 
-						if (max_extent.cx < cover_art_extent.cx || max_extent.cy < cover_art_extent.cy)
-						{
-							auto surf = ff.image_to_surface(cover_art, max_extent);
-							cover_art = ff.surface_to_image(surf, {}, encode_params,
-								ui::image_format::Unknown);
-						}
+			if (mt->has_trait(file_traits::video_metadata))
+			{
+				const auto name_props = scan_info_from_title(file_path.file_name_without_extension());
+
+				if (is_empty(metadata->show) && !str::is_empty(name_props.show))
+					metadata->show = str::cache(
+						name_props.show);
+				if (is_empty(metadata->title) && !str::is_empty(name_props.title))
+					metadata->title = str::cache(
+						name_props.title);
+				if (metadata->year == 0 && name_props.year != 0) metadata->year = name_props.year;
+				if (metadata->episode == df::xy8::make(0, 0) && name_props.episode != 0)
+					metadata->episode =
+					df::xy8::make(name_props.episode, name_props.episode_of);
+				if (metadata->season == 0 && name_props.season != 0) metadata->season = name_props.season;
+			}
 
-						df::assert_true(cover_art->data().size() < df::two_fifty_six_k);
+			auto& write = job.write;
+			write.path = file_path;
+			write.md = metadata;
+			write.metadata_scanned = now;
 
-						if (is_valid(cover_art))
-						{
-							write.cover_art = cover_art;
-						}
-					}
+			// a scan that skipped the crc keeps the old one only if the file has not
+			// changed since it was last scanned, otherwise fingerprint_files recomputes it
+			auto crc32c = sr.crc32c;
+
+			if (!crc32c && found_file->metadata_scanned >= found_file->file_modified)
+			{
+				crc32c = found_file->crc32c;
+			}
+
+			write.crc32c = crc32c;
+
+			if (job.phash)
+			{
+				write.phash = job.phash;
+			}
+
+			if (job.load_thumb && thumbnail_was_loaded)
+			{
+				write.thumb_scanned = now;
+			}
+
+			const auto item_has_no_thumb = item && !item->has_thumb();
+			const auto existing_metadata = found_file->metadata.load();
+
+			if (existing_metadata && metadata)
+			{
+				metadata->sidecars = existing_metadata->sidecars;
+				metadata->xmp = existing_metadata->xmp;
+			}
 
-					if (is_valid(sr.thumbnail_surface))
+			found_file->metadata_scanned = now;
+			found_file->metadata.store(metadata);
+			found_file->crc32c = crc32c;
+			found_file->phash = job.phash;
+			metadata->file_name = file_path.name();
+			_terms.update(file_path, existing_metadata.get(), *found_file);
+			invalidate_columns(file_path.folder());
+			if (folder->is_in_collection) update_summary(*found_file, existing_metadata.get(), metadata.get());
+
+			write.modified = found_file->file_modified;
+
+			if (item)
+			{
+				const auto& thumbnail_image = job.thumbnail_image;
+				const auto& cover_art = job.cover_art;
+
+				if ((thumbnail_was_loaded || item_has_no_thumb) && (is_valid(thumbnail_image) || is_valid(cover_art)))
+				{
+					df::assert_true(!is_valid(thumbnail_image) || thumbnail_image->data().size() < df::two_fifty_six_k);
+					df::assert_true(!is_valid(cover_art) || cover_art->data().size() < df::two_fifty_six_k);
+
+					item->thumbnail(thumbnail_image, cover_art, thumbnail_was_loaded ? now : df::date_t::null);
+					_async.invalidate_view(view_invalid::view_redraw);
+				}
+			}
+
+			_db_writes.enqueue(std::move(write));
+
+			if (metadata->coordinate.is_valid() &&
+				prop::is_null(metadata->location_country) &&
+				prop::is_null(metadata->location_state) &&
+				prop::is_null(metadata->location_place))
+			{
+
+				_async.queue_location(
+					[this, folder, file_path, coord = metadata->coordinate](location_cache& locations)
 					{
-						const auto max_extent = setting.thumbnail_max_dimension;
-						const auto thumb_extent = sr.thumbnail_surface->dimensions();
+						const auto loc = locations.find_closest(coord.latitude(), coord.longitude());
+						save_location(file_path, loc);
 
-						if (max_extent.cx < thumb_extent.cx || max_extent.cy < thumb_extent.cy)
+						if (folder->is_in_collection)
 						{
-							av_scaler scaler;
-							const auto dims = ui::scale_dimensions(thumb_extent, max_extent, true);
-							auto surf = std::make_shared<ui::surface>();
-							scaler.scale_surface(sr.thumbnail_surface, surf, dims);
-							thumbnail_image = ff.surface_to_image(surf, {}, encode_params, ui::image_format::Unknown);
-							thumbnail_surface = surf;
-						}
-						else
-						{
-							auto surf = sr.thumbnail_surface;
-							thumbnail_image = ff.surface_to_image(surf, {}, encode_params, ui::image_format::Unknown);
-							thumbnail_surface = surf;
+							_async.invalidate_view(view_invalid::index_summary);
 						}
+					});
+			}
+
+			if (folder->is_in_collection)
+			{
+				_async.invalidate_view(view_invalid::index_summary);
+			}
+		}
+		else
+		{
+			item_db_write write;
+			write.path = file_path;
+			write.metadata_scanned = now;
+			write.modified = found_file->file_modified;
+			_db_writes.enqueue(std::move(write));
+
+			if (job.load_thumb && item)
+			{
+				item->failed_loading_thumbnail(true);
+			}
+		}
 
-						df::assert_true(thumbnail_image->data().size() < df::two_fifty_six_k);
+		job.loading_lock.reset();
+	}
 
-						if (is_valid(thumbnail_image))
-						{
-							write.thumb = thumbnail_image;
-						}
-					}
-					else if (is_valid(sr.thumbnail_image))
-					{
-						thumbnail_image = sr.thumbnail_image;
+	if (item)
+	{
+		item->update(file_path, file);
+	}
+}
+
+void index_state::scan_item(const df::index_folder_item_ptr& folder,
+	const df::file_path file_path,
+	const bool load_thumb,
+	const bool scan_if_offline,
+	const df::item_element_ptr& item,
+	const file_type_ref ft)
+{
+	index_scan_job job{ folder, file_path, item, ft, load_thumb, scan_if_offline };
+
+	if (scan_item_read(job))
+	{
+		scan_item_encode(job);
+		scan_item_apply(job);
+	}
+}
+
+static constexpr std::u8string_view scan_stage_names[] = {
+	u8"enumerate"sv, u8"prefetch"sv, u8"decode"sv, u8"encode"sv, u8"apply"sv
+};
+
+std::u8string format_scan_stage(const scan_stage_statistic& s)
+{
+	return str::format(u8"{} threads={} items={} | busy ms={} starved ms={} blocked ms={}"sv,
+		s.name, s.threads, s.items, s.busy_ms, s.starved_ms, s.blocked_ms);
+}
+
+// Warms the system cache with the head of the file, where the metadata and
+// embedded previews are. Decoders then rarely wait on the disk or network.
+static void prefetch_file(const df::file_path path)
+{
+	const auto f = open_file(path, platform::file_open_mode::sequential_scan);
+
+	if (f)
+	{
+		df::blob buffer(static_cast<size_t>(std::min(f->size(), static_cast<uint64_t>(df::two_fifty_six_k))));
+		f->read(buffer.data(), buffer.size());
+	}
+}
+
+// Scans in stages connected by bounded queues: enumerate (the calling thread),
+// prefetch, decode, encode and apply. Each stage has its own thread count:
+// prefetch keeps many reads in flight for network shares, decode and encode
+// are sized to the cores and apply is one thread as it mutates the index. The
+// database thread batches the writes apply queues. A full queue blocks the
+// stage feeding it, so memory stays bounded whichever stage is slowest.
+void index_state::scan_pipeline(const std::vector<scan_request>& requests, const bool load_thumb,
+	const bool scan_if_offline, df::cancel_token token)
+{
+	using job_ptr = std::unique_ptr<index_scan_job>;
+	using job_queue = platform::bounded_queue<job_ptr>;
+
+	struct stage_counters
+	{
+		size_t threads = 1;
+		std::atomic_int items = 0;
+		std::atomic_int64_t busy_us = 0;
+		std::atomic_int64_t starved_us = 0;
+		std::atomic_int64_t blocked_us = 0;
+	};
+
+	static constexpr size_t queue_capacity = 64;
+	const auto cores = platform::default_work_pool().worker_count();
+	const auto now_us = [] { return static_cast<int64_t>(df::now() * 1000000.0); };
+
+	std::array<stage_counters, std::size(scan_stage_names)> counters;
+	job_queue prefetch_queue(queue_capacity);
+	job_queue decode_queue(queue_capacity);
+	job_queue encode_queue(queue_capacity);
+	job_queue apply_queue(queue_capacity);
+	platform::threads threads;
+
+	// each thread pops from in, runs f and pushes to out if f returns true;
+	// the last thread of a stage to finish closes out. Cancelled stages keep
+	// draining their input so nothing upstream stays blocked.
+	const auto start_stage = [&](const size_t stage, const size_t thread_count, job_queue& in, job_queue* out,
+		std::function<bool(index_scan_job&)> f)
+	{
+		auto& c = counters[stage];
+		c.threads = thread_count;
+		auto remaining = std::make_shared<std::atomic_size_t>(thread_count);
 
-						if (is_valid(thumbnail_image))
-						{
-							const auto max_extent = setting.thumbnail_max_dimension;
-							const auto thumb_extent = thumbnail_image->dimensions();
+		for (size_t t = 0; t < thread_count; ++t)
+		{
+			threads.start([&c, &in, out, f, remaining, token, now_us]
+				{
+					platform::thread_init init;
+					job_ptr job;
+					auto idle_us = now_us();
 
-							if (max_extent.cx < thumb_extent.cx || max_extent.cy < thumb_extent.cy)
-							{
-								auto surf = ff.image_to_surface(thumbnail_image, max_extent);
-								thumbnail_image = ff.surface_to_image(surf, {}, encode_params,
-									ui::image_format::Unknown);
-								thumbnail_surface = surf;
-							}
+					while (in.pop(job))
+					{
+						const auto start_us = now_us();
+						c.starved_us += start_us - idle_us;
 
-							df::assert_true(thumbnail_image->data().size() < df::two_fifty_six_k);
+						bool keep = false;
 
-							if (is_valid(thumbnail_image))
-							{
-								write.thumb = thumbnail_image;
-							}
-						}
-						else
+						try
 						{
-							// TODO - why
-							// df::assert_true(false);
-							thumbnail_image.reset();
-
-							if (item)
-							{
-								item->failed_loading_thumbnail(true);
-							}
+							keep = !token.is_cancelled() && f(*job);
 						}
-					}
-					else if (load_thumb)
-					{
-						if (item)
+						catch (std::exception& e)
 						{
-							item->failed_loading_thumbnail(true);
+							df::log(__FUNCTION__, e.what());
 						}
-					}
-
-					if (sr.crc32c)
-					{
-						write.crc32c = sr.crc32c;
-					}
-
-					if (load_thumb && thumbnail_was_loaded)
-					{
-						write.thumb_scanned = now;
-					}
-
-					const auto item_has_no_thumb = item && !item->has_thumb();
-					const auto existing_metadata = found_file->metadata.load();
-
-					if (existing_metadata && metadata)
-					{
-						metadata->sidecars = existing_metadata->sidecars;
-						metadata->xmp = existing_metadata->xmp;
-					}
-
-					found_file->metadata_scanned = now;
-					found_file->metadata.store(metadata);
-					found_file->crc32c = sr.crc32c;
-					metadata->file_name = file_path.name();
 
-					write.modified = found_file->file_modified;
+						const auto done_us = now_us();
+						c.busy_us += done_us - start_us;
+						c.items += 1;
 
-					if (item)
-					{
-						if ((thumbnail_was_loaded || item_has_no_thumb) && (is_valid(thumbnail_image) || is_valid(cover_art)))
-						{
-							df::assert_true(!is_valid(thumbnail_image) || thumbnail_image->data().size() < df::two_fifty_six_k);
-							df::assert_true(!is_valid(cover_art) || cover_art->data().size() < df::two_fifty_six_k);
+						if (keep && out) out->push(std::move(job));
+						job.reset();
 
-							item->thumbnail(thumbnail_image, cover_art, thumbnail_was_loaded ? now : df::date_t::null);
-							_async.invalidate_view(view_invalid::view_redraw);
-						}
+						idle_us = now_us();
+						c.blocked_us += idle_us - done_us;
 					}
 
-					_db_writes.enqueue(std::move(write));
+					if (--*remaining == 0 && out) out->close();
+				});
+		}
+	};
 
-					if (metadata->coordinate.is_valid() &&
-						prop::is_null(metadata->location_country) &&
-						prop::is_null(metadata->location_state) &&
-						prop::is_null(metadata->location_place))
-					{
+	start_stage(1, 8, prefetch_queue, &decode_queue, [](index_scan_job& job)
+		{
+			prefetch_file(job.path);
+			return true;
+		});
+	start_stage(2, cores, decode_queue, &encode_queue, [this](index_scan_job& job)
+		{
+			return scan_item_read(job);
+		});
+	start_stage(3, std::max(cores / 2, 1_z), encode_queue, &apply_queue, [this](index_scan_job& job)
+		{
+			scan_item_encode(job);
+			return true;
+		});
+	start_stage(4, 1, apply_queue, nullptr, [this](index_scan_job& job)
+		{
+			scan_item_apply(job);
+			if (stats.index_item_remaining > 0) --stats.index_item_remaining;
+			return true;
+		});
 
-						_async.queue_location(
-							[this, folder, file_path, coord = metadata->coordinate](location_cache& locations)
-							{
-								const auto loc = locations.find_closest(coord.latitude(), coord.longitude());
-								save_location(file_path, loc);
+	auto& enumerate = counters[0];
+	auto busy_start_us = now_us();
 
-								if (folder->is_in_collection)
-								{
-									_async.invalidate_view(view_invalid::index_summary);
-								}
-							});
-					}
+	for (const auto& r : requests)
+	{
+		if (token.is_cancelled()) break;
 
-					if (folder->is_in_collection)
-					{
-						_async.invalidate_view(view_invalid::index_summary);
-					}
-				}
-				else
-				{
-					item_db_write write;
-					write.path = file_path;
-					write.metadata_scanned = now;
-					write.modified = found_file->file_modified;
-					_db_writes.enqueue(std::move(write));
+		auto job = std::make_unique<index_scan_job>();
+		job->folder = r.folder;
+		job->path = r.path;
+		job->item = r.item;
+		job->ft = r.ft;
+		job->load_thumb = load_thumb;
+		job->scan_if_offline = scan_if_offline;
+
+		const auto push_us = now_us();
+		enumerate.busy_us += push_us - busy_start_us;
+		enumerate.items += 1;
+		prefetch_queue.push(std::move(job));
+		busy_start_us = now_us();
+		enumerate.blocked_us += busy_start_us - push_us;
+	}
 
-					if (load_thumb && item)
-					{
-						item->failed_loading_thumbnail(true);
-					}
-				}
-			}
-		}
+	prefetch_queue.close();
+	threads.clear();
 
-		if (item)
-		{
-			item->update(file_path, file);
-		}
+	for (size_t i = 0; i < counters.size(); ++i)
+	{
+		const auto& c = counters[i];
+		auto& s = stats.scan_stages[i];
+		s.name = scan_stage_names[i];
+		s.threads = static_cast<int>(c.threads);
+		s.items = c.items;
+		s.busy_ms = static_cast<int>(c.busy_us / 1000);
+		s.starved_ms = static_cast<int>(c.starved_us / 1000);
+		s.blocked_ms = static_cast<int>(c.blocked_us / 1000);
+
+		df::trace(str::format(u8"Index scan stage {}"sv, format_scan_stage(s)));
 	}
 }
 
@@ -1769,72 +3837,93 @@ df::index_file_item index_state::find_item(const df::file_path id) const
 	return {};
 }
 
-void index_histograms::record(const location_cache& locations, const df::index_file_item& file)
+static df::date_t search_created(const df::index_file_item& file, const prop::item_metadata* md)
 {
-	static auto year = platform::now().year();
-	constexpr auto map_width = static_cast<int>(df::location_heat_map::map_width);
-	constexpr auto map_height = static_cast<int>(df::location_heat_map::map_height);
+	if (md)
+	{
+		if (md->created_exif.is_valid()) return md->created_exif;
+		if (md->created_utc.is_valid()) return md->created_utc.system_to_local();
+		if (md->created_digitized.is_valid()) return md->created_digitized;
+	}
+
+	return file.file_created;
+}
 
+void index_histograms::record(const location_cache& locations, const df::index_file_item& file)
+{
 	const auto md = file.metadata.load();
-	auto created = file.file_created;
+	record(locations, file, md.get(), 1);
+}
 
-	if (md)
-	{
-		if (md->created_exif.is_valid())
-		{
-			created = md->created_exif;
-		}
-		else if (md->created_utc.is_valid())
-		{
-			created = md->created_utc.system_to_local();
-		}
-		else if (md->created_digitized.is_valid())
-		{
-			created = md->created_digitized;
-		}
+void index_histograms::record(const location_cache& locations, const df::index_file_item& file,
+	const prop::item_metadata* md, const int delta)
+{
+	const auto coord = md ? md->coordinate : gps_coordinate{};
+	const auto country = coord.is_valid() ? locations.find_country(coord.latitude(), coord.longitude()) : country_loc{};
+	record(file.ft, file.size, search_created(file, md), file.file_modified, coord, country, delta);
+}
+
+void index_histograms::record(const country_loc& country, const df::index_columns& columns, const size_t row)
+{
+	record(columns.ft[row], df::file_size(columns.size[row]), columns.search_created(row),
+		columns.modified[row], columns.coordinate[row], country);
+}
 
-		const auto coord = md->coordinate;
+void index_histograms::record(const df::file_type_ref ft, const df::file_size size, const df::date_t created,
+	const df::date_t modified, const gps_coordinate coord, const country_loc& country, const int delta)
+{
+	static auto year = platform::now().year();
+	constexpr auto map_width = static_cast<int>(df::location_heat_map::map_width);
 
-		if (coord.is_valid())
+	if (coord.is_valid())
+	{
+		// heat map points are only added, a full rebuild clears them
+		if (delta > 0)
 		{
 			const auto map_loc = df::location_heat_map::calc_map_loc(coord);
 			_locations.coordinates[(map_loc.y * map_width) + map_loc.x] = 1;
+		}
 
-			const auto country = locations.find_country(coord.latitude(), coord.longitude());
-			const auto country_code = country.code;
-			const auto found = _location_groups.find(country_code);
+		const auto country_code = country.code;
+		const auto found = _location_groups.find(country_code);
 
-			if (found != _location_groups.end())
-			{
-				found->second.count += 1;
-			}
-			else
-			{
-				_location_groups[country_code] = {
-					country.name, 1, df::location_heat_map::calc_map_loc(country.centroid)
-				};
-			}
+		if (found != _location_groups.end())
+		{
+			if (delta > 0) found->second.count += 1;
+			else if (found->second.count > 1) found->second.count -= 1;
+			else _location_groups.erase(found);
+		}
+		else if (delta > 0)
+		{
+			_location_groups[country_code] = {
+				country.name, 1, df::location_heat_map::calc_map_loc(country.centroid)
+			};
 		}
 	}
 
-	auto& file_type = _file_types.counts[file.ft->group->id];
-	file_type.count += 1;
-	file_type.size += file.size;
+	if (delta > 0)
+	{
+		_file_types.record(ft, size);
+	}
+	else
+	{
+		_file_types.remove(ft, size);
+	}
 
 	const auto created_date_parts = created.date();
 	const auto created_year_offset = year - created_date_parts.year;
 
 	if (created_year_offset >= 0 && created_year_offset < 10)
 	{
-		_dates.dates[created_year_offset * 12 + created_date_parts.month - 1].created += 1;
+		_dates.dates[created_year_offset * 12 + created_date_parts.month - 1].created += delta;
 	}
 
-	const auto modified_date_parts = file.file_modified.date();
+	const auto modified_date_parts = modified.date();
 	const auto modified_date_parts_year_offset = year - modified_date_parts.year;
 
 	if (modified_date_parts_year_offset >= 0 && modified_date_parts_year_offset < 10)
 	{
-		_dates.dates[modified_date_parts_year_offset * 12 + modified_date_parts.month - 1].modified += 1;
+		_dates.dates[modified_date_parts_year_offset * 12 + modified_date_parts.month - 1].modified += delta;
 	}
 }
 
@@ -1894,23 +3983,29 @@ void index_state::save_media_position(const df::file_path id, const double media
 	_db_writes.enqueue(std::move(write));
 }
 
+void index_state::update_crc(const df::file_path id, const uint32_t crc)
+{
+	const auto f = _items.find(id.folder());
+
+	if (f)
+	{
+		const auto found_file = find_file(f->files, id.name());
+
+		if (found_file != f->files.end())
+		{
+			found_file->crc32c = crc;
+			found_file->calc_bloom_bits();
+			f->update_bloom_bits(*found_file);
+			invalidate_columns(id.folder());
+		}
+	}
+}
+
 void index_state::save_crc(const df::file_path id, const uint32_t crc)
 {
 	_async.queue_async(async_queue::work, [this, id, crc]()
 		{
-			const auto f = _items.find(id.folder());
-
-			if (f)
-			{
-				const auto found_file = find_file(f->files, id.name());
-
-				if (found_file != f->files.end())
-				{
-					found_file->crc32c = crc;
-					found_file->calc_bloom_bits();
-					f->update_bloom_bits(*found_file);
-				}
-			}
+			update_crc(id, crc);
 		});
 
 	item_db_write write;
@@ -1933,6 +4028,8 @@ void index_state::save_location(const df::file_path id, const location_t& loc)
 				{
 					auto md = found_file->safe_ps();
 
+					const prop::item_metadata previous = *md;
+
 					if (!md->coordinate.is_valid())
 					{
 						md->coordinate = loc.position;
@@ -1942,6 +4039,10 @@ void index_state::save_location(const df::file_path id, const location_t& loc)
 					md->location_state = loc.state;
 					md->location_country = loc.country;
 
+					_terms.update(id, &previous, *found_file);
+					invalidate_columns(id.folder());
+					if (found_folder->is_in_collection) update_summary(*found_file, &previous, md.get());
+
 					item_db_write write;
 					write.path = id;
 					write.md = md;
@@ -2006,29 +4107,31 @@ void index_state::index_folders(df::cancel_token token)
 
 	index_histograms histograms;
 	items_by_folder_t indexed;
+	df::unique_folders members;
 	int count = 0;
 	stats.index_folder_count = 0;
 
+	// membership is kept while walking so folder changes found by validate_folder
+	// still apply to the summary, only folders that join or leave change it
 	for (const auto& f : _items.all_folders())
 	{
-		f.second->is_in_collection = false;
 		f.second->is_excluded = false;
 	}
 
-	while (!folders.empty() && !token.is_cancelled())
-	{
-		if (token.is_cancelled())
+	// listings run concurrently, merging into the histograms and folder set is serialized by the walker
+	platform::walk_folders(std::move(folders), [this, &roots, now](const df::folder_path& folder_path)
 		{
-			break;
-		}
-
-		auto folder_path = folders.back();
-		folders.pop_back();
-
-		if (!is_excluded(roots, folder_path))
+			return is_excluded(roots, folder_path)
+				? validate_folder_result{}
+				: validate_folder(folder_path, true, now);
+		},
+		[&](const df::folder_path& folder_path, const validate_folder_result& node,
+			std::vector<df::folder_path>& pending)
 		{
-			const auto node = validate_folder(folder_path, true, now);
-			node.folder->is_in_collection = true;
+			if (!node.folder) return;
+
+			members.emplace(folder_path);
+			update_collection_membership(node.folder, true);
 
 			for (const auto& file : node.folder->files)
 			{
@@ -2046,28 +4149,35 @@ void index_state::index_folders(df::cancel_token token)
 				const auto is_excluded = df::is_excluded(roots, sub_folder_path);
 
 				if (!unique_folder_paths.contains(sub_folder_path) &&
-					folders.size() < max_folders_to_index &&
+					pending.size() < max_folders_to_index &&
 					!is_excluded)
 				{
-					folders.emplace_back(sub_folder_path);
+					pending.emplace_back(sub_folder_path);
 					unique_folder_paths.emplace(sub_folder_path);
 					++stats.index_folder_count;
 				}
 
 				sub_folder->is_excluded = is_excluded;
 			}
-		}
 
-		{
-			platform::exclusive_lock lock(_summary_rw);
-			_summary._histograms._file_types = histograms._file_types;
-			_summary._histograms._dates = histograms._dates;
-			_async.invalidate_view(view_invalid::sidebar_file_types_and_dates | view_invalid::tooltip);
-		}
-	}
+			{
+				platform::exclusive_lock lock(_summary_rw);
+				_summary._histograms._file_types = histograms._file_types;
+				_summary._histograms._dates = histograms._dates;
+				_async.invalidate_view(view_invalid::sidebar_file_types_and_dates | view_invalid::tooltip);
+			}
+		}, token);
 
 	if (!token.is_cancelled())
 	{
+		for (const auto& f : _items.all_folders())
+		{
+			if (!members.contains(f.first))
+			{
+				update_collection_membership(f.second, false);
+			}
+		}
+
 		stats.index_item_count = stats.media_item_count = count;
 
 		_async.queue_database([cached_items = all_indexed_items()](database& db)
@@ -2079,6 +4189,7 @@ void index_state::index_folders(df::cancel_token token)
 	{
 		platform::exclusive_lock lock(_summary_rw);
 		_summary._distinct_folders = std::move(unique_folder_paths);
+		_auto_complete_changes += 1;
 		stats.index_folder_count = static_cast<int>(_summary._distinct_folders.size());
 	}
 
@@ -2097,6 +4208,7 @@ void index_state::index_folders(df::cancel_token token)
 	{
 		platform::exclusive_lock lock(_summary_rw);
 		_summary._distinct_prime_folders = std::move(distinct_prime_folders);
+		_auto_complete_changes += 1;
 		_summary._histograms = std::move(histograms);
 	}
 
@@ -2319,42 +4431,32 @@ media_name_props scan_info_from_title(const std::u8string_view name8)
 	return result;
 }
 
-static void items_possible_hashes_contains(df::hash_map<df::item_element_ptr, item_presence>& item_presence,
-	const std::vector<std::pair<unsigned, df::item_element_ptr>>& possible,
-	const df::index_file_item& indexed_file, const uint32_t hash)
+static void update_item_presence(df::hash_map<df::item_element_ptr, item_presence>& item_presence,
+	const df::item_element_ptr& i, const df::index_file_item& indexed_file)
 {
-	auto lb = std::lower_bound(possible.begin(), possible.end(), hash, [](auto&& l, auto&& r) { return l.first < r; });
-
-	while (lb != possible.end() && lb->first == hash)
+	if (is_dup_match(indexed_file, i))
 	{
-		const auto i = lb->second;
+		i->duplicates(indexed_file.duplicates);
 
-		if (is_dup_match(indexed_file, i))
+		if (indexed_file.file_modified == i->file_modified() ||
+			(indexed_file.crc32c != 0 && indexed_file.crc32c == i->crc32c()))
 		{
-			i->duplicates(indexed_file.duplicates);
-
-			if (indexed_file.file_modified == i->file_modified() ||
-				(indexed_file.crc32c != 0 && indexed_file.crc32c == i->crc32c()))
-			{
-				if (item_presence[i] != item_presence::newer_in)
-				{
-					item_presence[i] = item_presence::similar_in;
-				}
-			}
-			else if (indexed_file.file_modified < i->file_modified())
+			if (item_presence[i] != item_presence::newer_in)
 			{
-				if (item_presence[i] == item_presence::unknown)
-				{
-					item_presence[i] = item_presence::older_in;
-				}
+				item_presence[i] = item_presence::similar_in;
 			}
-			else if (indexed_file.file_modified > i->file_modified())
+		}
+		else if (indexed_file.file_modified < i->file_modified())
+		{
+			if (item_presence[i] == item_presence::unknown)
 			{
-				item_presence[i] = item_presence::newer_in;
+				item_presence[i] = item_presence::older_in;
 			}
 		}
-
-		++lb;
+		else if (indexed_file.file_modified > i->file_modified())
+		{
+			item_presence[i] = item_presence::newer_in;
+		}
 	}
 }
 
@@ -2393,8 +4495,8 @@ void index_state::update_presence(const df::item_set& items)
 			}
 		}
 
-		std::vector<std::pair<uint32_t, df::item_element_ptr>> items_possible_hashes;
 		df::hash_map<df::item_element_ptr, item_presence> item_presence;
+		duplicate_keys_ptr index;
 
 		for (const auto& i : items.items())
 		{
@@ -2406,63 +4508,31 @@ void index_state::update_presence(const df::item_set& items)
 			}
 			else
 			{
-				if (i->crc32c())
-				{
-					items_possible_hashes.emplace_back(i->crc32c(), i);
-				}
+				item_presence[i] = item_presence::unknown;
 
-				const auto md = i->metadata();
+				// only items outside the collection need the signature index
+				if (!index) index = duplicate_index();
 
-				if (md)
-				{
-					const auto created_date = md->created();
+				const auto& keys = index->keys;
+				const auto& columns = *index->columns;
 
-					if (created_date.is_valid())
+				duplicate_keys_for_item(i, [&](const uint64_t key)
 					{
-						items_possible_hashes.emplace_back(x64to32(created_date.to_int64()), i);
-					}
-				}
-				else
-				{
-					auto d = i->file_created().system_to_local();
-					items_possible_hashes.emplace_back(x64to32(d.to_int64()), i);
-				}
-
-				items_possible_hashes.emplace_back(crypto::fnv1a_i(i->path().name()), i);
-				item_presence[i] = item_presence::unknown;
-			}
-		}
-
-		if (!items_possible_hashes.empty())
-		{
-			std::ranges::sort(items_possible_hashes, [](auto&& left, auto&& right)
-				{
-					return left.first < right.first;
-				});
-			const auto folders = _items.all_folders();
+						auto found = std::ranges::lower_bound(keys, key, {}, [](const auto& k) { return k.first; });
 
-			for (const auto& ifn : folders)
-			{
-				if (ifn.second->is_in_collection)
-				{
-					for (const auto& file : ifn.second->files)
-					{
-						if (file.crc32c)
+						while (found != keys.end() && found->first == key)
 						{
-							items_possible_hashes_contains(item_presence, items_possible_hashes, file, file.crc32c);
-						}
+							// browsed folders outside the collection are in the snapshot too
+							const auto f = columns.folder_of_row(found->second);
 
-						const auto created_date = file.created();
+							if (columns.folders[f]->is_in_collection)
+							{
+								update_item_presence(item_presence, i, *columns.items[found->second]);
+							}
 
-						if (created_date.is_valid())
-						{
-							items_possible_hashes_contains(item_presence, items_possible_hashes, file,
-								x64to32(created_date.to_int64()));
+							++found;
 						}
-
-						items_possible_hashes_contains(item_presence, items_possible_hashes, file, crypto::fnv1a_i(file.name));
-					}
-				}
+					});
 			}
 		}
 
@@ -2506,6 +4576,7 @@ void index_state::scan_items(const df::item_set& items_to_scan,
 		}
 
 		const auto now = platform::now();
+		std::vector<std::pair<df::index_folder_item_ptr, df::item_element_ptr>> items_to_scan_in_folders;
 
 		for (const auto& ff : items_by_folder)
 		{
@@ -2515,14 +4586,26 @@ void index_state::scan_items(const df::item_set& items_to_scan,
 
 			for (const auto& i : ff.second)
 			{
-				if (token.is_cancelled()) break;
+				items_to_scan_in_folders.emplace_back(node.folder, i);
+			}
+		}
 
-				if (!only_if_needed || i->should_load_thumbnail())
+		// decoding and thumbnailing is cpu bound so spread items over all cores
+		platform::default_work_pool().parallel_for(items_to_scan_in_folders.size(), 1,
+			[&](size_t, const size_t begin, const size_t end)
+			{
+				for (auto n = begin; n < end; ++n)
 				{
-					scan_item(node.folder, i->path(), load_thumbs, scan_if_offline, i, i->file_type());
+					if (token.is_cancelled()) break;
+
+					const auto& [folder, i] = items_to_scan_in_folders[n];
+
+					if (!only_if_needed || i->should_load_thumbnail())
+					{
+						scan_item(folder, i->path(), load_thumbs, scan_if_offline, i, i->file_type());
+					}
 				}
-			}
-		}
+			}, 0, token);
 
 		for (const auto& i : items_to_scan.items())
 		{
@@ -2558,7 +4641,7 @@ void index_state::scan_folder(const df::folder_path folder_path, const bool mark
 {
 	df::scope_locked_inc l(scanning_items);
 	const auto node = validate_folder(folder_path, true, timestamp);
-	node.folder->is_in_collection = mark_is_indexed;
+	update_collection_membership(node.folder, mark_is_indexed);
 	scan_folder(folder_path, node.folder);
 
 	if (node.folder->is_in_collection && node.was_updated)
@@ -2630,11 +4713,48 @@ void index_state::queue_update_predictions()
 		});
 }
 
+void index_state::queue_fingerprint_files(df::cancel_token token)
+{
+	_async.queue_async(async_queue::fingerprint, [this, token]()
+		{
+			fingerprint_files(token);
+		});
+}
+
+void index_state::queue_fingerprint_chunk()
+{
+	_async.queue_async(async_queue::fingerprint, [this]()
+		{
+			fingerprint_chunk();
+		});
+}
+
+// Called on every app tick; queues the next chunk of a waiting fingerprint pass.
+void index_state::resume_fingerprint_files()
+{
+	auto due_ms = _fingerprint_resume_ms.load();
+
+	if (due_ms != 0 && due_ms <= df::now_ms() && thumbnailing_items == 0 &&
+		_fingerprint_resume_ms.compare_exchange_strong(due_ms, 0))
+	{
+		queue_fingerprint_chunk();
+	}
+}
+
 void index_state::queue_update_summary()
 {
 	_async.queue_async(async_queue::index_summary_single, [this]()
 		{
-			update_summary();
+			bool is_stale;
+
+			{
+				platform::shared_lock lock(_summary_rw);
+				is_stale = _summary_stale;
+			}
+
+			// item changes are applied as deltas, only rebuild when they could not be
+			if (is_stale) update_summary();
+			update_auto_complete();
 			_async.invalidate_view(view_invalid::sidebar);
 			std::this_thread::sleep_for(std::chrono::milliseconds(333));
 		});
@@ -2715,13 +4835,25 @@ void index_state::merge_folder(const df::folder_path folder_path, const db_items
 			else
 			{
 				// merge: in both
+				const auto previous = old_first->metadata.load();
 				old_first->metadata = file_first->metadata;
 				old_first->metadata_scanned = file_first->metadata_scanned;
 				old_first->crc32c = file_first->crc32c;
+				old_first->phash = file_first->phash;
+				_terms.update(folder_path.combine_file(old_first->name), previous.get(), *old_first);
+
+				if (folder_node->is_in_collection)
+				{
+					const auto current = old_first->metadata.load();
+					update_summary(*old_first, previous.get(), current.get());
+				}
+
 				++file_first;
 				++old_first;
 			}
 		}
+
+		invalidate_columns(folder_path);
 	}
 	else
 	{
@@ -2740,6 +4872,7 @@ void index_state::merge_folder(const df::folder_path folder_path, const db_items
 			file_node.ft = mt;
 			file_node.metadata = metadata;
 			file_node.crc32c = i->crc32c;
+			file_node.phash = i->phash;
 			file_node.metadata_scanned = i->metadata_scanned;
 
 			file_node.calc_bloom_bits();
@@ -2748,6 +4881,8 @@ void index_state::merge_folder(const df::folder_path folder_path, const db_items
 
 		df::assert_true(std::is_sorted(files.begin(), files.end()));
 
+		_terms.add(folder_path, files);
+
 		folder_node = std::make_shared<df::index_folder_item>(files);
 		folder_node->name = folder_path.name();
 		folder_node->reset_bloom_bits();
@@ -2811,31 +4946,20 @@ std::vector<index_state::auto_complete_word> index_state::auto_complete_words(
 {
 	df::assert_true(!ui::is_ui_thread());
 
-	std::vector<auto_complete_word> result;
-	platform::shared_lock lock(_summary_rw);
+	auto_complete_index_ptr index;
 
-	if (query.size() > 2)
 	{
-		for (const auto& word : _summary._distinct_words)
-		{
-			const auto found = str::ifind2(word.first, query, 0);
-
-			if (found.found)
-			{
-				result.emplace_back(std::u8string(word.first), found.parts);
-				if (result.size() > max_results) break;
-			}
-		}
+		platform::shared_lock lock(_summary_rw);
+		index = _auto_complete_words;
 	}
-	else
+
+	std::vector<auto_complete_word> result;
+
+	if (index)
 	{
-		for (const auto& word : _summary._distinct_words)
+		for (auto& m : index->find(query, max_results))
 		{
-			if (str::starts(word.first, query))
-			{
-				result.emplace_back(std::u8string(word.first), std::vector<str::part_t>{{0, query.size()}});
-				if (result.size() > max_results) break;
-			}
+			result.emplace_back(std::u8string(index->entries[m.entry].text), std::move(m.highlights));
 		}
 	}
 
@@ -2847,49 +4971,20 @@ std::vector<index_state::auto_complete_folder> index_state::auto_complete_folder
 {
 	df::assert_true(!ui::is_ui_thread());
 
-	std::vector<auto_complete_folder> result;
+	auto_complete_index_ptr index;
 
-	for (const auto& folders : {
-			 _summary._distinct_prime_folders, _summary._distinct_folders, _summary._distinct_other_folders
-		})
 	{
-		if (query.size() > 2)
-		{
-			for (const auto& folder : folders)
-			{
-				auto name_pos = folder.is_root() ? 0u : (folder.find_last_slash() + 1);
-				if (name_pos == std::u8string_view::npos) name_pos = 0;
-				auto found = str::ifind2(folder.text().substr(name_pos), query, name_pos);
+		platform::shared_lock lock(_summary_rw);
+		index = _auto_complete_folders;
+	}
 
-				if (!found.found && name_pos != 0)
-				{
-					found = ifind2(folder.text(), query, 0);
-				}
+	std::vector<auto_complete_folder> result;
 
-				if (found.found)
-				{
-					result.emplace_back(folder, found.parts);
-					if (result.size() > max_results) break;
-				}
-			}
-		}
-		else
+	if (index)
+	{
+		for (auto& m : index->find(query, max_results))
 		{
-			for (const auto& folder : folders)
-			{
-				const auto name_pos = folder.is_root() ? 0u : (folder.find_last_slash() + 1);
-
-				if (name_pos != std::u8string_view::npos && str::starts(folder.text().substr(name_pos), query))
-				{
-					result.emplace_back(folder, std::vector<str::part_t>{{name_pos, query.size()}});
-					if (result.size() > max_results) break;
-				}
-				else if (starts(folder.text(), query))
-				{
-					result.emplace_back(folder, std::vector<str::part_t>{{0, query.size()}});
-					if (result.size() > max_results) break;
-				}
-			}
+			result.emplace_back(df::folder_path(index->entries[m.entry].text), std::move(m.highlights));
 		}
 	}
 
@@ -28,6 +28,7 @@ struct item_db_write
 	std::optional<df::date_t> thumb_scanned;
 	std::optional<df::date_t> metadata_scanned;
 	std::optional<uint32_t> crc32c;
+	std::optional<uint64_t> phash;
 
 	item_db_write() noexcept = default;
 	item_db_write(const item_db_write&) = delete;
@@ -42,6 +43,7 @@ struct db_item_t
 	df::date_t metadata_scanned = {};
 	prop::item_metadata_ptr metadata = {};
 	uint32_t crc32c = 0;
+	uint64_t phash = 0;
 
 	db_item_t() noexcept = default;
 	db_item_t(const db_item_t&) = delete;
@@ -102,26 +104,50 @@ struct peq
 	}
 };
 
+// One stage of the scan pipeline. busy is time spent on items, starved is
+// time waiting for input and blocked time waiting for room downstream. The
+// stage with the most busy time per thread is the one bounding a scan.
+struct scan_stage_statistic
+{
+	std::u8string_view name;
+	int threads = 0;
+	int items = 0;
+	int busy_ms = 0;
+	int starved_ms = 0;
+	int blocked_ms = 0;
+};
+
+std::u8string format_scan_stage(const scan_stage_statistic& s);
+
 struct index_statistic
 {
 	int index_folder_count = 0;
 	int index_item_remaining = 0;
 	int items_saved = 0;
 	int thumbs_saved = 0;
+	int writes_received = 0;
+	int write_statements = 0;
 
 	int media_item_count = 0;
 	int index_item_count = 0;
 	int indexed_dup_folder_count = 0;
 	int indexed_max_compare_count = 0;
 	int indexed_crc_count = 0;
+	int indexed_dup_key_count = 0;
+	int fingerprint_remaining = 0;
+	int fingerprint_hashed = 0;
+	int predictions_changed_folders = 0;
 
 	int index_load_ms = 0;
 	int predictions_ms = 0;
 	int count_matches_ms = 0;
+	int columns_ms = 0;
 
 	int scan_items_ms = 0;
 	int update_presence_ms = 0;
 
+	std::array<scan_stage_statistic, 5> scan_stages;
+
 	df::file_size database_size;
 	df::file_path database_path;
 };
@@ -139,8 +165,15 @@ class index_items
 private:
 	mutable platform::mutex _rw;
 	_Guarded_by_(_rw) items_by_folder_t _index;
+	_Guarded_by_(_rw) uint32_t _version = 0;
 
 public:
+	uint32_t version() const
+	{
+		platform::shared_lock lock(_rw);
+		return _version;
+	}
+
 	df::index_folder_item_ptr find(const df::folder_path folder) const
 	{
 		platform::shared_lock lock(_rw);
@@ -153,6 +186,7 @@ public:
 		platform::exclusive_lock lock(_rw);
 
 		_index[folder_path] = i;
+		_version += 1;
 
 		// update parent to point to this
 		if (!folder_path.is_root())
@@ -191,6 +225,8 @@ public:
 				_index.erase(found_in_index);
 			}
 		}
+
+		_version += 1;
 	}
 
 	index_folders_t all_folders() const
@@ -215,6 +251,7 @@ public:
 			platform::exclusive_lock lock(_rw);
 			auto result = std::make_shared<df::index_folder_item>();
 			_index[folder_path] = result;
+			_version += 1;
 			return result;
 		}
 	}
@@ -223,9 +260,105 @@ public:
 	{
 		platform::exclusive_lock lock(_rw);
 		_index.clear();
+		_version += 1;
+	}
+};
+
+struct index_term_candidates
+{
+	bool is_constrained = false;
+	df::unique_folders folders;
+	df::unique_paths files;
+
+	bool can_match(const df::folder_path folder) const
+	{
+		return !is_constrained || folders.contains(folder);
+	}
+
+	bool can_match(const df::file_path path) const
+	{
+		return !is_constrained || files.contains(path);
 	}
 };
 
+enum class index_value_kind : uint32_t
+{
+	size,
+	dimensions,
+	pixels,
+	exposure,
+	f_number,
+	focal_length,
+	duration,
+	iso,
+	audio_channels,
+	audio_sample_rate,
+	audio_sample_type,
+	year,
+};
+
+struct index_value_key
+{
+	index_value_kind kind = index_value_kind::size;
+	uint64_t val = 0;
+	uintptr_t extra = 0;
+
+	bool operator==(const index_value_key& other) const
+	{
+		return kind == other.kind && val == other.val && extra == other.extra;
+	}
+};
+
+struct index_value_hash
+{
+	size_t operator()(const index_value_key& k) const
+	{
+		return crypto::hash_gen().append(static_cast<uint32_t>(k.kind)).append(k.val).append(static_cast<uint64_t>(k.extra)).result();
+	}
+};
+
+// Texts by the folded code point trigrams they contain, each list sorted by text address
+using index_trigram_texts = df::dense_hash_map<uint64_t, std::vector<std::u8string_view>>;
+
+// Inverted index of the words in file names and text metadata.
+// Text and string property terms resolve to a candidate set before the matcher runs.
+// Postings are a superset: stale entries are only removed when the previous
+// metadata is known and are otherwise rejected by the matcher. Ids of erased
+// paths are reused, so a stale entry can also name an unrelated path.
+class index_terms
+{
+private:
+	using posting_t = std::vector<uint32_t>;
+
+	mutable platform::mutex _rw;
+	_Guarded_by_(_rw) df::dense_hash_map<std::u8string_view, posting_t, df::ihash, df::ieq> _words;
+	_Guarded_by_(_rw) index_trigram_texts _word_trigrams;
+	_Guarded_by_(_rw) df::dense_hash_map<df::file_path, uint32_t, df::ihash, df::ieq> _ids;
+	_Guarded_by_(_rw) std::vector<df::file_path> _paths;
+	_Guarded_by_(_rw) std::vector<uint32_t> _free_ids;
+	_Guarded_by_(_rw) df::dense_hash_map<index_value_key, uint64_t, index_value_hash> _values;
+	_Guarded_by_(_rw) df::dense_unique_strings _value_texts;
+	_Guarded_by_(_rw) index_trigram_texts _value_trigrams;
+
+	uint32_t id_of(df::file_path path);
+	void release_id(uint32_t id);
+	void add_words(uint32_t id, const df::index_file_item& file);
+	void remove_words(uint32_t id, str::cached name, const prop::item_metadata* md);
+	void add_values(const df::index_file_item& file);
+	bool match_words(std::u8string_view run, size_t limit, posting_t& result) const;
+	bool match_values(const df::search_term& term, std::u8string_view run) const;
+
+public:
+	void add(df::file_path path, const df::index_file_item& file);
+	void add(df::folder_path folder, const df::index_item_infos& files);
+	void update(df::file_path path, const prop::item_metadata* previous, const df::index_file_item& file);
+	void erase(df::file_path path, const df::index_file_item& file);
+	void erase(df::folder_path folder, const df::index_item_infos& files);
+	void clear();
+
+	index_term_candidates candidates(const df::search_t& search) const;
+};
+
 __forceinline bool is_dup_match(const df::index_file_item* file, const df::index_file_item* other_file)
 {
 	if (file->crc32c != 0 && file->crc32c == other_file->crc32c)
@@ -327,6 +460,13 @@ struct index_histograms
 	df::hash_map<uint32_t, location_group> _location_groups;
 
 	void record(const location_cache& locations, const df::index_file_item& file);
+	void record(const country_loc& country, const df::index_columns& columns, size_t row);
+	void record(const location_cache& locations, const df::index_file_item& file, const prop::item_metadata* md,
+		int delta);
+
+private:
+	void record(df::file_type_ref ft, df::file_size size, df::date_t created, df::date_t modified,
+		gps_coordinate coord, const country_loc& country, int delta = 1);
 };
 
 using strings_by_prop = df::hash_map<prop::key_ref, df::dense_unique_strings>;
@@ -354,14 +494,97 @@ struct index_summary
 	prop_num_summary _distinct_ratings;
 
 	index_histograms _histograms;
+
+	void record(const prop::item_metadata& md, df::file_type_ref ft, df::file_size size, int delta);
+	void record_rating(int rating, df::file_type_ref ft, df::file_size size, int delta);
+};
+
+// Signature index of the collection: one key per duplicate rule (crc32c,
+// name and created date, name and size) for every row of a columns snapshot,
+// sorted by key. It is shared by update_predictions and update_presence and
+// refreshed from the previous snapshot, so only folders changed by
+// merge_folder or scan_item since need new keys.
+struct duplicate_keys
+{
+	df::index_columns_ptr columns;
+	std::vector<std::pair<uint64_t, uint32_t>> keys;
+	std::vector<bool> in_collection; // per folder of columns, only member folders have keys
+	int changed_folders = 0;
+};
+
+using duplicate_keys_ptr = std::shared_ptr<const duplicate_keys>;
+
+// Perceptual hashes this close are treated as the same picture
+constexpr int similar_phash_distance = 10;
+
+// Multi-index hash over the perceptual hashes of a columns snapshot. Hashes
+// are split into four 16 bit bands. Two hashes within distance d share at
+// least one band within d / 4 bits, so a query only probes the buckets near
+// each band of the query hash and checks the full distance of what it finds.
+class phash_index
+{
+public:
+	static constexpr int band_count = 4;
+	static constexpr int band_bits = 16;
+
+	df::index_columns_ptr columns;
+
+	void build(const df::index_columns_ptr& c);
+	std::vector<uint32_t> find(uint64_t hash, int max_distance) const;
+
+private:
+	std::array<std::vector<uint32_t>, band_count> _offsets;
+	std::array<std::vector<uint32_t>, band_count> _rows;
+};
+
+using phash_index_ptr = std::shared_ptr<const phash_index>;
+
+// Auto-complete index over the distinct words or folders of the summary.
+// Entries are ordered by rank so posting lists and scans yield the best
+// matches first. Queries longer than two bytes use trigram postings to find
+// candidates for ifind2, shorter ones a sorted array of the first two
+// characters. Candidates are verified with the same matching as a full scan.
+class auto_complete_index
+{
+public:
+	struct entry
+	{
+		std::u8string_view text;
+		uint32_t rank = 0;
+		uint32_t name_pos = 0;
+	};
+
+	struct match
+	{
+		uint32_t entry = 0;
+		std::vector<str::part_t> highlights;
+	};
+
+	std::vector<entry> entries;
+	uint32_t changes = 0;
+
+	void build(std::vector<entry> e);
+	std::vector<match> find(std::u8string_view query, size_t max_results) const;
+
+private:
+	std::vector<uint64_t> _trigrams;
+	std::vector<uint32_t> _offsets;
+	std::vector<uint32_t> _postings;
+	std::vector<std::pair<uint64_t, uint32_t>> _prefixes;
+
+	bool match_entry(uint32_t e, std::u8string_view query, std::vector<match>& results) const;
 };
 
+using auto_complete_index_ptr = std::shared_ptr<const auto_complete_index>;
+
 struct folder_scan_item
 {
 	df::folder_path folder;
 	df::index_file_item item;
 };
 
+struct index_scan_job;
+
 class index_state : public df::no_copy
 {
 private:
@@ -371,8 +594,71 @@ private:
 
 	index_items _items;
 	_Guarded_by_(_summary_rw) index_summary _summary;
+	_Guarded_by_(_summary_rw) bool _summary_stale = true;
+	_Guarded_by_(_summary_rw) uint32_t _summary_changes = 0;
+	_Guarded_by_(_summary_rw) auto_complete_index_ptr _auto_complete_words;
+	_Guarded_by_(_summary_rw) auto_complete_index_ptr _auto_complete_folders;
+	_Guarded_by_(_summary_rw) uint32_t _auto_complete_changes = 0;
+	index_terms _terms;
 	item_writes_t _db_writes;
 
+	// Snapshot handed out by columns(). Row pointers stay valid while a caller
+	// holds the snapshot because it also holds each folder node, and a node's
+	// files never move. The copied column values do go stale: code that
+	// changes a file node in place must call invalidate_columns(folder), and
+	// replacing a folder node bumps _items.version().
+	platform::mutex _columns_rw;
+	_Guarded_by_(_columns_rw) df::index_columns_ptr _columns;
+	_Guarded_by_(_columns_rw) df::unique_folders _columns_dirty;
+	_Guarded_by_(_columns_rw) uint32_t _columns_version = 0;
+	_Guarded_by_(_columns_rw) bool _columns_all_dirty = true;
+
+	platform::mutex _duplicate_keys_rw;
+	_Guarded_by_(_duplicate_keys_rw) duplicate_keys_ptr _duplicate_keys;
+
+	struct similar_result
+	{
+		uint64_t hash = 0;
+		int max_distance = 0;
+		df::unique_paths items;
+	};
+
+	// Files still to hash in the current fingerprint pass. Chunks run one at a
+	// time on the fingerprint lane; a chunk that has to wait for the throttle or
+	// for thumbnail loads sets _fingerprint_resume_ms and resume_fingerprint_files
+	// queues the next one once it is due.
+	struct fingerprint_pass
+	{
+		struct file
+		{
+			df::file_path path;
+			uint64_t size = 0;
+			bool has_crc = false;
+		};
+
+		explicit fingerprint_pass(df::cancel_token t) : token(std::move(t))
+		{
+		}
+
+		std::vector<file> files;
+		size_t next = 0;
+		uint64_t bytes_read = 0;
+		int64_t start_ms = 0;
+		int hashed = 0;
+		df::cancel_token token;
+	};
+
+	std::shared_ptr<fingerprint_pass> _fingerprint;
+	std::atomic<int64_t> _fingerprint_resume_ms = 0;
+
+	void fingerprint_chunk();
+	void queue_fingerprint_chunk();
+
+	platform::mutex _phash_rw;
+	_Guarded_by_(_phash_rw) phash_index_ptr _phash_index;
+	// related searches repeat for the same item, cleared with the index
+	_Guarded_by_(_phash_rw) df::hash_map<df::file_path, similar_result, df::ihash, df::ieq> _similar_cache;
+
 	bool _cache_items_loaded = false;
 	bool _folders_indexed = false;
 	const location_cache& _locations;
@@ -380,8 +666,28 @@ private:
 
 	void calc_folder_summary(const df::index_folder_info_const_ptr& folder, df::file_group_histogram& result,
 		df::cancel_token token) const;
+	void update_summary(const df::index_file_item& file, const prop::item_metadata* previous,
+		const prop::item_metadata* current);
+	void update_summary(const df::index_item_infos& previous, const df::index_item_infos& current);
+	void update_collection_membership(const df::index_folder_item_ptr& folder, bool is_in_collection);
+	void invalidate_summary();
+	void update_auto_complete();
 	bool is_collection_search(const df::search_t& search) const;
 
+	struct scan_request
+	{
+		df::index_folder_item_ptr folder;
+		df::file_path path;
+		df::item_element_ptr item;
+		file_type_ref ft = nullptr;
+	};
+
+	bool scan_item_read(index_scan_job& job);
+	void scan_item_encode(index_scan_job& job);
+	void scan_item_apply(index_scan_job& job);
+	void scan_pipeline(const std::vector<scan_request>& requests, bool load_thumb, bool scan_if_offline,
+		df::cancel_token token);
+
 public:
 	explicit index_state(async_strategy& as, const location_cache& locations);
 
@@ -398,6 +704,12 @@ public:
 	std::atomic_int indexing = 0;
 	std::atomic_int searching = 0;
 
+	// caps the work pool workers used by collection queries, 0 uses all of them
+	size_t query_workers = 0;
+
+	// text queries scan every item when off, used to check candidate narrowing
+	bool use_term_candidates = true;
+
 	index_statistic stats;
 
 	void cache_load_complete()
@@ -409,11 +721,25 @@ public:
 
 	void save_media_position(df::file_path id, double media_position);
 	void save_crc(df::file_path id, uint32_t crc);
+	void update_crc(df::file_path id, uint32_t crc);
 	void save_location(df::file_path id, const location_t& loc);
 	void save_thumbnail(df::file_path id, const ui::const_image_ptr& thumbnail_image, const ui::const_image_ptr& cover_art, df::date_t scan_timestamp);
 
 	df::index_file_item find_item(df::file_path id) const;
 
+	index_term_candidates term_candidates(const df::search_t& search) const
+	{
+		return _terms.candidates(search);
+	}
+
+	df::index_columns_ptr columns();
+	void invalidate_columns(df::folder_path folder);
+	void invalidate_columns();
+
+	phash_index_ptr similar_index();
+	duplicate_keys_ptr duplicate_index();
+	df::unique_paths similar_items(df::file_path id, int max_distance = similar_phash_distance);
+
 	df::file_group_histogram calc_folder_summary(df::folder_path path, df::cancel_token token) const;
 	df::file_group_histogram count_matches(const df::search_t& a, df::cancel_token token);
 
@@ -463,6 +789,7 @@ public:
 	void index_folders(df::cancel_token token);
 	void index_roots(df::index_roots roots);
 	void scan_uncached(df::cancel_token token);
+	void fingerprint_files(df::cancel_token token);
 	std::vector<folder_scan_item> scan_items(const df::index_roots& roots, bool recursive, bool scan_if_offline,
 		df::cancel_token token);
 	void scan_items(const df::item_set& items, bool load_thumbs, bool refresh_from_file_system, bool only_if_needed,
@@ -479,6 +806,8 @@ public:
 	void queue_update_presence(df::item_set items);
 	void queue_update_predictions();
 	void queue_update_summary();
+	void queue_fingerprint_files(df::cancel_token token);
+	void resume_fingerprint_files();
 
 	std::vector<df::file_path> all_indexed_items() const
 	{
@@ -367,98 +367,161 @@ public:
 	}
 };
 
-static void sort_items(df::item_elements& items, const group_by group_mode, const sort_by sort_order,
-	const bool group_by_dups)
+// Sorts runs on the shared work pool and then merges neighbouring runs
+// pairwise. Small ranges are sorted in place on the calling thread.
+template <typename T, typename L>
+static void parallel_sort(std::vector<T>& v, const L& less)
 {
-	constexpr auto size_sorter = [](const df::item_element_ptr& l, const df::item_element_ptr& r) -> bool
-		{
-			const auto ll = l->file_size();
-			const auto rr = r->file_size();
-			return (ll == rr) ? icmp(l->name(), r->name()) < 0 : ll > rr;
-		};
+	constexpr size_t min_run = 16384;
+	auto& pool = platform::default_work_pool();
+	const auto runs = std::min(pool.worker_count(), v.size() / min_run);
 
-	constexpr auto modified_sorter = [](const df::item_element_ptr& l, const df::item_element_ptr& r)
-		{
-			if (l->file_modified() == r->file_modified()) return icmp(l->name(), r->name()) < 0;
-			return l->file_modified() > r->file_modified();
-		};
-
-	constexpr auto created_sorter = [](const df::item_element_ptr& l, const df::item_element_ptr& r)
-		{
-			if (l->media_created() == r->media_created()) return icmp(l->name(), r->name()) < 0;
-			return l->media_created() > r->media_created();
-		};
-
-	constexpr auto pixel_sorter = [](const df::item_element_ptr& l, const df::item_element_ptr& r) -> bool
-		{
-			const auto lmd = l->metadata();
-			const auto rmd = r->metadata();
-			const auto ll = lmd ? ui::calc_mega_pixels(lmd->width, lmd->height) : 0;
-			const auto rr = rmd ? ui::calc_mega_pixels(rmd->width, rmd->height) : 0;
-			return (ll == rr) ? icmp(l->name(), r->name()) < 0 : ll > rr;
-		};
+	if (runs < 2)
+	{
+		std::sort(v.begin(), v.end(), less);
+		return;
+	}
 
-	constexpr auto group_sorter = [](const df::item_element_ptr& l, const df::item_element_ptr& r)
-		{
-			const auto ll = l->duplicates().group;
-			const auto rr = r->duplicates().group;
-			if (ll != rr) return ll < rr;
-			return icmp(l->name(), r->name()) < 0;
-		};
+	std::vector<size_t> bounds(runs + 1);
+	for (size_t r = 0; r <= runs; ++r) bounds[r] = v.size() * r / runs;
 
-	constexpr auto name_sorter = [](const df::item_element_ptr& l, const df::item_element_ptr& r)
+	pool.parallel_for(runs, 1, [&v, &bounds, &less](size_t, const size_t begin, const size_t end)
 		{
-			return icmp(l->name(), r->name()) < 0;
-		};
+			for (auto r = begin; r < end; ++r)
+			{
+				std::sort(v.begin() + bounds[r], v.begin() + bounds[r + 1], less);
+			}
+		});
 
-	if (group_mode == group_by::shuffle)
+	for (size_t width = 1; width < runs; width *= 2)
 	{
-		std::ranges::sort(items, [](const df::item_element_ptr& l, const df::item_element_ptr& r)
+		const auto pairs = (runs + (width * 2) - 1) / (width * 2);
+
+		pool.parallel_for(pairs, 1, [&v, &bounds, &less, runs, width](size_t, const size_t begin, const size_t end)
 			{
-				return l->random() < r->random();
+				for (auto p = begin; p < end; ++p)
+				{
+					const auto first = p * width * 2;
+					const auto middle = std::min(first + width, runs);
+					const auto last = std::min(first + (width * 2), runs);
+
+					if (middle < last)
+					{
+						std::inplace_merge(v.begin() + bounds[first], v.begin() + bounds[middle], v.begin() + bounds[last], less);
+					}
+				}
 			});
 	}
-	else if (sort_order == sort_by::size)
-	{
-		std::ranges::sort(items, size_sorter);
-	}
-	else if (sort_order == sort_by::date_modified)
-	{
-		std::ranges::sort(items, modified_sorter);
-	}
-	else if (sort_order == sort_by::name)
-	{
-		std::ranges::sort(items, name_sorter);
-	}
-	else if (group_mode == group_by::size)
-	{
-		std::ranges::sort(items, size_sorter);
-	}
-	else if (group_mode == group_by::date_modified)
+}
+
+// Sort keys are read from each item once. order holds the primary key encoded
+// so that ascending order is the wanted order, the name breaks ties.
+struct item_sort_key
+{
+	uint64_t order = 0;
+	uint64_t name_prefix = 0;
+	str::cached name;
+	uint32_t index = 0;
+};
+
+static bool operator<(const item_sort_key& l, const item_sort_key& r)
+{
+	if (l.order != r.order) return l.order < r.order;
+
+	if (l.name.storage && r.name.storage)
 	{
-		std::ranges::sort(items, modified_sorter);
+		const auto diff = str::icmp_folded_prefix(l.name_prefix, r.name_prefix);
+		if (diff != 0) return diff < 0;
 	}
-	else if (group_mode == group_by::date_created)
+
+	return icmp(l.name, r.name) < 0;
+}
+
+enum class item_sort_order
+{
+	name,
+	size,
+	modified,
+	created,
+	pixels,
+	dup_group,
+	shuffle
+};
+
+static item_sort_order calc_sort_order(const group_by group_mode, const sort_by sort_order, const bool group_by_dups)
+{
+	if (group_mode == group_by::shuffle) return item_sort_order::shuffle;
+	if (sort_order == sort_by::size) return item_sort_order::size;
+	if (sort_order == sort_by::date_modified) return item_sort_order::modified;
+	if (sort_order == sort_by::name) return item_sort_order::name;
+	if (group_mode == group_by::size) return item_sort_order::size;
+	if (group_mode == group_by::date_modified) return item_sort_order::modified;
+	if (group_mode == group_by::date_created) return item_sort_order::created;
+	if (group_mode == group_by::resolution) return item_sort_order::pixels;
+	if (group_mode == group_by::folder) return item_sort_order::name;
+	if (group_by_dups) return item_sort_order::dup_group;
+	return item_sort_order::name;
+}
+
+static uint64_t calc_sort_order_key(const item_sort_order order, const df::item_element_ptr& i)
+{
+	// Sizes, dates and pixels sort largest first
+	switch (order)
 	{
-		std::ranges::sort(items, created_sorter);
-	}
-	else if (group_mode == group_by::resolution)
+	case item_sort_order::size:
+		return ~i->file_size().to_int64();
+
+	case item_sort_order::modified:
+		return ~i->file_modified().to_int64();
+
+	case item_sort_order::created:
+		return ~i->media_created().to_int64();
+
+	case item_sort_order::pixels:
 	{
-		std::ranges::sort(items, pixel_sorter);
+		const auto md = i->metadata();
+		return ~(md ? static_cast<uint64_t>(md->width) * md->height : 0ull);
 	}
-	else if (group_mode == group_by::folder)
-	{
-		std::ranges::sort(items, name_sorter);
+
+	case item_sort_order::dup_group:
+		return i->duplicates().group;
+
+	case item_sort_order::shuffle:
+		return static_cast<uint64_t>(static_cast<int64_t>(i->random())) ^ (1ull << 63);
+
+	default:
+		return 0;
 	}
-	else if (group_by_dups)
+}
+
+static void sort_items(df::item_elements& items, const group_by group_mode, const sort_by sort_order,
+	const bool group_by_dups)
+{
+	const auto order = calc_sort_order(group_mode, sort_order, group_by_dups);
+	std::vector<item_sort_key> keys(items.size());
+
+	for (auto n = 0u; n < items.size(); ++n)
 	{
-		std::ranges::sort(items, group_sorter);
+		const auto& i = items[n];
+		auto& k = keys[n];
+		k.order = calc_sort_order_key(order, i);
+		k.name = i->name();
+		k.name_prefix = k.name.folded_prefix();
+		k.index = n;
 	}
-	else
+
+	parallel_sort(keys, [](const item_sort_key& l, const item_sort_key& r) { return l < r; });
+
+	df::item_elements sorted;
+	sorted.reserve(items.size());
+
+	for (const auto& k : keys)
 	{
-		std::ranges::sort(items, name_sorter);
+		sorted.emplace_back(std::move(items[k.index]));
 	}
 
+	items = std::move(sorted);
+
 	if (!setting.sort_dates_descending && (group_mode == group_by::date_created || group_mode ==
 		group_by::date_modified))
 	{
@@ -1043,6 +1106,75 @@ void df::item_group::update_scroll_info(const group_by order)
 	}
 }
 
+static df::group_key calc_group_key(const group_by group_order, const df::item_element_ptr& i)
+{
+	if (i->is_folder())
+	{
+		switch (group_order)
+		{
+		case group_by::size:
+			return size_key(i);
+
+		case group_by::folder:
+			return folder_key(i);
+
+		case group_by::date_created:
+			return date_key(prop::created_utc, i->media_created(), i);
+
+		case group_by::date_modified:
+			return date_key(prop::modified, i->file_modified().system_to_local(), i);
+
+		case group_by::shuffle:
+			return shuffle_index_key(i);
+
+		default:
+			return media_type_index(i);
+		}
+	}
+
+	switch (group_order)
+	{
+	case group_by::size:
+		return size_key(i);
+
+	case group_by::extension:
+		return extension_key(i);
+
+	case group_by::folder:
+		return folder_key(i);
+
+	case group_by::location:
+		return location_key(i);
+
+	case group_by::rating_label:
+		return rating_key(i);
+
+	case group_by::date_created:
+		return date_key(prop::created_utc, i->media_created(), i);
+
+	case group_by::date_modified:
+		return date_key(prop::modified, i->file_modified().system_to_local(), i);
+
+	case group_by::resolution:
+		return resolution_key(i);
+
+	case group_by::camera:
+		return camera_key(i);
+
+	case group_by::album_show:
+		return album_show_key(i);
+
+	case group_by::shuffle:
+		return shuffle_index_key(i);
+
+	case group_by::presence:
+		return presence_key(i->presence());
+
+	default:
+		return media_type_index(i);
+	}
+}
+
 void view_state::update_item_groups()
 {
 	//df::assert_true(ui::is_ui_thread());
@@ -1053,9 +1185,16 @@ void view_state::update_item_groups()
 		existing_groups[g->_key] = g;
 	}
 
+	struct keyed_item
+	{
+		df::group_key key;
+		df::item_element_ptr item;
+	};
+
 	df::item_set new_display_items;
 	const auto is_duplicates = _search.is_duplicates();
-	std::map<df::group_key, df::item_elements> groups;
+	std::vector<keyed_item> keyed_items;
+	keyed_items.reserve(_search_items._items.size());
 
 	for (const auto& i : _search_items._items)
 	{
@@ -1064,116 +1203,60 @@ void view_state::update_item_groups()
 		if (_filter.match(i))
 		{
 			new_display_items.add(i);
+			keyed_items.push_back({ {}, i });
+		}
+	}
 
-			if (i->is_folder())
-			{
-				switch (_group_order)
-				{
-				case group_by::size:
-					groups[size_key(i)].emplace_back(i);
-					break;
-
-				case group_by::folder:
-					groups[folder_key(i)].emplace_back(i);
-					break;
-
-				case group_by::date_created:
-					groups[date_key(prop::created_utc, i->media_created(), i)].emplace_back(i);
-					break;
-
-				case group_by::date_modified:
-					groups[date_key(prop::modified, i->file_modified().system_to_local(), i)].emplace_back(i);
-					break;
-
-				case group_by::shuffle:
-					groups[shuffle_index_key(i)].emplace_back(i);
-					break;
+	// Group keys only read the items so they are computed in parallel, then
+	// sorting makes equal keys adjacent and each run becomes one group
+	const auto group_order = _group_order;
 
-				default:
-					groups[media_type_index(i)].emplace_back(i);
-					break;
-				}
-			}
-			else
+	platform::default_work_pool().parallel_for(keyed_items.size(), 1024,
+		[&keyed_items, group_order](size_t, const size_t begin, const size_t end)
+		{
+			for (auto n = begin; n < end; ++n)
 			{
-				switch (_group_order)
-				{
-				case group_by::size:
-					groups[size_key(i)].emplace_back(i);
-					break;
-
-				case group_by::extension:
-					groups[extension_key(i)].emplace_back(i);
-					break;
-
-				case group_by::folder:
-					groups[folder_key(i)].emplace_back(i);
-					break;
-
-				case group_by::location:
-					groups[location_key(i)].emplace_back(i);
-					break;
-
-				case group_by::rating_label:
-					groups[rating_key(i)].emplace_back(i);
-					break;
-
-				case group_by::date_created:
-					groups[date_key(prop::created_utc, i->media_created(), i)].emplace_back(i);
-					break;
-
-				case group_by::date_modified:
-					groups[date_key(prop::modified, i->file_modified().system_to_local(), i)].emplace_back(i);
-					break;
+				keyed_items[n].key = calc_group_key(group_order, keyed_items[n].item);
+			}
+		});
 
-				case group_by::resolution:
-					groups[resolution_key(i)].emplace_back(i);
-					break;
+	parallel_sort(keyed_items, [](const keyed_item& l, const keyed_item& r) { return l.key < r.key; });
 
-				case group_by::camera:
-					groups[camera_key(i)].emplace_back(i);
-					break;
+	df::item_groups new_item_groups;
 
-				case group_by::album_show:
-					groups[album_show_key(i)].emplace_back(i);
-					break;
+	for (size_t run_start = 0; run_start < keyed_items.size();)
+	{
+		const auto& run_key = keyed_items[run_start].key;
+		auto run_end = run_start + 1;
 
-				case group_by::shuffle:
-					groups[shuffle_index_key(i)].emplace_back(i);
-					break;
+		while (run_end < keyed_items.size() && !(run_key < keyed_items[run_end].key))
+		{
+			run_end += 1;
+		}
 
-				case group_by::presence:
-					groups[presence_key(i->presence())].emplace_back(i);
-					break;
+		df::item_elements items;
+		items.reserve(run_end - run_start);
 
-				default:
-					groups[media_type_index(i)].emplace_back(i);
-					break;
-				}
-			}
+		for (auto n = run_start; n < run_end; ++n)
+		{
+			items.emplace_back(std::move(keyed_items[n].item));
 		}
-	}
-
-	df::item_groups new_item_groups;
-	new_item_groups.reserve(groups.size());
 
-	for (auto&& i : groups)
-	{
 		df::item_group_ptr b;
-		auto found_group = existing_groups.find(i.first);
+		auto found_group = existing_groups.find(run_key);
 
 		if (found_group != existing_groups.end())
 		{
 			b = found_group->second;
-			b->items(std::move(i.second));
+			b->items(std::move(items));
 		}
 		else
 		{
-			const auto key = i.first.type;
+			const auto key = run_key.type;
 			const auto is_detail_display = setting.detail_items & static_cast<uint32_t>(key);
 			const auto item_group_display = is_detail_display ? df::item_group_display::detail : df::item_group_display::icons;
 
-			b = std::make_shared<df::item_group>(*this, std::move(i.second), item_group_display, i.first);
+			b = std::make_shared<df::item_group>(*this, std::move(items), item_group_display, run_key);
 			b->padding(0);
 			b->margin(8, 0);
 		}
@@ -1182,9 +1265,10 @@ void view_state::update_item_groups()
 		b->sort(_group_order, _sort_order, is_duplicates);
 
 		new_item_groups.emplace_back(b);
+		run_start = run_end;
 	}
 
-	groups.clear();
+	keyed_items.clear();
 
 	if (!setting.sort_dates_descending && (_group_order == group_by::date_created || _group_order ==
 		group_by::date_modified))
@@ -1731,6 +1815,99 @@ void df::index_file_item::calc_bloom_bits() const
 	}
 }
 
+void df::index_columns::reserve(const size_t folder_count, const size_t row_count)
+{
+	folder_paths.reserve(folder_count);
+	folders.reserve(folder_count);
+	folder_offsets.reserve(folder_count + 1);
+
+	items.reserve(row_count);
+	flags.reserve(row_count);
+	ft.reserve(row_count);
+	size.reserve(row_count);
+	created.reserve(row_count);
+	media_created.reserve(row_count);
+	file_created.reserve(row_count);
+	modified.reserve(row_count);
+	crc32c.reserve(row_count);
+	phash.reserve(row_count);
+	rating.reserve(row_count);
+	bloom.reserve(row_count);
+	coordinate.reserve(row_count);
+}
+
+void df::index_columns::append(const folder_path path, const index_folder_item_ptr& folder)
+{
+	for (const auto& f : folder->files)
+	{
+		const auto md = f.metadata.load();
+		date_t d;
+		date_t md_created;
+		int16_t r = 0;
+		gps_coordinate coord;
+
+		if (md)
+		{
+			// same order as date search and histograms
+			if (md->created_exif.is_valid()) d = md->created_exif;
+			else if (md->created_utc.is_valid()) d = md->created_utc.system_to_local();
+			else if (md->created_digitized.is_valid()) d = md->created_digitized;
+
+			md_created = md->created();
+			r = md->rating;
+			coord = md->coordinate;
+		}
+
+		items.emplace_back(&f);
+		flags.emplace_back(f.flags);
+		ft.emplace_back(f.ft);
+		size.emplace_back(f.size.to_int64());
+		created.emplace_back(d);
+		media_created.emplace_back(md_created);
+		file_created.emplace_back(f.file_created);
+		modified.emplace_back(f.file_modified);
+		crc32c.emplace_back(f.crc32c);
+		phash.emplace_back(f.phash);
+		rating.emplace_back(r);
+		bloom.emplace_back(f.bloom);
+		coordinate.emplace_back(coord);
+	}
+
+	folder_paths.emplace_back(path);
+	folders.emplace_back(folder);
+	folder_offsets.emplace_back(static_cast<uint32_t>(items.size()));
+}
+
+void df::index_columns::append(const folder_path path, const index_folder_item_ptr& folder,
+	const index_columns& other, const size_t other_folder)
+{
+	const auto first = other.first_row(other_folder);
+	const auto last = other.last_row(other_folder);
+
+	auto copy = [first, last](auto& dst, const auto& src)
+		{
+			dst.insert(dst.end(), src.begin() + first, src.begin() + last);
+		};
+
+	copy(items, other.items);
+	copy(flags, other.flags);
+	copy(ft, other.ft);
+	copy(size, other.size);
+	copy(created, other.created);
+	copy(media_created, other.media_created);
+	copy(file_created, other.file_created);
+	copy(modified, other.modified);
+	copy(crc32c, other.crc32c);
+	copy(phash, other.phash);
+	copy(rating, other.rating);
+	copy(bloom, other.bloom);
+	copy(coordinate, other.coordinate);
+
+	folder_paths.emplace_back(path);
+	folders.emplace_back(folder);
+	folder_offsets.emplace_back(static_cast<uint32_t>(items.size()));
+}
+
 void df::item_element::render_bg(ui::draw_context& dc, const item_group& group, const pointi element_offset) const
 {
 	const auto& s = group._state;
@@ -2043,6 +2220,7 @@ void df::item_element::render(ui::draw_context& dc, const item_group& group, con
 	{
 		const auto thumbnail = _thumbnail;
 		const auto cover_art = _cover_art;
+		const auto thumbnail_timestamp = _thumbnail_timestamp;
 		const auto thumb_is_valid = is_valid(thumbnail) || is_valid(cover_art);
 		const auto show_text = is_hover || !thumb_is_valid || is_folder || is_focus;
 		const auto expand_text = (is_hover || is_focus) && thumb_is_valid;
@@ -2135,11 +2313,11 @@ void df::item_element::render(ui::draw_context& dc, const item_group& group, con
 			if (!_texture)
 			{
 				const auto t = dc.create_texture();
-				files ff;
-
-				const auto image = !is_valid(cover_art) || is_hover ? thumbnail : cover_art;
+				const auto use_cover_art = is_valid(cover_art) && !is_hover;
+				const auto surface = thumbnail_cache().surface(_path, thumbnail_timestamp, use_cover_art,
+					use_cover_art ? cover_art : thumbnail);
 
-				if (t && t->update(ff.image_to_surface(image)) != ui::texture_update_result::failed)
+				if (t && t->update(surface) != ui::texture_update_result::failed)
 				{
 					_texture = t;
 				}
@@ -2577,6 +2755,178 @@ void df::item_element::update(const file_path path, const index_file_item& info)
 	_is_folder = _ft == file_type::folder;
 }
 
+df::thumbnail_surface_cache& df::thumbnail_cache()
+{
+	static thumbnail_surface_cache cache(static_cast<size_t>(std::max(setting.thumbnail_cache_mb, 16)) * one_meg);
+	return cache;
+}
+
+ui::const_surface_ptr df::thumbnail_surface_cache::find(const file_path path, const date_t timestamp,
+	const bool cover_art)
+{
+	platform::exclusive_lock lock(_rw);
+	const auto& slots = _slots[cover_art];
+	const auto found = slots.find(path);
+
+	if (found != slots.end())
+	{
+		auto& e = _entries[found->second];
+
+		if (e.timestamp == timestamp)
+		{
+			e.referenced = true;
+			_stats.hits += 1;
+			return e.surface;
+		}
+	}
+
+	_stats.misses += 1;
+	return nullptr;
+}
+
+void df::thumbnail_surface_cache::insert(const file_path path, const date_t timestamp, const bool cover_art,
+	ui::const_surface_ptr surface)
+{
+	if (!is_valid(surface)) return;
+
+	const auto bytes = surface->size();
+
+	platform::exclusive_lock lock(_rw);
+	auto& slots = _slots[cover_art];
+	const auto found = slots.find(path);
+	size_t slot;
+
+	if (found != slots.end())
+	{
+		slot = found->second;
+		_bytes -= _entries[slot].bytes;
+	}
+	else
+	{
+		if (_free.empty())
+		{
+			slot = _entries.size();
+			_entries.emplace_back();
+		}
+		else
+		{
+			slot = _free.back();
+			_free.pop_back();
+		}
+
+		slots[path] = slot;
+	}
+
+	auto& e = _entries[slot];
+	e.path = path;
+	e.timestamp = timestamp;
+	e.cover_art = cover_art;
+	e.referenced = false;
+	e.surface = std::move(surface);
+	e.bytes = bytes;
+	_bytes += bytes;
+
+	evict(slot);
+}
+
+void df::thumbnail_surface_cache::remove(const size_t slot)
+{
+	auto& e = _entries[slot];
+	_slots[e.cover_art].erase(e.path);
+	_bytes -= e.bytes;
+	e = {};
+	_free.emplace_back(slot);
+}
+
+void df::thumbnail_surface_cache::evict(const size_t keep)
+{
+	while (_bytes > _budget && count() > 1)
+	{
+		if (_hand >= _entries.size()) _hand = 0;
+
+		auto& e = _entries[_hand];
+
+		if (e.surface && _hand != keep)
+		{
+			if (e.referenced)
+			{
+				e.referenced = false;
+			}
+			else
+			{
+				remove(_hand);
+				_stats.evictions += 1;
+			}
+		}
+
+		_hand += 1;
+	}
+}
+
+size_t df::thumbnail_surface_cache::count() const
+{
+	return _slots[0].size() + _slots[1].size();
+}
+
+void df::thumbnail_surface_cache::erase(const file_path path)
+{
+	platform::exclusive_lock lock(_rw);
+
+	for (const auto& slots : _slots)
+	{
+		const auto found = slots.find(path);
+
+		if (found != slots.end())
+		{
+			remove(found->second);
+		}
+	}
+}
+
+void df::thumbnail_surface_cache::budget(const size_t bytes)
+{
+	platform::exclusive_lock lock(_rw);
+	_budget = bytes;
+	evict(_entries.size());
+}
+
+void df::thumbnail_surface_cache::clear()
+{
+	platform::exclusive_lock lock(_rw);
+	_entries.clear();
+	_free.clear();
+	for (auto& slots : _slots) slots.clear();
+	_hand = 0;
+	_bytes = 0;
+}
+
+df::thumbnail_surface_cache::stats_t df::thumbnail_surface_cache::stats() const
+{
+	platform::shared_lock lock(_rw);
+	auto result = _stats;
+	result.count = count();
+	result.bytes = _bytes;
+	result.budget = _budget;
+	return result;
+}
+
+ui::const_surface_ptr df::thumbnail_surface_cache::surface(const file_path path, const date_t timestamp,
+	const bool cover_art, const ui::const_image_ptr& image)
+{
+	if (!is_valid(image)) return nullptr;
+
+	auto result = find(path, timestamp, cover_art);
+
+	if (!result)
+	{
+		files ff;
+		result = ff.image_to_surface(image);
+		insert(path, timestamp, cover_art, result);
+	}
+
+	return result;
+}
+
 void df::item_element::calc_folder_summary(cancel_token token)
 {
 	assert_true(is_folder());
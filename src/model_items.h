@@ -255,6 +255,7 @@ namespace df
 
 		mutable bloom_bits bloom;
 		mutable uint32_t crc32c = 0;
+		mutable uint64_t phash = 0;
 
 		index_file_item() = default;
 
@@ -269,7 +270,8 @@ namespace df
 			metadata(other.metadata.load()),
 			duplicates(other.duplicates),
 			bloom(other.bloom),
-			crc32c(other.crc32c)
+			crc32c(other.crc32c),
+			phash(other.phash)
 		{
 		}
 
@@ -284,7 +286,8 @@ namespace df
 			metadata(other.metadata.load()),
 			duplicates(std::move(other.duplicates)),
 			bloom(std::move(other.bloom)),
-			crc32c(other.crc32c)
+			crc32c(other.crc32c),
+			phash(other.phash)
 		{
 			other.metadata.store(nullptr);
 		}
@@ -304,6 +307,7 @@ namespace df
 			bloom = other.bloom;
 			duplicates = other.duplicates;
 			crc32c = other.crc32c;
+			phash = other.phash;
 			return *this;
 		}
 
@@ -323,6 +327,7 @@ namespace df
 			bloom = std::move(other.bloom);
 			duplicates = std::move(other.duplicates);
 			crc32c = other.crc32c;
+			phash = other.phash;
 			return *this;
 		}
 
@@ -384,7 +389,7 @@ namespace df
 
 		bool operator==(const str::cached other) const
 		{
-			return icmp(name, other) == 0;
+			return str::iequals(name, other);
 		}
 
 		bool operator==(const std::u8string_view other) const
@@ -394,7 +399,7 @@ namespace df
 
 		bool operator==(const index_file_item& other) const
 		{
-			return icmp(name, other.name) == 0;
+			return str::iequals(name, other.name);
 		}
 	};
 
@@ -443,6 +448,71 @@ namespace df
 		}
 	};
 
+	// Immutable struct-of-arrays snapshot of index items for sequential scans.
+	// Rows for folder i are [folder_offsets[i], folder_offsets[i + 1]).
+	struct index_columns
+	{
+		std::vector<folder_path> folder_paths;
+		std::vector<index_folder_item_ptr> folders;
+		std::vector<uint32_t> folder_offsets = { 0 };
+
+		std::vector<const index_file_item*> items;
+		std::vector<index_item_flags> flags;
+		std::vector<file_type_ref> ft;
+		std::vector<uint64_t> size;
+		std::vector<date_t> created; // metadata created in date search order, invalid if none
+		std::vector<date_t> media_created;
+		std::vector<date_t> file_created;
+		std::vector<date_t> modified;
+		std::vector<uint32_t> crc32c;
+		std::vector<uint64_t> phash;
+		std::vector<int16_t> rating;
+		std::vector<bloom_bits> bloom;
+		std::vector<gps_coordinate> coordinate;
+
+		size_t folder_count() const
+		{
+			return folders.size();
+		}
+
+		size_t row_count() const
+		{
+			return items.size();
+		}
+
+		uint32_t first_row(const size_t folder) const
+		{
+			return folder_offsets[folder];
+		}
+
+		uint32_t last_row(const size_t folder) const
+		{
+			return folder_offsets[folder + 1];
+		}
+
+		size_t folder_of_row(const size_t row) const
+		{
+			const auto found = std::upper_bound(folder_offsets.begin(), folder_offsets.end(), row);
+			return std::distance(folder_offsets.begin(), found) - 1;
+		}
+
+		date_t search_created(const size_t row) const
+		{
+			return created[row].is_valid() ? created[row] : file_created[row];
+		}
+
+		date_t dup_created(const size_t row) const
+		{
+			return media_created[row].is_valid() ? media_created[row] : file_created[row];
+		}
+
+		void reserve(size_t folder_count, size_t row_count);
+		void append(folder_path path, const index_folder_item_ptr& folder);
+		void append(folder_path path, const index_folder_item_ptr& folder, const index_columns& other, size_t other_folder);
+	};
+
+	using index_columns_ptr = std::shared_ptr<const index_columns>;
+
 
 	struct location_heat_map
 	{
@@ -537,6 +607,18 @@ namespace df
 			counts[ii].size += size;
 		}
 
+		void remove(const file_type_ref mt, const file_size& size)
+		{
+			const auto ii = mt->group->id;
+			if (counts[ii].count > 0) counts[ii].count -= 1;
+			counts[ii].size = size < counts[ii].size ? counts[ii].size - size : file_size{};
+		}
+
+		bool is_empty() const
+		{
+			return total_items().count == 0;
+		}
+
 		void add(const file_group_histogram& other)
 		{
 			for (auto i = 1; i < file_group::max_count; i++)
@@ -557,6 +639,67 @@ namespace df
 		}
 	};
 
+	// Decoded thumbnails shared by every view. Item textures are dropped when
+	// items scroll off screen; keeping the decoded surfaces means scrolling
+	// back only uploads them again. Entries are keyed by path and cover art,
+	// so hovering between the two keeps both, and checked against the
+	// thumbnail timestamp. Once over budget the CLOCK hand evicts the first
+	// entry not used since its last sweep.
+	class thumbnail_surface_cache : public no_copy
+	{
+	public:
+		struct stats_t
+		{
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+			size_t count = 0;
+			size_t bytes = 0;
+			size_t budget = 0;
+		};
+
+		explicit thumbnail_surface_cache(size_t budget) : _budget(budget)
+		{
+		}
+
+		ui::const_surface_ptr find(file_path path, date_t timestamp, bool cover_art);
+		void insert(file_path path, date_t timestamp, bool cover_art, ui::const_surface_ptr surface);
+
+		// Cached surface of image, decoded and inserted on a miss. Callers pass
+		// the image they read so no item state is touched here.
+		ui::const_surface_ptr surface(file_path path, date_t timestamp, bool cover_art, const ui::const_image_ptr& image);
+		void erase(file_path path);
+		void budget(size_t bytes);
+		void clear();
+		stats_t stats() const;
+
+	private:
+		struct entry
+		{
+			file_path path;
+			date_t timestamp;
+			bool cover_art = false;
+			bool referenced = false;
+			ui::const_surface_ptr surface;
+			size_t bytes = 0;
+		};
+
+		void evict(size_t keep);
+		void remove(size_t slot);
+		size_t count() const;
+
+		mutable platform::mutex _rw;
+		_Guarded_by_(_rw) std::vector<entry> _entries;
+		_Guarded_by_(_rw) std::vector<size_t> _free;
+		_Guarded_by_(_rw) std::array<dense_hash_map<file_path, size_t, ihash, ieq>, 2> _slots; // by cover_art
+		_Guarded_by_(_rw) size_t _hand = 0;
+		_Guarded_by_(_rw) size_t _bytes = 0;
+		_Guarded_by_(_rw) size_t _budget = 0;
+		_Guarded_by_(_rw) stats_t _stats;
+	};
+
+	thumbnail_surface_cache& thumbnail_cache();
+
 	class item_element final : public std::enable_shared_from_this<item_element>, public view_element
 	{
 	protected:
@@ -784,6 +927,7 @@ namespace df
 			_cover_art = std::move(ca);
 			_texture.reset();
 			_thumbnail_timestamp = timestamp;
+			thumbnail_cache().erase(_path);
 
 			if (_ft != file_type::folder)
 			{
@@ -21,6 +21,7 @@ static_assert(std::is_move_constructible_v<location_match>);
 static constexpr auto countries_file_name = u8"location-countries.txt"sv;
 static constexpr auto states_file_name = u8"location-states.txt"sv;
 static constexpr auto places_file_name = u8"location-places.txt"sv;
+static constexpr auto compiled_places_file_name = u8"location-places.bin"sv;
 
 const auto max_location_cols = 32;
 
@@ -144,7 +145,8 @@ split_location_result split_location(const std::u8string_view text)
 }
 
 
-location_cache::location_cache() : _locations_path(df::probe_data_file(places_file_name))
+location_cache::location_cache() : _locations_path(df::probe_data_file(places_file_name)),
+	_compiled_path(known_path(platform::known_folder::app_data).combine_file(compiled_places_file_name))
 {
 	static_assert(std::is_trivial_v<kd_coordinates_t>);
 	static_assert(std::is_trivial_v<location_id_and_offset>);
@@ -571,30 +573,20 @@ int location_cache::scan_entries(const std::u8string_view line, csv_entry* entri
 	return col_count;
 }
 
-int location_cache::scan_entries(u8istream& file, std::u8string& line, const std::streamoff offset, csv_entry* entries) const
+std::u8string_view location_cache::place_line(const uint32_t offset) const
 {
-	if (file.is_open())
-	{
-		file.clear();
-		file.seekg(offset, u8istream::beg);
-
-		if (std::getline(file, line))
-		{
-			return scan_entries(line, entries);
-		}
-	}
-
-	return 0;
+	if (offset >= _lines.size()) return {};
+	const auto line = _lines.substr(offset);
+	return line.substr(0, line.find(u8'\n'));
 }
 
-location_t location_cache::build_location(u8istream& file, const int offset) const
+location_t location_cache::build_location(const uint32_t offset) const
 {
 	location_t result;
-	std::u8string line;
 	csv_entry entries[max_location_cols];
-	const auto col_count = scan_entries(file, line, offset, entries);
+	const auto line = place_line(offset);
 
-	if (col_count > 0)
+	if (!line.empty() && scan_entries(line, entries) > 0)
 	{
 		result = build_location(entries);
 	}
@@ -614,17 +606,61 @@ location_t location_cache::build_location(const csv_entry* entries) const
 		population);
 }
 
-void location_cache::load_index()
+// Layout of location-places.bin. Sections are 8 byte aligned and hold the
+// string pool of place lines, then the tables that point into it.
+struct compiled_places_header
+{
+	static constexpr uint32_t marker = 0x4c504644; // DFPL
+	static constexpr uint32_t current_version = 1;
+
+	uint32_t magic = marker;
+	uint32_t version = current_version;
+	uint64_t source_size = 0;
+	uint64_t source_modified = 0;
+	uint64_t lines_offset = 0;
+	uint64_t lines_size = 0;
+	uint64_t ids_offset = 0;
+	uint64_t id_count = 0;
+	uint64_t ngrams_offset = 0;
+	uint64_t ngram_count = 0;
+	uint64_t coords_offset = 0;
+	uint64_t coord_count = 0;
+	uint64_t nodes_offset = 0;
+	uint64_t node_count = 0;
+};
+
+static_assert(sizeof(compiled_places_header) == 104);
+
+template <typename T>
+static uint64_t append_section(df::blob& result, const T* data, const size_t count)
+{
+	result.resize((result.size() + 7) & ~7_z);
+	const auto offset = result.size();
+	const auto* const p = std::bit_cast<const uint8_t*>(data);
+	result.insert(result.end(), p, p + (count * sizeof(T)));
+	return offset;
+}
+
+template <typename T>
+static bool section_span(const df::cspan data, const uint64_t offset, const uint64_t count, std::span<const T>& result)
+{
+	if ((offset % 8) != 0 || offset > data.size || count > (data.size - offset) / sizeof(T)) return false;
+	result = { std::bit_cast<const T*>(data.data + offset), static_cast<size_t>(count) };
+	return true;
+}
+
+df::blob location_cache::compile_places(const platform::file_attributes_t& source) const
 {
-	platform::exclusive_lock lock(_rw);
 	const auto expected_number_of_locations = 500000;
 
-	load_countries();
-	load_states();
+	std::u8string lines;
+	std::vector<kd_coordinates_t> coords;
+	std::vector<location_id_and_offset> locations_by_id;
+	std::vector<location_ngram_and_offset> locations_by_ngram;
 
-	_locations_by_id.reserve(expected_number_of_locations);
-	_locations_by_ngram.reserve(expected_number_of_locations);
-	_coords.reserve(expected_number_of_locations);
+	locations_by_id.reserve(expected_number_of_locations);
+	locations_by_ngram.reserve(expected_number_of_locations);
+	coords.reserve(expected_number_of_locations);
 
 	csv_entry entries[max_location_cols];
 
@@ -634,22 +670,23 @@ void location_cache::load_index()
 	if (file.is_open())
 	{
 		skip_bom(file);
-		auto pos = file.tellg();
 
 		std::u8string line;
 		while (std::getline(file, line))
 		{
-			if (df::is_closing) return;
+			if (df::is_closing) return {};
+
+			if (!line.empty() && line.back() == u8'\r') line.pop_back();
 
 			const auto entry_count = scan_entries(line, entries);
 			const auto id = static_cast<uint32_t>(entries[Cols::id].to_int());
 			const auto country = entries[Cols::countryCode].to_code2();
-			const auto offset = static_cast<uint32_t>(pos);
+			const auto offset = static_cast<uint32_t>(lines.size());
 			const auto x = entries[Cols::latitude].to_float();
 			const auto y = entries[Cols::longitude].to_float();
 
-			_coords.emplace_back(x, y, offset, country);
-			_locations_by_id.emplace_back(id, offset);
+			coords.emplace_back(x, y, offset, country);
+			locations_by_id.emplace_back(id, offset);
 
 			const auto name_entry_count = entry_count - Cols::name;
 			const auto* const name_entries = entries + Cols::name;
@@ -660,27 +697,129 @@ void location_cache::load_index()
 
 				if (!r.empty())
 				{
-					_locations_by_ngram.emplace_back(r, offset);
+					locations_by_ngram.emplace_back(r, offset);
 				}
 			}
 
-			pos = file.tellg();
+			lines += line;
+			lines += u8'\n';
 		}
 	}
 
-	std::sort(_locations_by_id.begin(), _locations_by_id.end());
-	std::sort(_locations_by_ngram.begin(), _locations_by_ngram.end());
+	std::sort(locations_by_id.begin(), locations_by_id.end());
+	std::sort(locations_by_ngram.begin(), locations_by_ngram.end());
+
+	kd_tree tree;
+	tree.build(coords);
+	const auto nodes = tree.nodes();
+
+	compiled_places_header header;
+	header.source_size = source.size;
+	header.source_modified = source.modified;
+
+	df::blob result(sizeof(header));
+	header.lines_offset = append_section(result, lines.data(), lines.size());
+	header.lines_size = lines.size();
+	header.ids_offset = append_section(result, locations_by_id.data(), locations_by_id.size());
+	header.id_count = locations_by_id.size();
+	header.ngrams_offset = append_section(result, locations_by_ngram.data(), locations_by_ngram.size());
+	header.ngram_count = locations_by_ngram.size();
+	header.coords_offset = append_section(result, coords.data(), coords.size());
+	header.coord_count = coords.size();
+	header.nodes_offset = append_section(result, nodes.data(), nodes.size());
+	header.node_count = nodes.size();
+	memcpy(result.data(), &header, sizeof(header));
+	return result;
+}
+
+bool location_cache::attach_places(const df::cspan data, const platform::file_attributes_t& source)
+{
+	compiled_places_header header;
+	if (data.size < sizeof(header)) return false;
+	memcpy(&header, data.data, sizeof(header));
+
+	// a missing places file keeps whatever was compiled before
+	const auto is_current = source.size == 0 ||
+		(header.source_size == source.size && header.source_modified == source.modified);
+
+	if (header.magic != compiled_places_header::marker ||
+		header.version != compiled_places_header::current_version ||
+		!is_current)
+	{
+		return false;
+	}
+
+	std::span<const char8_t> lines;
+	std::span<const location_id_and_offset> ids;
+	std::span<const location_ngram_and_offset> ngrams;
+	std::span<const kd_coordinates_t> coords;
+	std::span<const kd_node_t> nodes;
+
+	if (!section_span(data, header.lines_offset, header.lines_size, lines) ||
+		!section_span(data, header.ids_offset, header.id_count, ids) ||
+		!section_span(data, header.ngrams_offset, header.ngram_count, ngrams) ||
+		!section_span(data, header.coords_offset, header.coord_count, coords) ||
+		!section_span(data, header.nodes_offset, header.node_count, nodes))
+	{
+		return false;
+	}
+
+	_lines = { lines.data(), lines.size() };
+	_locations_by_id = ids;
+	_locations_by_ngram = ngrams;
+	_coords = coords;
+	_tree.attach(nodes);
+	return true;
+}
+
+void location_cache::load_index()
+{
+	platform::exclusive_lock lock(_rw);
+
+	{
+		platform::exclusive_lock cache_lock(_closest_rw);
+		_closest_cache.clear();
+	}
+
+	load_countries();
+	load_states();
+
+	const auto source = platform::file_attributes(_locations_path);
+	auto view = platform::map_file(_compiled_path);
+
+	if (view && attach_places(view->data(), source))
+	{
+		_places_view = std::move(view);
+		return;
+	}
+
+	view.reset();
+
+	auto compiled = compile_places(source);
+	if (df::is_closing) return;
 
-	_locations_by_id.shrink_to_fit();
-	_locations_by_ngram.shrink_to_fit();
-	_coords.shrink_to_fit();
+	const auto temp_path = df::file_path(_compiled_path.folder(), _compiled_path.file_name_without_extension(), u8".tmp"sv);
+
+	if (df::blob_save_to_file(compiled, temp_path) &&
+		platform::move_file(temp_path, _compiled_path, false).success())
+	{
+		view = platform::map_file(_compiled_path);
+
+		if (view && attach_places(view->data(), source))
+		{
+			_places_view = std::move(view);
+			return;
+		}
+	}
 
-	_tree.build(_coords);
+	df::log(__FUNCTION__, u8"Using locations compiled in memory"sv);
+	_places_blob = std::move(compiled);
+	attach_places(_places_blob, source);
 }
 
 struct location_match_possible
 {
-	std::u8string line;
+	std::u8string_view line;
 	location_match_part city;
 	location_match_part state;
 	location_match_part country;
@@ -792,142 +931,134 @@ location_matches location_cache::auto_complete(const std::u8string_view query, c
 		std::ranges::sort(ngram_matches);
 		ngram_matches.erase(std::ranges::unique(ngram_matches).begin(), ngram_matches.end());
 
-		u8istream file;
-		file.open(platform::to_file_system_path(_locations_path), u8istream::binary);
-
-		if (file.is_open())
+		for (const auto& line_offset : ngram_matches)
 		{
-			skip_bom(file);
-			std::u8string line;
-
-			for (const auto& line_offset : ngram_matches)
-			{
-				csv_entry entries[max_location_cols];
-				const auto entry_count = scan_entries(file, line, line_offset, entries);
-				const auto country = find_country(entries[Cols::countryCode].to_code2());
-				const auto is_same_country = closest.country == country.code();
-				const auto name_col_count = entry_count - Cols::name;
+			csv_entry entries[max_location_cols];
+			const auto line = place_line(line_offset);
+			const auto entry_count = scan_entries(line, entries);
+			const auto country = find_country(entries[Cols::countryCode].to_code2());
+			const auto is_same_country = closest.country == country.code();
+			const auto name_col_count = entry_count - Cols::name;
 
-				auto match_count = 0u;
-				location_match_possible possible;
+			auto match_count = 0u;
+			location_match_possible possible;
 
-				for (const auto& part : query_parts)
+			for (const auto& part : query_parts)
+			{
+				if (!short_query || is_same_country)
 				{
-					if (!short_query || is_same_country)
+					str::cached text_result;
+					str::part_t highlight_result;
+					bool has_match = false;
+
+					if (is_empty(possible.city.text))
+					{
+						if (find_match(entries + Cols::name, name_col_count, part, text_result, highlight_result))
+						{
+							possible.city.text = text_result;
+							possible.city.highlights.emplace_back(highlight_result);
+							match_count += 1;
+							has_match = true;
+						}
+					}
+					else
 					{
-						str::cached text_result;
-						str::part_t highlight_result;
-						bool has_match = false;
+						if (find_match(possible.city.text, part, text_result, highlight_result))
+						{
+							possible.city.highlights.emplace_back(highlight_result);
+							match_count += 1;
+							has_match = true;
+						}
+					}
 
-						if (is_empty(possible.city.text))
+					if (!has_match)
+					{
+						if (is_empty(possible.country.text))
 						{
-							if (find_match(entries + Cols::name, name_col_count, part, text_result, highlight_result))
+							if (find_match(country, part, text_result, highlight_result))
 							{
-								possible.city.text = text_result;
-								possible.city.highlights.emplace_back(highlight_result);
+								possible.country.text = text_result;
+								possible.country.highlights.emplace_back(highlight_result);
 								match_count += 1;
 								has_match = true;
 							}
 						}
 						else
 						{
-							if (find_match(possible.city.text, part, text_result, highlight_result))
+							if (find_match(possible.country.text, part, text_result, highlight_result))
 							{
-								possible.city.highlights.emplace_back(highlight_result);
+								possible.country.highlights.emplace_back(highlight_result);
 								match_count += 1;
 								has_match = true;
 							}
 						}
+					}
 
-						if (!has_match)
+					if (!has_match)
+					{
+						if (is_empty(possible.state.text))
 						{
-							if (is_empty(possible.country.text))
+							if (find_match(country, part, text_result, highlight_result))
 							{
-								if (find_match(country, part, text_result, highlight_result))
-								{
-									possible.country.text = text_result;
-									possible.country.highlights.emplace_back(highlight_result);
-									match_count += 1;
-									has_match = true;
-								}
-							}
-							else
-							{
-								if (find_match(possible.country.text, part, text_result, highlight_result))
-								{
-									possible.country.highlights.emplace_back(highlight_result);
-									match_count += 1;
-									has_match = true;
-								}
+								possible.state.text = text_result;
+								possible.state.highlights.emplace_back(highlight_result);
+								match_count += 1;
+								has_match = true;
 							}
 						}
-
-						if (!has_match)
+						else
 						{
-							if (is_empty(possible.state.text))
-							{
-								if (find_match(country, part, text_result, highlight_result))
-								{
-									possible.state.text = text_result;
-									possible.state.highlights.emplace_back(highlight_result);
-									match_count += 1;
-									has_match = true;
-								}
-							}
-							else
+							if (find_match(possible.state.text, part, text_result, highlight_result))
 							{
-								if (find_match(possible.state.text, part, text_result, highlight_result))
-								{
-									possible.state.highlights.emplace_back(highlight_result);
-									match_count += 1;
-									has_match = true;
-								}
+								possible.state.highlights.emplace_back(highlight_result);
+								match_count += 1;
+								has_match = true;
 							}
 						}
+					}
 
-						if (!has_match)
-						{
-							break;
-						}
+					if (!has_match)
+					{
+						break;
 					}
 				}
+			}
 
-				if (match_count == query_parts.size())
-				{
-					gps_coordinate position(entries[Cols::latitude].to_double(), entries[Cols::longitude].to_double());
-					possible.distance_away = default_location.magnitude_between_locations(position);
-					possible.line = line;
-					possible_matches.emplace_back(possible);
-				}
+			if (match_count == query_parts.size())
+			{
+				gps_coordinate position(entries[Cols::latitude].to_double(), entries[Cols::longitude].to_double());
+				possible.distance_away = default_location.magnitude_between_locations(position);
+				possible.line = line;
+				possible_matches.emplace_back(possible);
 			}
+		}
 
-			std::sort(possible_matches.begin(), possible_matches.end());
+		std::sort(possible_matches.begin(), possible_matches.end());
 
-			for (const auto& possible : possible_matches)
+		for (const auto& possible : possible_matches)
+		{
+			if (result.size() < max_results)
 			{
-				if (result.size() < max_results)
-				{
-					csv_entry entries[max_location_cols];
-					const auto col_count = scan_entries(possible.line, entries);
+				csv_entry entries[max_location_cols];
+				const auto col_count = scan_entries(possible.line, entries);
 
-					location_match lm;
+				location_match lm;
 
-					if (col_count > 0)
-					{
-						lm.location = build_location(entries);
-					}
+				if (col_count > 0)
+				{
+					lm.location = build_location(entries);
+				}
 
-					lm.city = possible.city;
-					lm.state = possible.state;
-					lm.country = possible.country;
+				lm.city = possible.city;
+				lm.state = possible.state;
+				lm.country = possible.country;
 
-					if (is_empty(lm.city.text)) lm.city.text = lm.location.place;
-					if (is_empty(lm.state.text)) lm.state.text = lm.location.state;
-					if (is_empty(lm.country.text)) lm.country.text = lm.location.country;
+				if (is_empty(lm.city.text)) lm.city.text = lm.location.place;
+				if (is_empty(lm.state.text)) lm.state.text = lm.location.state;
+				if (is_empty(lm.country.text)) lm.country.text = lm.location.country;
 
-					lm.distance_away = possible.distance_away;
-					result.emplace_back(lm);
-				}
+				lm.distance_away = possible.distance_away;
+				result.emplace_back(lm);
 			}
 		}
 	}
@@ -944,25 +1075,22 @@ location_t location_cache::find_by_id(const uint32_t id) const
 
 	if (found != _locations_by_id.end() && found->id == id)
 	{
-		u8istream file;
-		file.open(platform::to_file_system_path(_locations_path), u8istream::binary);
-
-		if (file.is_open())
-		{
-			skip_bom(file);
-			result = build_location(file, found->offset);
-		}
+		result = build_location(found->offset);
 	}
 
 	return result;
 }
 
 country_loc location_cache::find_country(const double x, const double y) const
+{
+	const gps_coordinate coord(x, y);
+	return find_country_loc(find_closest_places({ &coord, 1 }).front().country);
+}
+
+country_loc location_cache::find_country_loc(const uint32_t code) const
 {
 	platform::shared_lock lock(_rw);
-	const kd_coordinates_t xy = { static_cast<float>(x), static_cast<float>(y) };
-	const auto closest = _tree.find_closest(_coords, xy);
-	const auto found = _countries.find(closest.country);
+	const auto found = _countries.find(code);
 	return found != _countries.end()
 		? country_loc{ found->second.code2(), found->second.name(), found->second.centroid() }
 	: country_loc{};
@@ -972,16 +1100,151 @@ location_t location_cache::find_closest(const double x, const double y) const
 {
 	platform::shared_lock lock(_rw);
 	location_t result;
-	u8istream file;
-	file.open(platform::to_file_system_path(_locations_path), u8istream::binary);
 
-	if (file.is_open())
+	if (!_tree.is_empty())
 	{
-		skip_bom(file);
-
 		const kd_coordinates_t xy = { static_cast<float>(x), static_cast<float>(y) };
 		const auto closest = _tree.find_closest(_coords, xy);
-		result = build_location(file, closest.offset);
+		result = build_location(closest.offset);
+	}
+
+	return result;
+}
+
+// Cells are a thousandth of a degree. Interleaving the cell bits gives a
+// Morton code, so sorting by cell also keeps nearby coordinates together and
+// consecutive tree walks visit the same nodes.
+static constexpr double cells_per_degree = 1000.0;
+
+static uint64_t spread_bits(uint64_t v)
+{
+	v &= 0xffffffffull;
+	v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+	v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+	v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+	v = (v | (v << 2)) & 0x3333333333333333ull;
+	v = (v | (v << 1)) & 0x5555555555555555ull;
+	return v;
+}
+
+static uint32_t compact_bits(uint64_t v)
+{
+	v &= 0x5555555555555555ull;
+	v = (v | (v >> 1)) & 0x3333333333333333ull;
+	v = (v | (v >> 2)) & 0x0f0f0f0f0f0f0f0full;
+	v = (v | (v >> 4)) & 0x00ff00ff00ff00ffull;
+	v = (v | (v >> 8)) & 0x0000ffff0000ffffull;
+	v = (v | (v >> 16)) & 0x00000000ffffffffull;
+	return static_cast<uint32_t>(v);
+}
+
+static uint64_t quantize_coordinate(const double x, const double y)
+{
+	const auto qx = static_cast<uint64_t>(std::lround((std::clamp(x, -90.0, 90.0) + 90.0) * cells_per_degree));
+	const auto qy = static_cast<uint64_t>(std::lround((std::clamp(y, -180.0, 180.0) + 180.0) * cells_per_degree));
+	return spread_bits(qx) | (spread_bits(qy) << 1);
+}
+
+static kd_coordinates_t cell_center(const uint64_t cell)
+{
+	kd_coordinates_t result = {};
+	result.x = static_cast<float>((compact_bits(cell) / cells_per_degree) - 90.0);
+	result.y = static_cast<float>((compact_bits(cell >> 1) / cells_per_degree) - 180.0);
+	return result;
+}
+
+closest_place location_cache::find_closest_place(const uint64_t cell) const
+{
+	closest_place result;
+
+	if (!_tree.is_empty())
+	{
+		const auto closest = _tree.find_closest(_coords, cell_center(cell));
+		const auto line = place_line(closest.offset);
+		result.id = static_cast<uint32_t>(str::to_int(line.substr(0, line.find(u8'\t'))));
+		result.country = closest.country;
+	}
+
+	return result;
+}
+
+std::vector<closest_place> location_cache::find_closest_places(const std::span<const gps_coordinate> coords) const
+{
+	std::vector<closest_place> result(coords.size());
+	std::vector<std::pair<uint64_t, uint32_t>> cells;
+	cells.reserve(coords.size());
+
+	for (uint32_t i = 0; i < coords.size(); ++i)
+	{
+		if (coords[i].is_valid())
+		{
+			cells.emplace_back(quantize_coordinate(coords[i].latitude(), coords[i].longitude()), i);
+		}
+	}
+
+	std::ranges::sort(cells);
+
+	std::vector<uint64_t> unique_cells;
+
+	for (const auto& c : cells)
+	{
+		if (unique_cells.empty() || unique_cells.back() != c.first)
+		{
+			unique_cells.emplace_back(c.first);
+		}
+	}
+
+	std::vector<closest_place> places(unique_cells.size());
+	std::vector<uint32_t> missing;
+
+	{
+		platform::shared_lock lock(_closest_rw);
+
+		for (uint32_t i = 0; i < unique_cells.size(); ++i)
+		{
+			const auto found = _closest_cache.find(unique_cells[i]);
+
+			if (found != _closest_cache.end())
+			{
+				places[i] = found->second;
+			}
+			else
+			{
+				missing.emplace_back(i);
+			}
+		}
+	}
+
+	if (!missing.empty())
+	{
+		{
+			platform::shared_lock lock(_rw);
+
+			platform::default_work_pool().parallel_for(missing.size(), 64,
+				[this, &missing, &unique_cells, &places](size_t, const size_t begin, const size_t end)
+				{
+					for (auto m = begin; m < end; ++m)
+					{
+						places[missing[m]] = find_closest_place(unique_cells[missing[m]]);
+					}
+				});
+		}
+
+		platform::exclusive_lock lock(_closest_rw);
+
+		for (const auto m : missing)
+		{
+			// nothing is cached until the index is loaded
+			if (places[m].id != 0) _closest_cache[unique_cells[m]] = places[m];
+		}
+	}
+
+	size_t u = 0;
+
+	for (const auto& c : cells)
+	{
+		while (unique_cells[u] != c.first) ++u;
+		result[c.second] = places[u];
 	}
 
 	return result;
@@ -135,6 +135,12 @@ struct location_match
 
 using location_matches = std::vector<location_match>;
 
+struct closest_place
+{
+	uint32_t id = 0;
+	uint32_t country = 0;
+};
+
 class location_cache final : public df::no_copy
 {
 private:
@@ -142,6 +148,7 @@ private:
 	_Guarded_by_(_rw)  kd_tree _tree;
 	_Guarded_by_(_rw)  df::hash_map<uint32_t, country_t> _countries;
 	_Guarded_by_(_rw)  const df::file_path _locations_path;
+	_Guarded_by_(_rw)  const df::file_path _compiled_path;
 
 	struct location_id_and_offset
 	{
@@ -229,17 +236,32 @@ private:
 		}
 	};
 
-	_Guarded_by_(_rw) std::vector<kd_coordinates_t> _coords;
-	_Guarded_by_(_rw) std::vector<location_id_and_offset> _locations_by_id;
-	_Guarded_by_(_rw) std::vector<location_ngram_and_offset> _locations_by_ngram;
+	// The places file compiled to tables that are used in place, either from a
+	// memory mapped file or from memory if the file could not be written.
+	// Offsets refer to lines in the string pool.
+	_Guarded_by_(_rw) platform::mapped_file_ptr _places_view;
+	_Guarded_by_(_rw) df::blob _places_blob;
+	_Guarded_by_(_rw) std::u8string_view _lines;
+	_Guarded_by_(_rw) std::span<const kd_coordinates_t> _coords;
+	_Guarded_by_(_rw) std::span<const location_id_and_offset> _locations_by_id;
+	_Guarded_by_(_rw) std::span<const location_ngram_and_offset> _locations_by_ngram;
+
+	// reverse geocoding results by quantized coordinate, see quantize_coordinate
+	mutable platform::mutex _closest_rw;
+	_Guarded_by_(_closest_rw) mutable df::hash_map<uint64_t, closest_place> _closest_cache;
+
+	closest_place find_closest_place(uint64_t cell) const;
 
 	void load_countries();
 	void load_states();
 
+	df::blob compile_places(const platform::file_attributes_t& source) const;
+	bool attach_places(df::cspan data, const platform::file_attributes_t& source);
+	std::u8string_view place_line(uint32_t offset) const;
+
 	static int scan_entries(std::u8string_view line, csv_entry* entries);
-	int scan_entries(u8istream& file, std::u8string& line, std::streamoff offset, csv_entry* entries) const;
 
-	location_t build_location(u8istream& file, int offset) const;
+	location_t build_location(uint32_t offset) const;
 	location_t build_location(const csv_entry* entries) const;
 
 public:
@@ -255,9 +277,14 @@ public:
 	}
 
 	country_loc find_country(double x, double y) const;
+	country_loc find_country_loc(uint32_t code) const;
 	location_t find_closest(double x, double y) const;
 	location_t find_by_id(uint32_t id) const;
 
+	// Closest place for each coordinate, in the same order. Coordinates are
+	// snapped to a grid of about 100m and each cell is only looked up once.
+	std::vector<closest_place> find_closest_places(std::span<const gps_coordinate> coords) const;
+
 	location_matches auto_complete(std::u8string_view query, uint32_t max_results,
 		gps_coordinate default_location) const;
 
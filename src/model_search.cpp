@@ -1909,6 +1909,10 @@ df::search_result df::search_matcher::match_item(const file_path path, const ind
 		{
 			result.type = search_result_type::similar;
 		}
+		else if (file.phash != 0 && similar.contains(path))
+		{
+			result.type = search_result_type::similar;
+		}
 		else
 		{
 			return result;
@@ -1947,12 +1951,13 @@ df::search_result df::search_matcher::match_item(const file_path path, const ind
 	return match_all_terms(path.folder().text(), file);
 }
 
-df::search_result df::search_matcher::match_all_terms(str::cached folder_name, const index_file_item& file) const
+template <typename T>
+static df::search_result match_term_levels(const std::vector<df::search_term>& terms, T&& match_term)
 {
-	if (_search._terms.size() == 1)
+	if (terms.size() == 1)
 	{
 		// optimisation for single term
-		return match_term(folder_name, file, _search._terms[0]);
+		return match_term(terms[0]);
 	}
 
 	struct level
@@ -1964,11 +1969,11 @@ df::search_result df::search_matcher::match_all_terms(str::cached folder_name, c
 	const auto max_levels = 32;
 	level level_results[max_levels];
 	auto current_level = 0;
-	auto result_type = search_result_type::no_match;
+	auto result_type = df::search_result_type::no_match;
 
-	for (const auto& term : _search._terms)
+	for (const auto& term : terms)
 	{
-		const auto match_type = match_term(folder_name, file, term);
+		const auto match_type = match_term(term);
 		const auto is_match = match_type.is_match();
 		result_type = match_type.merge_result_type(result_type);
 
@@ -1980,12 +1985,12 @@ df::search_result df::search_matcher::match_all_terms(str::cached folder_name, c
 				{
 					current_level += 1;
 					level_results[current_level].logical_and = term.modifiers.logical_op !=
-						search_term_modifier_bool::m_or;
+						df::search_term_modifier_bool::m_or;
 					level_results[current_level].state = is_match;
 				}
 			}
 		}
-		else if (term.modifiers.logical_op != search_term_modifier_bool::m_or)
+		else if (term.modifiers.logical_op != df::search_term_modifier_bool::m_or)
 		{
 			level_results[current_level].state &= is_match;
 		}
@@ -2013,7 +2018,169 @@ df::search_result df::search_matcher::match_all_terms(str::cached folder_name, c
 	}
 
 	//return { level_results[0].state ? result_type : search_result_type::no_match };
-	return { level_results[0].state ? search_result_type::match_multiple : search_result_type::no_match };
+	return { level_results[0].state ? df::search_result_type::match_multiple : df::search_result_type::no_match };
+}
+
+df::search_result df::search_matcher::match_all_terms(str::cached folder_name, const index_file_item& file) const
+{
+	return match_term_levels(_search._terms, [this, folder_name, &file](const search_term& term)
+		{
+			return match_term(folder_name, file, term);
+		});
+}
+
+static bool is_column_term(const df::search_term& term)
+{
+	if (term.type == df::search_term_type::media_type ||
+		term.type == df::search_term_type::location ||
+		term.is_date())
+	{
+		return true;
+	}
+
+	if (term.type == df::search_term_type::value)
+	{
+		return term.key == prop::file_size || term.key == prop::rating;
+	}
+
+	if (term.type == df::search_term_type::has_type)
+	{
+		return term.key == prop::modified ||
+			term.key == prop::file_size ||
+			term.key == prop::rating ||
+			term.key == prop::latitude ||
+			term.key == prop::longitude;
+	}
+
+	return false;
+}
+
+bool df::search_t::can_match_columns() const
+{
+	if (_terms.empty() || has_related())
+	{
+		return false;
+	}
+
+	return std::ranges::all_of(_terms, is_column_term);
+}
+
+static bool is_date_match(const df::search_term& term, const df::index_columns& columns, const size_t row,
+	const uint32_t now_days)
+{
+	const bool is_any = term.date_val.target == df::date_parts_prop::any;
+
+	if (term.date_val.target == df::date_parts_prop::created || is_any)
+	{
+		if (columns.created[row].is_valid())
+		{
+			return is_date_match(term.date_val, columns.created[row], term.modifiers, now_days);
+		}
+
+		if (is_date_match(term.date_val, columns.file_created[row], term.modifiers, now_days))
+		{
+			return true;
+		}
+	}
+
+	if (term.date_val.target == df::date_parts_prop::modified || is_any)
+	{
+		if (is_date_match(term.date_val, columns.modified[row], term.modifiers, now_days)) return true;
+	}
+
+	return false;
+}
+
+static bool has_type(const prop::key_ref t, const df::index_columns& columns, const size_t row)
+{
+	if (t == prop::modified) return !prop::is_null(columns.modified[row]);
+	if (t == prop::file_size) return columns.size[row] != 0;
+	if (t == prop::rating) return !prop::is_null(columns.rating[row]);
+	if (t == prop::latitude || t == prop::longitude) return columns.coordinate[row].is_valid();
+	return false;
+}
+
+static compare_result compare_val(const df::search_term& term, const df::index_columns& columns, const size_t row)
+{
+	if (term.key == prop::file_size && columns.size[row] != 0) return compare_file_size(term, columns.size[row]);
+	if (term.key == prop::rating && !prop::is_null(columns.rating[row])) return compare_term(term, columns.rating[row]);
+	return {};
+}
+
+df::search_result df::search_matcher::match_term(const index_columns& columns, const size_t row,
+	const search_term& term) const
+{
+	search_result result;
+
+	if (term.type == search_term_type::media_type)
+	{
+		const bool match_file_group = term.fg_val == columns.ft[row]->group;
+
+		if (match_file_group == term.modifiers.positive)
+		{
+			result.type = search_result_type::match_file_group;
+		}
+	}
+	else if (term.type == search_term_type::location)
+	{
+		const auto& coord = columns.coordinate[row];
+		const auto match_location =
+			term.coord_val.is_valid() &&
+			coord.is_valid() &&
+			term.coord_val.distance_in_kilometers(coord) < term.float_val;
+
+		if (match_location == term.modifiers.positive)
+		{
+			result.type = search_result_type::match_location;
+		}
+	}
+	else if (term.is_date())
+	{
+		const bool match_date = is_date_match(term, columns, row, _now_days);
+
+		if (match_date == term.modifiers.positive)
+		{
+			result.type = search_result_type::match_date;
+		}
+	}
+	else if (term.type == search_term_type::has_type)
+	{
+		const bool match_has_type = has_type(term.key, columns, row);
+
+		if (match_has_type == term.modifiers.positive)
+		{
+			result.type = search_result_type::has_type;
+		}
+	}
+	else if (term.type == search_term_type::value)
+	{
+		const auto cmp = compare_val(term, columns, row);
+		const bool match_value = modifier_match(cmp, term.modifiers);
+
+		if (match_value == term.modifiers.positive)
+		{
+			result.type = search_result_type::match_prop;
+			result.key = term.key;
+			result.text = cmp.val_matched;
+		}
+	}
+
+	return result;
+}
+
+df::search_result df::search_matcher::match_row(const index_columns& columns, const size_t row) const
+{
+	df::assert_true(can_match_columns);
+
+	if (!potential_match(columns.bloom[row]))
+	{
+		return { search_result_type::no_match };
+	}
+
+	return match_term_levels(_search._terms, [this, &columns, row](const search_term& term)
+		{
+			return match_term(columns, row, term);
+		});
 }
 
 df::search_result df::search_matcher::match_folder(str::cached folder_name, const str::cached name) const
@@ -685,6 +685,7 @@ namespace df
 		}
 
 		bool needs_metadata() const;
+		bool can_match_columns() const;
 
 		bool has_related() const
 		{
@@ -1092,17 +1093,24 @@ namespace df
 			_now_days(now_days),
 			has_terms(s.has_terms()),
 			need_metadata(s.needs_metadata()),
-			can_match_folder(_search.can_match_folder())
+			can_match_folder(_search.can_match_folder()),
+			can_match_columns(_search.can_match_columns())
 		{
 		}
 
 		const bool has_terms = false;
 		const bool need_metadata = false;
 		const bool can_match_folder = false;
+		const bool can_match_columns = false;
+
+		// items whose perceptual hash is close to the related item
+		unique_paths similar;
 
 		bool potential_match(const bloom_bits& bloom_bits) const;
 		search_result match_term(str::cached folder_name, const index_file_item& file, const search_term& term) const;
 		search_result match_all_terms(str::cached folder_name, const index_file_item& file) const;
+		search_result match_term(const index_columns& columns, size_t row, const search_term& term) const;
+		search_result match_row(const index_columns& columns, size_t row) const;
 
 		search_result match_item(file_path path, const index_file_item& file) const;
 		search_result match_folder(str::cached folder_name, str::cached name) const;
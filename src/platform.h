@@ -173,8 +173,20 @@ namespace platform
 		create,
 		sequential_scan,
 		read_write,
+		append,
 	};
 
+	// Read-only view of a whole file. The view does not grow with the file,
+	// map it again after appending.
+	class mapped_file
+	{
+	public:
+		virtual ~mapped_file() = default;
+		virtual df::cspan data() const = 0;
+	};
+
+	using mapped_file_ptr = std::shared_ptr<mapped_file>;
+
 	std::wstring to_file_system_path(df::file_path path);
 	std::wstring to_file_system_path(df::folder_path path);
 
@@ -198,7 +210,10 @@ namespace platform
 
 	df::folder_path known_path(known_folder f);
 	file_ptr open_file(df::file_path path, file_open_mode mode);
+	mapped_file_ptr map_file(df::file_path path);
 	uint32_t file_crc32(df::file_path path);
+	// crc32c of the size plus the first and last span bytes; a cheap pre-screen for large files
+	uint32_t file_head_tail_crc32(df::file_path path, uint32_t span);
 	ui::const_surface_ptr create_segoe_md2_icon(wchar_t ch);
 	bool eject(df::folder_path path);
 
@@ -516,6 +531,10 @@ namespace platform
 		void set() const noexcept;
 	};
 
+	extern uint32_t wait_for_timeout;
+	uint32_t wait_for(const std::vector<std::reference_wrapper<thread_event>>& events, uint32_t timeout_ms,
+		bool wait_all);
+
 	template <typename T>
 	struct queue
 	{
@@ -537,6 +556,12 @@ namespace platform
 			_storage.emplace_back(std::move(f));
 		}
 
+		size_t size()
+		{
+			shared_lock lock_dec(_rw);
+			return _storage.size();
+		}
+
 		void reset_and_enqueue(T f)
 		{
 			exclusive_lock lock_dec(_rw);
@@ -557,6 +582,80 @@ namespace platform
 		}
 	};
 
+	// Fixed capacity queue between the stages of a pipeline. push blocks while
+	// the queue is full and pop while it is empty, so a slow stage holds back
+	// the stages feeding it. close releases all waiters; pop still returns the
+	// remaining items and then false.
+	template <typename T>
+	class bounded_queue : public df::no_copy
+	{
+	public:
+		explicit bounded_queue(const size_t capacity) : _capacity(capacity), _not_full(true, true),
+			_not_empty(true, false)
+		{
+		}
+
+		bool push(T v)
+		{
+			while (true)
+			{
+				{
+					exclusive_lock lock(_rw);
+					if (_closed) return false;
+
+					if (_items.size() < _capacity)
+					{
+						_items.emplace_back(std::move(v));
+						_not_empty.set();
+						if (_items.size() >= _capacity) _not_full.reset();
+						return true;
+					}
+				}
+
+				wait_for({ _not_full }, 0, false);
+			}
+		}
+
+		bool pop(T& result)
+		{
+			while (true)
+			{
+				{
+					exclusive_lock lock(_rw);
+
+					if (!_items.empty())
+					{
+						result = std::move(_items.front());
+						_items.pop_front();
+						_not_full.set();
+						if (_items.empty() && !_closed) _not_empty.reset();
+						return true;
+					}
+
+					if (_closed) return false;
+				}
+
+				wait_for({ _not_empty }, 0, false);
+			}
+		}
+
+		void close()
+		{
+			exclusive_lock lock(_rw);
+			_closed = true;
+			_not_full.set();
+			_not_empty.set();
+		}
+
+	private:
+		const size_t _capacity;
+		mutex _rw;
+		_Guarded_by_(_rw) std::deque<T> _items;
+		_Guarded_by_(_rw) bool _closed = false;
+		thread_event _not_full;
+		thread_event _not_empty;
+	};
+
 	class task_queue
 	{
 	public:
@@ -623,6 +722,161 @@ namespace platform
 		}
 	};
 
+	// Shared worker threads for data parallel loops. parallel_for gives each
+	// worker a slice of the range; workers that finish early steal chunks
+	// from the slices of the others. The calling thread runs as worker 0.
+	class work_pool : public df::no_copy
+	{
+	public:
+		using range_func = std::function<void(size_t worker, size_t begin, size_t end)>;
+
+		explicit work_pool(size_t thread_count);
+		~work_pool();
+
+		size_t worker_count() const
+		{
+			return _thread_count + 1;
+		}
+
+		// Runs f over [0, count) in chunks of chunk_size. Falls back to running the
+		// chunks in order on the calling thread if the pool is already busy.
+		// Chunks not yet started are skipped once token is cancelled.
+		void parallel_for(size_t count, size_t chunk_size, const range_func& f, size_t max_workers = 0,
+			const df::cancel_token& token = {});
+
+	private:
+		struct job;
+
+		void start_threads();
+		void run_worker(size_t worker);
+
+		const size_t _thread_count = 0;
+		mutex _rw;
+		_Guarded_by_(_rw) std::vector<std::thread> _threads;
+		_Guarded_by_(_rw) std::vector<std::unique_ptr<thread_event>> _wake;
+		std::atomic<job*> _job = nullptr;
+		std::atomic_bool _busy = false;
+		std::atomic_bool _stop = false;
+	};
+
+	work_pool& default_work_pool();
+
+	// Runs queued tasks on a fixed set of threads sized to the hardware.
+	// Tasks are queued on lanes and workers always take from the highest
+	// priority lane that is ready. Each lane runs one task at a time, in
+	// order, as a dedicated thread would. Background lanes never occupy
+	// every worker so interactive work is not stuck behind indexing.
+	class executor : public df::no_copy
+	{
+	public:
+		using task_t = std::function<void()>;
+
+		enum class priority
+		{
+			interactive,
+			normal,
+			background
+		};
+
+		// Log2 buckets of microseconds: bucket i counts values below 2^i us
+		// and the last bucket everything slower.
+		struct latency_histogram
+		{
+			static constexpr size_t bucket_count = 25;
+
+			std::array<uint32_t, bucket_count> buckets = {};
+			uint64_t count = 0;
+			uint64_t total_us = 0;
+			uint64_t max_us = 0;
+
+			void record(const uint64_t us)
+			{
+				buckets[std::min(static_cast<size_t>(std::bit_width(us)), bucket_count - 1)] += 1;
+				count += 1;
+				total_us += us;
+				max_us = std::max(max_us, us);
+			}
+
+			// upper bound of the bucket holding the p'th percentile
+			uint64_t percentile_us(const double p) const
+			{
+				const auto target = static_cast<uint64_t>(std::ceil(p * static_cast<double>(count)));
+				uint64_t seen = 0;
+
+				for (size_t i = 0; i < bucket_count; ++i)
+				{
+					seen += buckets[i];
+					if (seen >= target && seen > 0) return std::min(uint64_t{ 1 } << i, max_us);
+				}
+
+				return max_us;
+			}
+		};
+
+		struct lane_stats
+		{
+			std::u8string name;
+			priority pri = priority::normal;
+			uint64_t completed = 0;
+			uint64_t coalesced = 0;
+			size_t depth = 0;
+			size_t max_depth = 0;
+			latency_histogram wait;
+			latency_histogram run;
+		};
+
+		explicit executor(size_t thread_count);
+		~executor();
+
+		size_t thread_count() const
+		{
+			return _thread_count;
+		}
+
+		// Paused lanes collect tasks but do not run them until resumed.
+		size_t add_lane(std::u8string_view name, priority pri, bool paused = false);
+		void resume(size_t lane);
+		void enqueue(size_t lane, task_t f);
+
+		// Replaces any pending tasks of the lane; the lane acts as a coalescing key.
+		void reset_and_enqueue(size_t lane, task_t f);
+
+		void start();
+		void stop();
+
+		// Snapshot of per lane counters, wait times (enqueue to start) and run times.
+		std::vector<lane_stats> stats() const;
+
+	private:
+		struct queued_task
+		{
+			task_t f;
+			uint64_t queued_us = 0;
+		};
+
+		struct lane
+		{
+			bool paused = false;
+			bool running = false;
+			std::deque<queued_task> tasks;
+			lane_stats stats;
+		};
+
+		bool take(size_t& lane_index, queued_task& result);
+		void wake_one();
+		void run_worker(size_t worker);
+
+		const size_t _thread_count = 0;
+		mutex _rw;
+		_Guarded_by_(_rw) std::vector<lane> _lanes;
+		_Guarded_by_(_rw) std::vector<size_t> _idle;
+		_Guarded_by_(_rw) std::vector<std::unique_ptr<thread_event>> _wake;
+		_Guarded_by_(_rw) size_t _next_lane = 0;
+		_Guarded_by_(_rw) size_t _running_background = 0;
+		std::vector<std::thread> _threads;
+		std::atomic_bool _stop = false;
+	};
+
 	class thread_init
 	{
 		uint32_t _hr = 0;
@@ -632,9 +886,90 @@ namespace platform
 		~thread_init();
 	};
 
-	extern uint32_t wait_for_timeout;
-	uint32_t wait_for(const std::vector<std::reference_wrapper<thread_event>>& events, uint32_t timeout_ms,
-		bool wait_all);
+	// Walks folder trees with up to max_in_flight folders listed at once. A
+	// listing on a network share mostly waits on round trips, so overlapping
+	// them hides the latency of deep trees. list runs concurrently and does
+	// the slow part; merge is called one at a time with its result and pushes
+	// the sub folders to walk onto pending. Folders are taken from the back
+	// of pending, depth first like a single threaded walk with a stack.
+	template <typename T, typename List, typename Merge>
+	void walk_folders(std::vector<T> roots, const List& list, const Merge& merge, const df::cancel_token& token,
+		const size_t max_in_flight = 8)
+	{
+		mutex rw;
+		std::vector<T> pending = std::move(roots);
+		size_t in_flight = 0;
+		thread_event changed(true, false);
+
+		const auto worker = [&]
+			{
+				while (true)
+				{
+					T folder;
+					auto taken = false;
+
+					{
+						exclusive_lock lock(rw);
+
+						if (!pending.empty() && !token.is_cancelled())
+						{
+							folder = std::move(pending.back());
+							pending.pop_back();
+							in_flight += 1;
+							taken = true;
+						}
+						else if (in_flight == 0)
+						{
+							changed.set();
+							return;
+						}
+						else
+						{
+							changed.reset();
+						}
+					}
+
+					if (!taken)
+					{
+						// a listing in flight may still add sub folders
+						wait_for({ changed }, 0, false);
+						continue;
+					}
+
+					try
+					{
+						auto result = list(folder);
+						exclusive_lock lock(rw);
+						merge(folder, std::move(result), pending);
+					}
+					catch (std::exception& e)
+					{
+						df::log(__FUNCTION__, e.what());
+					}
+
+					{
+						exclusive_lock lock(rw);
+						in_flight -= 1;
+						changed.set();
+					}
+				}
+			};
+
+		threads workers;
+
+		for (size_t i = 1; i < max_in_flight; ++i)
+		{
+			workers.start([&worker]
+				{
+					thread_init init;
+					worker();
+				});
+		}
+
+		worker();
+		workers.clear();
+	}
+
 	using attachments_t = std::vector<std::pair<std::u8string, df::file_path>>;
 	bool mapi_send(std::u8string_view to, std::u8string_view subject, std::u8string_view text,
 		const attachments_t& attachments);
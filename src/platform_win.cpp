@@ -3231,6 +3231,12 @@ platform::file_ptr platform::open_file(const df::file_path path, const file_open
 	case file_open_mode::sequential_scan:
 		flags_and_attributes = FILE_FLAG_SEQUENTIAL_SCAN;
 		break;
+	case file_open_mode::append:
+		// readers may map the file while it is appended to
+		desired_access = GENERIC_READ | GENERIC_WRITE;
+		share_mode = FILE_SHARE_READ | FILE_SHARE_WRITE;
+		creation_disposition = OPEN_ALWAYS;
+		break;
 	default:;
 	}
 
@@ -3246,6 +3252,68 @@ platform::file_ptr platform::open_file(const df::file_path path, const file_open
 	return std::make_shared<file_impl>(file);
 }
 
+class mapped_file_impl : public platform::mapped_file
+{
+	HANDLE _mapping = nullptr;
+	const uint8_t* _view = nullptr;
+	size_t _size = 0;
+
+public:
+	mapped_file_impl(HANDLE mapping, const uint8_t* view, const size_t size) : _mapping(mapping), _view(view),
+		_size(size)
+	{
+	}
+
+	~mapped_file_impl() override
+	{
+		if (_view) UnmapViewOfFile(_view);
+		if (_mapping) CloseHandle(_mapping);
+	}
+
+	df::cspan data() const override
+	{
+		return { _view, _size };
+	}
+};
+
+platform::mapped_file_ptr platform::map_file(const df::file_path path)
+{
+	const auto path_w = to_file_system_path(path);
+	auto* const file = CreateFile(path_w.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+	if (INVALID_HANDLE_VALUE == file)
+	{
+		return {};
+	}
+
+	LARGE_INTEGER size = {};
+	platform::mapped_file_ptr result;
+
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		auto* const mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping)
+		{
+			const auto* const view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+			if (view)
+			{
+				result = std::make_shared<mapped_file_impl>(mapping, view, static_cast<size_t>(size.QuadPart));
+			}
+			else
+			{
+				CloseHandle(mapping);
+			}
+		}
+	}
+
+	// the mapping keeps the file open
+	CloseHandle(file);
+	return result;
+}
+
 uint32_t platform::file_crc32(const df::file_path path)
 {
 	bool success = false;
@@ -3265,11 +3333,13 @@ uint32_t platform::file_crc32(const df::file_path path)
 		li.QuadPart = 0;
 		if (!GetFileSizeEx(hFile, &li))
 		{
+			CloseHandle(hFile);
 			return 0;
 		}
 
+		// large reads keep the disk streaming when hashing whole collections
 		const auto size = static_cast<uint64_t>(li.QuadPart);
-		const uint32_t max_chunk = df::two_fifty_six_k;
+		const uint32_t max_chunk = 4 * df::one_meg;
 		const auto buffer = df::unique_alloc<uint8_t>(max_chunk);
 
 		DWORD dwReadChunk = 0UL;
@@ -3278,7 +3348,7 @@ uint32_t platform::file_crc32(const df::file_path path)
 
 		do
 		{
-			const auto read_size = std::min(max_chunk, static_cast<uint32_t>(size));
+			const auto read_size = static_cast<uint32_t>(std::min(static_cast<uint64_t>(max_chunk), size - total_read));
 			if (ReadFile(hFile, buffer.get(), read_size, &dwReadChunk, nullptr))
 			{
 				result = crypto::crc32c(result, buffer.get(), dwReadChunk);
@@ -3297,6 +3367,50 @@ uint32_t platform::file_crc32(const df::file_path path)
 	return success ? ~result : 0;
 }
 
+uint32_t platform::file_head_tail_crc32(const df::file_path path, const uint32_t span)
+{
+	bool success = false;
+	uint32_t result = crypto::CRCINIT;
+
+	const auto path_w = to_file_system_path(path);
+	auto* const hFile = CreateFile(path_w.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+	if (INVALID_HANDLE_VALUE != hFile)
+	{
+		LARGE_INTEGER li;
+		li.QuadPart = 0;
+
+		if (GetFileSizeEx(hFile, &li))
+		{
+			const auto size = static_cast<uint64_t>(li.QuadPart);
+			const auto head_size = static_cast<uint32_t>(std::min(static_cast<uint64_t>(span), size));
+			const auto tail_size = static_cast<uint32_t>(std::min(static_cast<uint64_t>(span), size - head_size));
+			const auto buffer = df::unique_alloc<uint8_t>(std::max(head_size, 1u));
+
+			// the size is part of the hash so files that only share a head and tail differ
+			result = crypto::crc32c(result, &size, sizeof(size));
+
+			DWORD read = 0;
+			success = ReadFile(hFile, buffer.get(), head_size, &read, nullptr) && read == head_size;
+			if (success) result = crypto::crc32c(result, buffer.get(), read);
+
+			if (success && tail_size > 0)
+			{
+				LARGE_INTEGER pos;
+				pos.QuadPart = static_cast<int64_t>(size - tail_size);
+				success = SetFilePointerEx(hFile, pos, nullptr, FILE_BEGIN) &&
+					ReadFile(hFile, buffer.get(), tail_size, &read, nullptr) && read == tail_size;
+				if (success) result = crypto::crc32c(result, buffer.get(), read);
+			}
+		}
+
+		CloseHandle(hFile);
+	}
+
+	return success ? ~result : 0;
+}
+
 bool platform::eject(const df::folder_path path)
 {
 	ULONG returned = 0, res = 0;
@@ -4858,6 +4972,374 @@ void platform::thread_event::set() const noexcept
 	SetEvent(std::any_cast<HANDLE>(_h));
 }
 
+struct platform::work_pool::job
+{
+	struct slice
+	{
+		alignas(64) std::atomic<size_t> next = 0;
+		size_t end = 0;
+	};
+
+	const range_func& f;
+	const df::cancel_token& token;
+	size_t chunk_size = 1;
+	size_t worker_count = 1;
+	std::unique_ptr<slice[]> slices;
+	std::atomic<size_t> pending = 0;
+	thread_event done{ false, false };
+
+	void run(const size_t worker)
+	{
+		// own slice first, then steal from the others
+		for (size_t i = 0; i < worker_count; ++i)
+		{
+			auto& s = slices[(worker + i) % worker_count];
+
+			while (!token.is_cancelled())
+			{
+				const auto begin = s.next.fetch_add(chunk_size);
+				if (begin >= s.end) break;
+
+				try
+				{
+					f(worker, begin, std::min(begin + chunk_size, s.end));
+				}
+				catch (std::exception& e)
+				{
+					df::log(__FUNCTION__, e.what());
+				}
+			}
+		}
+
+		if (--pending == 0)
+		{
+			done.set();
+		}
+	}
+};
+
+platform::work_pool::work_pool(const size_t thread_count) : _thread_count(thread_count)
+{
+}
+
+platform::work_pool::~work_pool()
+{
+	std::vector<std::thread> threads;
+
+	{
+		exclusive_lock lock(_rw);
+		_stop = true;
+		for (const auto& e : _wake) e->set();
+		std::swap(threads, _threads);
+	}
+
+	for (auto&& t : threads) t.join();
+}
+
+void platform::work_pool::start_threads()
+{
+	exclusive_lock lock(_rw);
+
+	if (_threads.empty())
+	{
+		for (size_t i = 0; i < _thread_count; ++i)
+		{
+			_wake.emplace_back(std::make_unique<thread_event>(false, false));
+		}
+
+		for (size_t i = 0; i < _thread_count; ++i)
+		{
+			_threads.emplace_back([this, i] { run_worker(i + 1); });
+		}
+	}
+}
+
+void platform::work_pool::run_worker(const size_t worker)
+{
+	set_thread_description(u8"work_pool"sv);
+	thread_init init;
+
+	thread_event* wake = nullptr;
+
+	{
+		exclusive_lock lock(_rw);
+		wake = _wake[worker - 1].get();
+	}
+
+	while (!_stop)
+	{
+		wait_for({ *wake }, 0, false);
+
+		auto* const j = _job.load();
+
+		if (j && worker < j->worker_count)
+		{
+			j->run(worker);
+		}
+	}
+}
+
+void platform::work_pool::parallel_for(const size_t count, size_t chunk_size, const range_func& f,
+	const size_t max_workers, const df::cancel_token& token)
+{
+	if (count == 0)
+		return;
+
+	chunk_size = std::max(chunk_size, 1_z);
+	auto workers = std::min(worker_count(), (count + chunk_size - 1) / chunk_size);
+	if (max_workers) workers = std::min(workers, max_workers);
+
+	if (workers <= 1 || _busy.exchange(true))
+	{
+		for (size_t begin = 0; begin < count && !token.is_cancelled(); begin += chunk_size)
+		{
+			f(0, begin, std::min(begin + chunk_size, count));
+		}
+
+		return;
+	}
+
+	start_threads();
+
+	job j{ f, token, chunk_size, workers };
+	j.slices = std::make_unique<job::slice[]>(workers);
+	j.pending = workers;
+
+	for (size_t w = 0; w < workers; ++w)
+	{
+		j.slices[w].next = count * w / workers;
+		j.slices[w].end = count * (w + 1) / workers;
+	}
+
+	_job = &j;
+
+	{
+		exclusive_lock lock(_rw);
+		for (size_t w = 1; w < workers; ++w) _wake[w - 1]->set();
+	}
+
+	j.run(0);
+
+	// whoever finishes last signals done
+	wait_for({ j.done }, 0, false);
+
+	_job = nullptr;
+	_busy = false;
+}
+
+platform::work_pool& platform::default_work_pool()
+{
+	static work_pool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+	return pool;
+}
+
+platform::executor::executor(const size_t thread_count) : _thread_count(std::max(thread_count, 1_z))
+{
+}
+
+platform::executor::~executor()
+{
+	stop();
+}
+
+static uint64_t executor_now_us()
+{
+	return static_cast<uint64_t>(df::now() * 1000000.0);
+}
+
+size_t platform::executor::add_lane(const std::u8string_view name, const priority pri, const bool paused)
+{
+	exclusive_lock lock(_rw);
+	lane l;
+	l.stats.name = name;
+	l.stats.pri = pri;
+	l.paused = paused;
+	_lanes.emplace_back(std::move(l));
+	return _lanes.size() - 1;
+}
+
+void platform::executor::resume(const size_t lane_index)
+{
+	exclusive_lock lock(_rw);
+	auto& l = _lanes[lane_index];
+
+	if (l.paused)
+	{
+		l.paused = false;
+		if (!l.tasks.empty()) wake_one();
+	}
+}
+
+void platform::executor::enqueue(const size_t lane_index, task_t f)
+{
+	const auto now = executor_now_us();
+	exclusive_lock lock(_rw);
+	auto& l = _lanes[lane_index];
+	l.tasks.emplace_back(queued_task{ std::move(f), now });
+	l.stats.max_depth = std::max(l.stats.max_depth, l.tasks.size());
+	wake_one();
+}
+
+void platform::executor::reset_and_enqueue(const size_t lane_index, task_t f)
+{
+	const auto now = executor_now_us();
+	exclusive_lock lock(_rw);
+	auto& l = _lanes[lane_index];
+	l.stats.coalesced += l.tasks.size();
+	l.tasks.clear();
+	l.tasks.emplace_back(queued_task{ std::move(f), now });
+	l.stats.max_depth = std::max(l.stats.max_depth, l.tasks.size());
+	wake_one();
+}
+
+std::vector<platform::executor::lane_stats> platform::executor::stats() const
+{
+	std::vector<lane_stats> result;
+	shared_lock lock(_rw);
+	result.reserve(_lanes.size());
+
+	for (const auto& l : _lanes)
+	{
+		auto& s = result.emplace_back(l.stats);
+		s.depth = l.tasks.size();
+	}
+
+	return result;
+}
+
+void platform::executor::wake_one()
+{
+	// caller holds _rw
+	if (!_idle.empty())
+	{
+		const auto worker = _idle.back();
+		_idle.pop_back();
+		_wake[worker]->set();
+	}
+}
+
+bool platform::executor::take(size_t& lane_index, queued_task& result)
+{
+	// caller holds _rw
+	const auto background_limit = _thread_count > 1 ? _thread_count - 1 : 1;
+	const auto lane_count = _lanes.size();
+
+	for (const auto pri : { priority::interactive, priority::normal, priority::background })
+	{
+		if (pri == priority::background && _running_background >= background_limit)
+		{
+			break;
+		}
+
+		// rotate the starting lane so lanes of the same priority take turns
+		for (size_t i = 0; i < lane_count; ++i)
+		{
+			const auto n = (_next_lane + i) % lane_count;
+			auto& l = _lanes[n];
+
+			if (l.stats.pri == pri && !l.paused && !l.running && !l.tasks.empty())
+			{
+				result = std::move(l.tasks.front());
+				l.tasks.pop_front();
+				l.running = true;
+				if (pri == priority::background) ++_running_background;
+				lane_index = n;
+				_next_lane = n + 1;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void platform::executor::start()
+{
+	exclusive_lock lock(_rw);
+
+	if (_threads.empty())
+	{
+		for (size_t i = 0; i < _thread_count; ++i)
+		{
+			_wake.emplace_back(std::make_unique<thread_event>(false, false));
+		}
+
+		for (size_t i = 0; i < _thread_count; ++i)
+		{
+			_threads.emplace_back([this, i] { run_worker(i); });
+		}
+	}
+}
+
+void platform::executor::stop()
+{
+	std::vector<std::thread> threads;
+
+	{
+		exclusive_lock lock(_rw);
+		_stop = true;
+		for (const auto& e : _wake) e->set();
+		std::swap(threads, _threads);
+	}
+
+	for (auto&& t : threads) t.join();
+}
+
+void platform::executor::run_worker(const size_t worker)
+{
+	set_thread_description(u8"executor"sv);
+	thread_init init;
+
+	thread_event* wake = nullptr;
+
+	{
+		exclusive_lock lock(_rw);
+		wake = _wake[worker].get();
+	}
+
+	const std::vector<std::reference_wrapper<thread_event>> events = { *wake, event_exit };
+
+	while (!_stop && !df::is_closing)
+	{
+		size_t lane_index = 0;
+		queued_task task;
+		bool found;
+
+		{
+			exclusive_lock lock(_rw);
+			found = take(lane_index, task);
+			if (!found) _idle.emplace_back(worker);
+		}
+
+		if (!found)
+		{
+			wait_for(events, 0, false);
+			continue;
+		}
+
+		const auto start_us = executor_now_us();
+
+		try
+		{
+			df::scope_locked_inc l(df::jobs_running);
+			if (task.f) task.f();
+		}
+		catch (std::exception& e)
+		{
+			df::log(__FUNCTION__, e.what());
+		}
+
+		const auto end_us = executor_now_us();
+		exclusive_lock lock(_rw);
+		auto& l = _lanes[lane_index];
+		l.running = false;
+		l.stats.completed += 1;
+		l.stats.wait.record(start_us - std::min(start_us, task.queued_us));
+		l.stats.run.record(end_us - std::min(end_us, start_us));
+		if (l.stats.pri == priority::background) --_running_background;
+	}
+}
+
 
 bool platform::is_valid_file_name(const std::u8string_view name)
 {
@@ -8,6 +8,7 @@
 // This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY
 
 #include "pch.h"
+#include "util.h"
 
 
 class spline_interpolator : public df::no_copy
@@ -152,9 +153,11 @@ void ui::color_adjust::color_params(const double vibrance, const double saturati
 	{
 		_curve[i] = static_cast<float>(interpolator.interpolate(i / static_cast<double>(curve_len)));
 	}
+
+	build_lut();
 }
 
-ui::color32 ui::color_adjust::adjust_color(double y, double u, double v, double a) const
+void ui::color_adjust::adjust_color(double y, double u, double v, double& r, double& g, double& b) const
 {
 	y = _curve[std::clamp(static_cast<int>(y * curve_len), 0, curve_len - 1)];
 
@@ -177,26 +180,201 @@ ui::color32 ui::color_adjust::adjust_color(double y, double u, double v, double
 	u = std::clamp(u, -1.0, 1.0);
 	v = std::clamp(v, -1.0, 1.0);
 
-	const auto r = y + 1.140 * v;
-	const auto g = y - 0.396 * u - 0.581 * v;
-	const auto b = y + 2.029 * u;
+	r = y + 1.140 * v;
+	g = y - 0.396 * u - 0.581 * v;
+	b = y + 2.029 * u;
+}
+
+static void rgb_to_yuv(const double r, const double g, const double b, double& y, double& u, double& v)
+{
+	y = 0.299 * r + 0.587 * g + 0.114 * b;
+	u = -0.147 * r - 0.289 * g + 0.436 * b;
+	v = 0.615 * r - 0.515 * g - 0.100 * b;
+}
+
+// Lut channels are signed 16 bit values scaled by 8. They are left
+// unclamped (within [-1, 2]) so clipping happens after interpolation.
+static uint64_t lut_channel(const double c, const int shift)
+{
+	const auto i = std::clamp(static_cast<int>(std::floor(c * 255.0 * 8.0 + 0.5)), -255 * 8, 255 * 2 * 8);
+	return static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(i))) << shift;
+}
+
+void ui::color_adjust::build_lut()
+{
+	_lut.resize(lut_len * lut_len * lut_len);
+
+	// Surfaces are bgra so channel 2 is red. The last grid point lies just
+	// past 255 so that every byte value has a cell to interpolate in.
+	auto i = 0;
+
+	for (auto c2 = 0; c2 < lut_len; ++c2)
+	{
+		for (auto c1 = 0; c1 < lut_len; ++c1)
+		{
+			for (auto c0 = 0; c0 < lut_len; ++c0)
+			{
+				double y, u, v, r, g, b;
+				rgb_to_yuv((c2 << lut_shift) / 255.0, (c1 << lut_shift) / 255.0, (c0 << lut_shift) / 255.0, y, u, v);
+				adjust_color(y, u, v, r, g, b);
+				_lut[i++] = lut_channel(b, 0) | lut_channel(g, 16) | lut_channel(r, 32);
+			}
+		}
+	}
+}
+
+struct lut_sample
+{
+	const uint64_t* corners[4];
+	uint16_t weights[4];
+};
 
-	return saturate_rgba(b, g, r, a);
+// Tetrahedral interpolation: the cell is split into six tetrahedra along
+// its diagonal and the ordering of the fractions picks one. Only four
+// corners are needed per pixel and the weights always sum to 8.
+static lut_sample lut_tetrahedron(const uint64_t* lut, const ui::color32 c, const int len, const int shift)
+{
+	constexpr auto frac_mask = 7u;
+	constexpr auto one = 8;
+
+	const auto c0 = ui::get_r(c);
+	const auto c1 = ui::get_g(c);
+	const auto c2 = ui::get_b(c);
+	const int f0 = c0 & frac_mask;
+	const int f1 = c1 & frac_mask;
+	const int f2 = c2 & frac_mask;
+
+	const auto s0 = 1;
+	const auto s1 = len;
+	const auto s2 = len * len;
+	const auto* base = lut + ((c2 >> shift) * s2) + ((c1 >> shift) * s1) + (c0 >> shift);
+
+	lut_sample result;
+	result.corners[0] = base;
+	result.corners[3] = base + s0 + s1 + s2;
+
+	auto set = [&result](const int first, const int second, const int fa, const int fb, const int fc)
+	{
+		result.corners[1] = result.corners[0] + first;
+		result.corners[2] = result.corners[1] + second;
+		result.weights[0] = static_cast<uint16_t>(one - fa);
+		result.weights[1] = static_cast<uint16_t>(fa - fb);
+		result.weights[2] = static_cast<uint16_t>(fb - fc);
+		result.weights[3] = static_cast<uint16_t>(fc);
+	};
+
+	if (f0 >= f1)
+	{
+		if (f1 >= f2) set(s0, s1, f0, f1, f2);
+		else if (f0 >= f2) set(s0, s2, f0, f2, f1);
+		else set(s2, s0, f2, f0, f1);
+	}
+	else
+	{
+		if (f0 >= f2) set(s1, s0, f1, f0, f2);
+		else if (f1 >= f2) set(s1, s2, f1, f2, f0);
+		else set(s2, s1, f2, f1, f0);
+	}
+
+	return result;
+}
+
+static ui::color32 lut_interpolate(const lut_sample& sample, const ui::color32 src)
+{
+	int b = 0, g = 0, r = 0;
+
+	for (auto i = 0; i < 4; ++i)
+	{
+		const auto c = *sample.corners[i];
+		const int w = sample.weights[i];
+		b += w * static_cast<int16_t>(c & 0xffff);
+		g += w * static_cast<int16_t>((c >> 16) & 0xffff);
+		r += w * static_cast<int16_t>((c >> 32) & 0xffff);
+	}
+
+	return ui::saturate_rgba((b + 32) >> 6, (g + 32) >> 6, (r + 32) >> 6, 0) | (src & 0xff000000);
+}
+
+void ui::color_adjust::apply_lut(const color32* s, color32* d, const int cx) const
+{
+	const auto* lut = _lut.data();
+	const auto* const end = d + cx;
+
+#ifdef COMPILE_SIMD_INTRINSIC
+	if (platform::sse2_supported)
+	{
+		// Two pixels per register; each lane holds a 16 bit channel.
+		const auto round = _mm_set1_epi16(32);
+		const auto alpha_mask = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+		while (d + 2 <= end)
+		{
+			const auto a = lut_tetrahedron(lut, s[0], lut_len, lut_shift);
+			const auto b = lut_tetrahedron(lut, s[1], lut_len, lut_shift);
+			auto sum = _mm_setzero_si128();
+
+			for (auto i = 0; i < 4; ++i)
+			{
+				const auto corners = _mm_unpacklo_epi64(
+					_mm_loadl_epi64(std::bit_cast<const __m128i*>(a.corners[i])),
+					_mm_loadl_epi64(std::bit_cast<const __m128i*>(b.corners[i])));
+				const auto weights = _mm_unpacklo_epi64(
+					_mm_set1_epi16(static_cast<short>(a.weights[i])),
+					_mm_set1_epi16(static_cast<short>(b.weights[i])));
+				sum = _mm_add_epi16(sum, _mm_mullo_epi16(corners, weights));
+			}
+
+			sum = _mm_srai_epi16(_mm_add_epi16(sum, round), 6);
+
+			const auto alpha = _mm_and_si128(_mm_loadl_epi64(std::bit_cast<const __m128i*>(s)), alpha_mask);
+			_mm_storel_epi64(std::bit_cast<__m128i*>(d), _mm_or_si128(_mm_packus_epi16(sum, sum), alpha));
+
+			s += 2;
+			d += 2;
+		}
+	}
+#endif
+
+	while (d < end)
+	{
+		const auto c = *s++;
+		*d++ = lut_interpolate(lut_tetrahedron(lut, c, lut_len, lut_shift), c);
+	}
 }
 
 void ui::color_adjust::apply(const const_surface_ptr& src, uint8_t* dst, const size_t dst_stride,
 	df::cancel_token token) const
 {
+	if (_lut.empty())
+	{
+		apply_exact(src, dst, dst_stride, token);
+		return;
+	}
+
 	const auto dims = src->dimensions();
+	constexpr size_t rows_per_chunk = 16;
 
+	platform::default_work_pool().parallel_for(static_cast<size_t>(dims.cy), rows_per_chunk,
+		[&](size_t, const size_t begin, const size_t end)
+		{
+			for (auto yy = begin; yy < end; ++yy)
+			{
+				if (token.is_cancelled())
+				{
+					return;
+				}
+
+				const auto* s = std::bit_cast<const color32*>(src->pixels() + yy * src->stride());
+				auto* d = std::bit_cast<color32*>(dst + yy * dst_stride);
+				apply_lut(s, d, dims.cx);
+			}
+		});
+}
 
-	// TODO sse optimization of this
-	/*while(d < e)
-	{
-	__m128i src128 = _mm_loadu_si128(s);
-	// _mm_mul_ps
-	_mm_cvtps_epi32
-	}*/
+void ui::color_adjust::apply_exact(const const_surface_ptr& src, uint8_t* dst, const size_t dst_stride,
+	df::cancel_token token) const
+{
+	const auto dims = src->dimensions();
 
 	for (auto yy = 0; yy < dims.cy; ++yy)
 	{
@@ -207,16 +385,11 @@ void ui::color_adjust::apply(const const_surface_ptr& src, uint8_t* dst, const s
 		{
 			const auto c = *s++;
 
-			const auto r = get_b(c) / 255.0;
-			const auto g = get_g(c) / 255.0;
-			const auto b = get_r(c) / 255.0;
-			const auto a = get_a(c) / 255.0;
-
-			const auto y = 0.299 * r + 0.587 * g + 0.114 * b;
-			const auto u = -0.147 * r - 0.289 * g + 0.436 * b;
-			const auto v = 0.615 * r - 0.515 * g - 0.100 * b;
+			double y, u, v, r, g, b;
+			rgb_to_yuv(get_b(c) / 255.0, get_g(c) / 255.0, get_r(c) / 255.0, y, u, v);
+			adjust_color(y, u, v, r, g, b);
 
-			*d++ = adjust_color(y, u, v, a);
+			*d++ = (saturate_rgba(b, g, r, 1.0) & 0x00ffffff) | (c & 0xff000000);
 		}
 
 		if (token.is_cancelled())
@@ -79,4 +79,116 @@ ui::pixel_difference_result ui::surface::pixel_difference(const const_surface_pt
 	}
 
 	return pixel_difference_result::equal;
-}
\ No newline at end of file
+}
+
+// DCT perceptual hash: the luma is box filtered down to 32x32, transformed and
+// the 8x8 lowest frequencies are compared with their median. Resizing, re-encoding
+// and small colour changes only flip a few bits, so similar images are close in
+// Hamming distance. Returns 0 for surfaces that cannot be hashed.
+uint64_t ui::surface::perceptual_hash() const
+{
+	constexpr int grid = 32;
+	constexpr int freqs = 8;
+
+	if (empty() || (_format != texture_format::RGB && _format != texture_format::ARGB))
+	{
+		return 0;
+	}
+
+	static const auto cos_table = []
+		{
+			std::array<std::array<double, grid>, freqs> result = {};
+
+			for (int u = 0; u < freqs; ++u)
+			{
+				for (int x = 0; x < grid; ++x)
+				{
+					result[u][x] = cos(((2.0 * x) + 1.0) * u * M_PI / (2.0 * grid));
+				}
+			}
+
+			return result;
+		}();
+
+	std::array<std::array<double, grid>, grid> luma = {};
+
+	for (int gy = 0; gy < grid; ++gy)
+	{
+		const auto y0 = (gy * _dimensions.cy) / grid;
+		const auto y1 = std::max(y0 + 1, ((gy + 1) * _dimensions.cy) / grid);
+
+		for (int gx = 0; gx < grid; ++gx)
+		{
+			const auto x0 = (gx * _dimensions.cx) / grid;
+			const auto x1 = std::max(x0 + 1, ((gx + 1) * _dimensions.cx) / grid);
+			uint32_t sum = 0;
+
+			for (auto y = y0; y < y1; ++y)
+			{
+				const auto* const line = std::bit_cast<const color32*>(pixels_line(y));
+
+				for (auto x = x0; x < x1; ++x)
+				{
+					const auto c = line[x];
+					sum += (get_r(c) * 77) + (get_g(c) * 150) + (get_b(c) * 29);
+				}
+			}
+
+			luma[gy][gx] = sum / (256.0 * (y1 - y0) * (x1 - x0));
+		}
+	}
+
+	// separable transform, only the low frequencies are needed
+	std::array<std::array<double, freqs>, grid> rows = {};
+
+	for (int y = 0; y < grid; ++y)
+	{
+		for (int u = 0; u < freqs; ++u)
+		{
+			double sum = 0.0;
+			for (int x = 0; x < grid; ++x) sum += luma[y][x] * cos_table[u][x];
+			rows[y][u] = sum;
+		}
+	}
+
+	std::array<double, freqs * freqs> coefficients = {};
+
+	for (int v = 0; v < freqs; ++v)
+	{
+		for (int u = 0; u < freqs; ++u)
+		{
+			double sum = 0.0;
+			for (int y = 0; y < grid; ++y) sum += rows[y][u] * cos_table[v][y];
+			coefficients[(v * freqs) + u] = sum;
+		}
+	}
+
+	// flat images have no structure to hash, only rounding noise
+	double max_ac = 0.0;
+
+	for (size_t i = 1; i < coefficients.size(); ++i)
+	{
+		max_ac = std::max(max_ac, std::abs(coefficients[i]));
+	}
+
+	if (max_ac < (grid * grid) / 2.0)
+	{
+		return 0;
+	}
+
+	auto sorted = coefficients;
+	std::nth_element(sorted.begin(), sorted.begin() + (sorted.size() / 2), sorted.end());
+	const auto median = sorted[sorted.size() / 2];
+
+	uint64_t result = 0;
+
+	for (size_t i = 0; i < coefficients.size(); ++i)
+	{
+		if (coefficients[i] > median)
+		{
+			result |= 1ull << i;
+		}
+	}
+
+	return result;
+}
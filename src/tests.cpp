@@ -8,6 +8,9 @@
 // This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY
 
 #include "pch.h"
+
+#include <Sqlite3.h>
+
 #include "model.h"
 #include "model_db.h"
 #include "view_test.h"
@@ -821,6 +824,28 @@ static void should_scan_mp4()
 	assert_equal(false, loaded.success && is_valid(loaded.thumbnail_surface), u8"m4a load thumbnail"sv);
 }
 
+static void should_load_scaled_thumbnail()
+{
+	files ff;
+
+	for (const auto name : { u8"Test.jpg"sv, u8"Sony.JPG"sv, u8"IMG_9340.JPG"sv })
+	{
+		const auto path = test_files_folder.combine_file(name);
+		const auto scanned = ff_scan_file(ff, path);
+		const auto loaded = ff_scan_and_load_thumb(ff, path);
+
+		assert_equal(scanned.width, loaded.width, name);
+		assert_equal(scanned.height, loaded.height, name);
+		assert_equal(true, is_valid(loaded.thumbnail_surface) || is_valid(loaded.thumbnail_image), name);
+
+		if (is_valid(loaded.thumbnail_surface))
+		{
+			const auto extent = loaded.thumbnail_surface->dimensions();
+			assert_equal(true, extent.cx <= thumbnail_max_dimension.cx && extent.cy <= thumbnail_max_dimension.cy, name);
+		}
+	}
+}
+
 static void should_scan_mov()
 {
 	const auto load_path = test_files_folder.combine_file(u8"ipod.mov"sv);
@@ -1162,6 +1187,75 @@ static void should_update_gps_in_exif()
 	//AssertEqual(u8"-74.00611"sv, actual_xmp, Property::Longitude, u8"XMP"sv);
 }
 
+static void should_compare_cached_strings()
+{
+	const std::u8string_view words[] = {
+		u8"IMG_0001.jpg"sv, u8"img_0002.JPG"sv, u8"img_0001.jpg"sv, u8"IMG_00011.jpg"sv,
+		u8"Ärger"sv, u8"ärger.txt"sv, u8"Arger"sv, u8"\u212Aelvin"sv, u8"kelvin"sv,
+		u8"a"sv, u8"ab"sv, u8"AB"sv, u8"abc"sv, u8"zzzzzzzzzz"sv, u8"ZZZZZZZZZA"sv
+	};
+
+	const auto sign = [](const int n) { return (n > 0) - (n < 0); };
+
+	for (const auto l : words)
+	{
+		for (const auto r : words)
+		{
+			const auto cl = str::cache(l);
+			const auto cr = str::cache(r);
+			const auto expected = str::icmp(l, r);
+			const auto message = str::format(u8"{} {}"sv, l, r);
+
+			assert_equal(sign(expected), sign(str::icmp(cl, cr)), message);
+			assert_equal(expected == 0, str::iequals(cl, cr), message);
+			if (expected == 0) assert_equal(cl.folded_hash(), cr.folded_hash(), message);
+		}
+	}
+
+	const auto upper = df::file_path(u8"C:\\Photos\\Holiday\\IMG_0001.JPG"sv);
+	const auto lower = df::file_path(u8"c:\\photos\\holiday\\img_0001.jpg"sv);
+	assert_equal(true, upper == lower, u8"path equal"sv);
+	assert_equal(true, df::ieq{}(upper.folder(), lower.folder()), u8"folder equal"sv);
+	assert_equal(true, df::ihash{}(upper) == df::ihash{}(lower), u8"path hash"sv);
+	assert_equal(true, df::ihash{}(upper.folder()) == df::ihash{}(lower.folder()), u8"folder hash"sv);
+
+	constexpr auto path_count = 100000;
+	std::vector<df::file_path> paths;
+	std::vector<df::file_path> lookups;
+	df::dense_hash_map<df::file_path, int, df::ihash, df::ieq> index;
+
+	for (auto i = 0; i < path_count; ++i)
+	{
+		const auto folder = df::folder_path(str::format(u8"c:\\photos\\{}"sv, i / 100));
+		const auto path = folder.combine_file(str::format(u8"img_{}.jpg"sv, i));
+		index[path] = i;
+		paths.emplace_back(path);
+		lookups.emplace_back(df::file_path(str::to_upper(path.str())));
+	}
+
+	const auto time_lookups = [&index](const std::vector<df::file_path>& keys)
+	{
+		const auto start = df::now();
+		auto found = 0;
+
+		for (const auto& k : keys)
+		{
+			if (index.contains(k)) ++found;
+		}
+
+		const auto elapsed = std::max(df::now() - start, 0.000001);
+		return std::make_pair(found, static_cast<int64_t>(keys.size() / elapsed));
+	};
+
+	const auto [same_found, same_rate] = time_lookups(paths);
+	const auto [folded_found, folded_rate] = time_lookups(lookups);
+
+	df::trace(str::format(u8"Path lookups {} per second, case folded {} per second"sv, same_rate, folded_rate));
+
+	assert_equal(path_count, same_found, u8"same case lookups"sv);
+	assert_equal(path_count, folded_found, u8"case folded lookups"sv);
+}
+
 static void should_handle_international_characters()
 {
 	const auto save_path = _temps.next_path(u8".jpg"sv);
@@ -1388,6 +1482,221 @@ static void should_rotate_lossless()
 	assert_equal(expected->height, actual->height);
 }
 
+static void should_adjust_color_with_lut()
+{
+	constexpr auto cx = 2048;
+	constexpr auto cy = 1536;
+
+	auto src = std::make_shared<ui::surface>();
+	src->alloc(cx, cy, ui::texture_format::ARGB);
+
+	uint32_t seed = 12345;
+
+	for (auto y = 0; y < cy; ++y)
+	{
+		auto* line = std::bit_cast<ui::color32*>(src->pixels_line(y));
+
+		for (auto x = 0; x < cx; ++x)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			line[x] = seed;
+		}
+	}
+
+	ui::color_adjust adjust;
+	adjust.color_params(0.5, 0.3, 0.2, -0.1, 0.3, 0.4, 0.1);
+
+	const auto exact = std::make_shared<ui::surface>();
+	const auto fast = std::make_shared<ui::surface>();
+	exact->alloc(cx, cy, ui::texture_format::ARGB);
+	fast->alloc(cx, cy, ui::texture_format::ARGB);
+
+	const auto exact_start_ms = df::now_ms();
+	adjust.apply_exact(src, exact->pixels(), exact->stride(), test_token);
+	const auto exact_ms = df::now_ms() - exact_start_ms;
+
+	const auto fast_start_ms = df::now_ms();
+	adjust.apply(src, fast->pixels(), fast->stride(), test_token);
+	const auto fast_ms = df::now_ms() - fast_start_ms;
+
+	df::log(__FUNCTION__, str::format(u8"exact {} ms lut {} ms"sv, exact_ms, fast_ms));
+
+	uint32_t max_diff = 0;
+
+	for (auto y = 0; y < cy; ++y)
+	{
+		const auto* e = std::bit_cast<const ui::color32*>(exact->pixels_line(y));
+		const auto* f = std::bit_cast<const ui::color32*>(fast->pixels_line(y));
+
+		for (auto x = 0; x < cx; ++x)
+		{
+			assert_equal(ui::get_a(e[x]), ui::get_a(f[x]), u8"alpha"sv);
+			max_diff = std::max(max_diff, static_cast<uint32_t>(std::abs(static_cast<int>(ui::get_r(e[x])) - static_cast<int>(ui::get_r(f[x])))));
+			max_diff = std::max(max_diff, static_cast<uint32_t>(std::abs(static_cast<int>(ui::get_g(e[x])) - static_cast<int>(ui::get_g(f[x])))));
+			max_diff = std::max(max_diff, static_cast<uint32_t>(std::abs(static_cast<int>(ui::get_b(e[x])) - static_cast<int>(ui::get_b(f[x])))));
+		}
+	}
+
+	assert_equal(true, max_diff <= 4u, u8"lut max channel difference"sv);
+}
+
+static void should_evict_cached_thumbnails()
+{
+	const auto make_surface = []
+	{
+		auto result = std::make_shared<ui::surface>();
+		result->alloc(64, 64, ui::texture_format::ARGB);
+		return result;
+	};
+
+	const auto a = df::file_path(u8"c:\\thumbs\\a.jpg"sv);
+	const auto b = df::file_path(u8"c:\\thumbs\\b.jpg"sv);
+	const auto c = df::file_path(u8"c:\\thumbs\\c.jpg"sv);
+	const auto d = df::file_path(u8"c:\\thumbs\\d.jpg"sv);
+	const auto timestamp = platform::now();
+	const auto surface_bytes = make_surface()->size();
+
+	df::thumbnail_surface_cache cache(surface_bytes * 3);
+	cache.insert(a, timestamp, false, make_surface());
+	cache.insert(b, timestamp, false, make_surface());
+	cache.insert(c, timestamp, false, make_surface());
+
+	assert_equal(true, cache.find(a, timestamp, false) != nullptr, u8"hit"sv);
+	assert_equal(true, cache.find(a, df::date_t::null, false) == nullptr, u8"older thumbnail"sv);
+	assert_equal(true, cache.find(a, timestamp, true) == nullptr, u8"cover art"sv);
+
+	// a was used since the last sweep so the hand passes it and takes b
+	cache.insert(d, timestamp, false, make_surface());
+	assert_equal(true, cache.find(a, timestamp, false) != nullptr, u8"referenced kept"sv);
+	assert_equal(true, cache.find(b, timestamp, false) == nullptr, u8"unreferenced evicted"sv);
+	assert_equal(true, cache.find(d, timestamp, false) != nullptr, u8"inserted"sv);
+
+	cache.erase(c);
+	assert_equal(true, cache.find(c, timestamp, false) == nullptr, u8"erased"sv);
+
+	const auto stats = cache.stats();
+	assert_equal(static_cast<uint64_t>(1), stats.evictions, u8"evictions"sv);
+	assert_equal(static_cast<uint64_t>(3), stats.hits, u8"hits"sv);
+	assert_equal(static_cast<uint64_t>(2), static_cast<uint64_t>(stats.count), u8"count"sv);
+	assert_equal(true, stats.bytes <= stats.budget, u8"within budget"sv);
+
+	// the thumbnail and cover art of one file are cached side by side
+	df::thumbnail_surface_cache both(surface_bytes * 3);
+	both.insert(a, timestamp, false, make_surface());
+	both.insert(a, timestamp, true, make_surface());
+
+	assert_equal(true, both.find(a, timestamp, false) != nullptr, u8"thumbnail kept"sv);
+	assert_equal(true, both.find(a, timestamp, true) != nullptr, u8"cover art kept"sv);
+	assert_equal(2_z, both.stats().count, u8"both counted"sv);
+
+	both.erase(a);
+	assert_equal(true, both.find(a, timestamp, false) == nullptr, u8"thumbnail erased"sv);
+	assert_equal(true, both.find(a, timestamp, true) == nullptr, u8"cover art erased"sv);
+	assert_equal(0_z, both.stats().count, u8"none left"sv);
+}
+
+static void should_find_similar_images()
+{
+	auto make_picture = [](const int cx, const int cy, const bool mirror, uint32_t noise)
+		{
+			auto result = std::make_shared<ui::surface>();
+			result->alloc(cx, cy, ui::texture_format::ARGB);
+
+			for (auto y = 0; y < cy; ++y)
+			{
+				auto* line = std::bit_cast<ui::color32*>(result->pixels_line(y));
+				const auto v = static_cast<double>(y) / cy;
+
+				for (auto x = 0; x < cx; ++x)
+				{
+					const auto u = mirror ? 1.0 - (static_cast<double>(x) / cx) : static_cast<double>(x) / cx;
+					const auto d = ((u - 0.3) * (u - 0.3)) + ((v - 0.6) * (v - 0.6));
+					auto jitter = 0;
+
+					if (noise)
+					{
+						noise = noise * 1664525u + 1013904223u;
+						jitter = static_cast<int>(noise >> 29) - 4;
+					}
+
+					const auto r = 128.0 + 100.0 * sin((u * 7.0) + (v * 3.0)) + jitter;
+					const auto g = 255.0 * v * u + jitter;
+					const auto b = (d < 0.04 ? 230.0 : 40.0) + jitter;
+					line[x] = ui::rgba(static_cast<uint32_t>(std::clamp(r, 0.0, 255.0)),
+						static_cast<uint32_t>(std::clamp(g, 0.0, 255.0)),
+						static_cast<uint32_t>(std::clamp(b, 0.0, 255.0)), 255);
+				}
+			}
+
+			return result;
+		};
+
+	const auto original = make_picture(320, 240, false, 0)->perceptual_hash();
+	const auto resized = make_picture(113, 85, false, 0)->perceptual_hash();
+	const auto reencoded = make_picture(320, 240, false, 777)->perceptual_hash();
+	const auto mirrored = make_picture(320, 240, true, 0)->perceptual_hash();
+
+	auto flat = std::make_shared<ui::surface>();
+	flat->alloc(64, 64, ui::texture_format::ARGB);
+	flat->clear(ui::rgba(80, 80, 80, 255));
+
+	assert_equal(true, original != 0, u8"hashed"sv);
+	assert_equal(true, ui::perceptual_distance(original, resized) <= similar_phash_distance, u8"resized"sv);
+	assert_equal(true, ui::perceptual_distance(original, reencoded) <= similar_phash_distance, u8"reencoded"sv);
+	assert_equal(true, ui::perceptual_distance(original, mirrored) > similar_phash_distance, u8"mirrored"sv);
+	assert_equal(uint64_t{ 0 }, flat->perceptual_hash(), u8"flat"sv);
+
+	// the band index must find exactly what a linear scan finds
+	auto columns = std::make_shared<df::index_columns>();
+	uint64_t seed = 0x9e3779b97f4a7c15ull;
+
+	auto next = [&seed]
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			return seed;
+		};
+
+	for (auto i = 0; i < 20000; ++i)
+	{
+		auto h = next();
+
+		// some rows are near copies of an earlier row
+		if (i > 100 && (h % 4) == 0)
+		{
+			h = columns->phash[h % 100] ^ (1ull << (h % 64)) ^ (1ull << ((h >> 8) % 64));
+		}
+
+		columns->phash.emplace_back((i % 50) == 0 ? 0 : h);
+	}
+
+	phash_index index;
+	index.build(columns);
+
+	for (auto q = 0; q < 100; ++q)
+	{
+		const auto hash = columns->phash[q] ? columns->phash[q] : next();
+
+		for (const auto distance : { 0, 4, similar_phash_distance, 13 })
+		{
+			std::vector<uint32_t> expected;
+
+			for (uint32_t row = 0; row < columns->phash.size(); ++row)
+			{
+				if (columns->phash[row] && ui::perceptual_distance(columns->phash[row], hash) <= distance)
+				{
+					expected.emplace_back(row);
+				}
+			}
+
+			const auto found = index.find(hash, distance);
+			assert_equal(static_cast<uint32_t>(expected.size()), static_cast<uint32_t>(found.size()), u8"similar count"sv);
+			assert_equal(true, expected == found, u8"similar rows"sv);
+		}
+	}
+}
+
 static void should_resize()
 {
 	const auto save_path = _temps.next_path();
@@ -1453,6 +1762,37 @@ static void should_store_thumbnails()
 	assert_equal(i->thumbnail(), thumb.thumb, u8"local loaded thumb"sv);
 }
 
+static void should_compact_thumbnail_store()
+{
+	const auto index_path = _temps.next_path();
+	const auto file_path = test_files_folder.combine_file(u8"Test.jpg"sv);
+
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+
+	database db(index);
+	db.open(index_path.folder(), index_path.file_name_without_extension());
+
+	auto i = load_item(index, file_path, true);
+	db.perform_writes();
+
+	// a second record for the same path replaces the first
+	std::deque<item_db_write> writes;
+	item_db_write w;
+	w.path = file_path;
+	w.thumb = i->thumbnail();
+	w.thumb_scanned = df::date_t(2020, 1, 1);
+	writes.emplace_back(std::move(w));
+	db.perform_writes(std::move(writes));
+
+	db.maintenance(false);
+
+	const auto thumb = db.load_thumbnail(i->path());
+	assert_equal(i->thumbnail(), thumb.thumb, u8"thumb after compaction"sv);
+	assert_equal(df::date_t(2020, 1, 1), thumb.last_indexed, u8"latest thumb record"sv);
+}
+
 static void should_store_cover_art()
 {
 	const auto index_path = _temps.next_path();
@@ -1523,6 +1863,116 @@ static void should_store_item_properties()
 }
 
 
+static void should_load_items_before_phash_column()
+{
+	const auto index_path = _temps.next_path();
+	const auto file_path = test_files_folder.combine_file(u8"Test.jpg"sv);
+	const auto folder = index_path.folder();
+	const auto name = index_path.file_name_without_extension();
+
+	{
+		null_async_strategy as;
+		location_cache locations;
+		index_state index(as, locations);
+		database db(index);
+		db.open(folder, name);
+
+		auto md = std::make_shared<prop::item_metadata>();
+		md->album = u8"older"_c;
+
+		std::deque<item_db_write> writes;
+		item_db_write w;
+		w.path = file_path;
+		w.md = md;
+		w.crc32c = 1234;
+		writes.emplace_back(std::move(w));
+		db.perform_writes(std::move(writes));
+		db.close();
+	}
+
+	// rebuild item_properties as older versions created it, without phash
+	sqlite3* raw = nullptr;
+	const auto db_path = df::file_path(folder, name, u8".db"sv);
+	assert_equal(SQLITE_OK, sqlite3_open(std::bit_cast<const char*>(db_path.str().c_str()), &raw), u8"open raw"sv);
+	assert_equal(SQLITE_OK, sqlite3_exec(raw,
+		"CREATE TABLE older AS SELECT folder, name, properties, hash, media_position, flag, crc, last_scanned, last_indexed FROM item_properties;"
+		"DROP TABLE item_properties;"
+		"ALTER TABLE older RENAME TO item_properties;", nullptr, nullptr, nullptr), u8"drop phash"sv);
+	sqlite3_close(raw);
+
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	database db(index);
+	db.open(folder, name);
+
+	const auto item = index.find_item(file_path);
+	const auto md = item.metadata.load();
+	assert_equal(true, md != nullptr, u8"row loaded"sv);
+	assert_equal(u8"older"sv, md->album, u8"album loaded"sv);
+	assert_equal(1234u, item.crc32c, u8"crc loaded"sv);
+}
+
+static void should_coalesce_item_writes()
+{
+	const auto index_path = _temps.next_path();
+	const auto file_path = test_files_folder.combine_file(u8"Test.jpg"sv);
+
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+
+	database db(index);
+	db.open(index_path.folder(), index_path.file_name_without_extension());
+
+	auto md = std::make_shared<prop::item_metadata>();
+	md->album = u8"first"_c;
+
+	auto md2 = std::make_shared<prop::item_metadata>();
+	md2->album = u8"second"_c;
+
+	std::deque<item_db_write> writes;
+
+	{
+		item_db_write w;
+		w.path = file_path;
+		w.md = md;
+		writes.emplace_back(std::move(w));
+	}
+	{
+		item_db_write w;
+		w.path = file_path;
+		w.md = md2;
+		w.metadata_scanned = df::date_t(2020, 1, 1);
+		writes.emplace_back(std::move(w));
+	}
+	{
+		item_db_write w;
+		w.path = file_path;
+		w.crc32c = 1234u;
+		writes.emplace_back(std::move(w));
+	}
+	{
+		item_db_write w;
+		w.path = file_path;
+		w.media_position = 42.0;
+		writes.emplace_back(std::move(w));
+	}
+
+	const auto statements = index.stats.write_statements;
+	db.perform_writes(std::move(writes));
+	assert_equal(1, index.stats.write_statements - statements, u8"one statement per path"sv);
+
+	db.load_index_values();
+
+	const auto item = index.find_item(file_path);
+	const auto item_md = item.metadata.load();
+
+	assert_equal(u8"second"sv, item_md->album, u8"last metadata wins"sv);
+	assert_equal(1234u, item.crc32c, u8"coalesced crc32"sv);
+	assert_equal(42, static_cast<int>(item_md->media_position), u8"coalesced media position"sv);
+}
+
 static void should_pack_item_properties()
 {
 	const auto file_path = test_files_folder.combine_file(u8"Test.jpg"sv);
@@ -1540,6 +1990,46 @@ static void should_pack_item_properties()
 
 	assert_metadata(*md, *unpacked, u8"index"sv);
 	assert_equal(md->orientation, unpacked->orientation, u8"index orientation"sv);
+
+	// only the numbers that differ from their defaults are written
+	const auto audio = std::make_shared<prop::item_metadata>();
+	audio->duration = 215;
+	audio->audio_channels = 2;
+	audio->year = 1999;
+	audio->track = df::xy8::make(3, 12);
+
+	metadata_packer audio_packer;
+	audio_packer.pack(audio);
+
+	const auto audio_numbers_size = sizeof(audio->duration) + sizeof(audio->audio_channels) + sizeof(audio->year) +
+		sizeof(audio->track.x) + sizeof(audio->track.y);
+	assert_equal(2_z + 8_z + 4_z + audio_numbers_size, audio_packer.size(), u8"sparse numbers"sv);
+
+	const auto unpacked_audio = std::make_shared<prop::item_metadata>();
+	metadata_unpacker audio_unpacker(audio_packer.cdata());
+	audio_unpacker.unpack(unpacked_audio);
+
+	assert_equal(audio->duration, unpacked_audio->duration, u8"audio duration"sv);
+	assert_equal(audio->audio_channels, unpacked_audio->audio_channels, u8"audio channels"sv);
+	assert_equal(audio->year, unpacked_audio->year, u8"audio year"sv);
+	assert_equal(audio->track, unpacked_audio->track, u8"audio track"sv);
+
+	// version 1 blobs are still readable
+	metadata_packer packer_v1;
+	packer_v1.reset_to_header(1);
+	packer_v1.write(prop::album.id, md->album);
+	packer_v1.write(prop::rating.id, md->rating);
+	packer_v1.write(prop::orientation.id, static_cast<uint8_t>(md->orientation));
+	packer_v1.write(prop::created_exif.id, md->created_exif.to_int64());
+
+	const auto unpacked_v1 = std::make_shared<prop::item_metadata>();
+	metadata_unpacker unpacker_v1(packer_v1.cdata());
+	unpacker_v1.unpack(unpacked_v1);
+
+	assert_equal(md->album, unpacked_v1->album, u8"v1 album"sv);
+	assert_equal(md->rating, unpacked_v1->rating, u8"v1 rating"sv);
+	assert_equal(md->orientation, unpacked_v1->orientation, u8"v1 orientation"sv);
+	assert_equal(md->created_exif, unpacked_v1->created_exif, u8"v1 created_exif"sv);
 }
 
 static void should_store_webservice_results()
@@ -2105,6 +2595,68 @@ static void should_select_items()
 	assert_equal(4_z, s.selected_count(), u8"invalid selection"sv);
 }
 
+static void should_group_and_sort_items()
+{
+	null_state_strategy ss;
+	null_async_strategy as;
+	view_host_base_ptr view;
+
+	location_cache locations;
+	index_state index(as, locations);
+	view_state s(ss, as, index, make_test_player());
+	s.view_mode(view_type::items);
+	s.open(view, df::search_t().add_selector(test_files_folder), {});
+	s.item_index.scan_items(s.search_items(), false, false, false, false, test_token);
+
+	const auto assert_grouped = [&s](const std::u8string_view message, const auto& in_order)
+		{
+			s.update_item_groups();
+
+			size_t count = 0;
+			const df::group_key* last_key = nullptr;
+
+			for (const auto& g : s.groups())
+			{
+				if (last_key) assert_equal(true, *last_key < g->_key, message);
+				last_key = &g->_key;
+
+				const auto& items = g->items();
+				count += items.size();
+
+				for (size_t n = 1; n < items.size(); ++n)
+				{
+					assert_equal(true, in_order(items[n - 1], items[n]), message);
+				}
+			}
+
+			assert_equal(static_cast<uint64_t>(s.display_items().size()), static_cast<uint64_t>(count), message);
+		};
+
+	s.group_order(group_by::size, sort_by::def);
+	assert_grouped(u8"size"sv, [](const df::item_element_ptr& l, const df::item_element_ptr& r)
+		{
+			if (l->file_size() != r->file_size()) return l->file_size() > r->file_size();
+			return icmp(l->name(), r->name()) <= 0;
+		});
+
+	s.group_order(group_by::file_type, sort_by::name);
+	assert_grouped(u8"name"sv, [](const df::item_element_ptr& l, const df::item_element_ptr& r)
+		{
+			return icmp(l->name(), r->name()) <= 0;
+		});
+
+	s.group_order(group_by::resolution, sort_by::def);
+	assert_grouped(u8"resolution"sv, [](const df::item_element_ptr& l, const df::item_element_ptr& r)
+		{
+			const auto lmd = l->metadata();
+			const auto rmd = r->metadata();
+			const auto ll = lmd ? ui::calc_mega_pixels(lmd->width, lmd->height) : 0;
+			const auto rr = rmd ? ui::calc_mega_pixels(rmd->width, rmd->height) : 0;
+			if (ll != rr) return ll > rr;
+			return icmp(l->name(), r->name()) <= 0;
+		});
+}
+
 static void should_toggle_rating()
 {
 	const df::file_path src_path1(test_files_folder, u8"Test.jpg"sv);
@@ -2585,16 +3137,163 @@ static void should_match_wildcard()
 	assert_equal(true, str::wildcard_icmp(u8"💉💎👦🏻👓⚡"sv, u8"💉*"sv));
 }
 
-static void should_detect_wildcard()
+static std::vector<std::pair<int, size_t>> normalized_code_points(const std::u8string_view s)
 {
-	assert_equal(false, str::is_wildcard(u8""sv));
-	assert_equal(false, str::is_wildcard(u8"abcdef"sv));
-	assert_equal(true, str::is_wildcard(u8"abc*"sv));
-	assert_equal(false, str::is_wildcard(u8"abc\\*"sv));
-	assert_equal(false, str::is_wildcard(u8"abc\\*ef"sv));
+	std::vector<std::pair<int, size_t>> result;
+	auto p = s.begin();
+
+	while (p < s.end())
+	{
+		const auto offset = static_cast<size_t>(p - s.begin());
+		result.emplace_back(str::normalze_for_compare(str::pop_utf8_char(p, s.end())), offset);
+	}
+
+	return result;
 }
 
-static void should_find_closest_location()
+// Code point at a time versions of str::ifind and str::wildcard_icmp
+static size_t scalar_ifind(const std::u8string_view text, const std::u8string_view sub_string)
+{
+	const auto t = normalized_code_points(text);
+	const auto w = normalized_code_points(sub_string);
+
+	for (size_t i = 0; !w.empty() && i + w.size() <= t.size(); ++i)
+	{
+		size_t j = 0;
+		while (j < w.size() && t[i + j].first == w[j].first) ++j;
+		if (j == w.size()) return t[i].second;
+	}
+
+	return std::u8string_view::npos;
+}
+
+static bool scalar_wildcard_icmp(const std::u8string_view text, const std::u8string_view wildcard)
+{
+	const auto t = normalized_code_points(text);
+	const auto w = normalized_code_points(wildcard);
+	auto post_last_wildcard = w.size();
+	size_t ti = 0;
+	size_t wi = 0;
+
+	while (true)
+	{
+		if (ti == t.size())
+		{
+			if (wi == w.size()) return true;
+			if (w[wi].first != '*') return false;
+			wi += 1;
+			continue;
+		}
+
+		if (wi == w.size()) return false;
+
+		if (t[ti].first != w[wi].first)
+		{
+			if (w[wi].first == '*')
+			{
+				wi += 1;
+				post_last_wildcard = wi;
+				if (wi == w.size()) return true;
+				continue;
+			}
+
+			if (post_last_wildcard == w.size()) return false;
+
+			if (post_last_wildcard != wi)
+			{
+				wi = post_last_wildcard;
+				if (t[ti].first == w[wi].first) wi += 1;
+			}
+
+			ti += 1;
+			continue;
+		}
+
+		ti += 1;
+		wi += 1;
+	}
+}
+
+static void should_match_ascii_text_with_simd()
+{
+	const std::u8string_view alphabet[] = {
+		u8"a"sv, u8"A"sv, u8"b"sv, u8"B"sv, u8"z"sv, u8"Z"sv, u8"0"sv, u8" "sv, u8"\t"sv,
+		u8"_"sv, u8"@"sv, u8"["sv, u8"*"sv, u8"é"sv, u8"É"sv, u8"e"sv
+	};
+
+	uint32_t seed = 12345;
+	const auto next = [&seed](const uint32_t n)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return (seed >> 8) % n;
+	};
+
+	const auto make_text = [&](const size_t len, const bool ascii)
+	{
+		std::u8string result;
+		const auto count = ascii ? std::size(alphabet) - 3 : std::size(alphabet);
+		for (size_t i = 0; i < len; ++i) result += alphabet[next(static_cast<uint32_t>(count))];
+		return result;
+	};
+
+	const auto sign = [](const int n) { return (n > 0) - (n < 0); };
+	const auto snowman = u8"☃"s; // leading non ASCII keeps icmp on the code point path
+
+	for (auto i = 0; i < 2000; ++i)
+	{
+		const auto ascii = next(4) != 0;
+		const auto l = make_text(1 + next(70), ascii);
+		auto r = next(3) ? str::to_upper(l) : make_text(1 + next(70), ascii);
+		if (ascii && next(2)) r[next(static_cast<uint32_t>(r.size()))] = u8'x';
+
+		const auto* const lb = std::bit_cast<const uint8_t*>(l.data());
+		const auto* const rb = std::bit_cast<const uint8_t*>(r.data());
+		const auto len = std::min(l.size(), r.size());
+		const auto fold_space = next(2) != 0;
+		const auto target = fold_ascii(static_cast<uint8_t>(r[0] & 0x7F), fold_space);
+		uint8_t lower_c[80];
+		uint8_t lower_simd[80];
+
+		const auto equal_c = ascii_fold_equal_c(lb, rb, len, fold_space);
+		const auto find_c = ascii_find_folded_c(lb, l.size(), target, fold_space);
+		const auto lower_len_c = ascii_lower_c(lower_c, lb, l.size());
+
+		if (platform::sse2_supported)
+		{
+			assert_equal(static_cast<uint64_t>(equal_c), static_cast<uint64_t>(ascii_fold_equal_sse2(lb, rb, len, fold_space)), u8"fold equal sse2"sv);
+			assert_equal(static_cast<uint64_t>(find_c), static_cast<uint64_t>(ascii_find_folded_sse2(lb, l.size(), target, fold_space)), u8"find folded sse2"sv);
+			assert_equal(static_cast<uint64_t>(lower_len_c), static_cast<uint64_t>(ascii_lower_sse2(lower_simd, lb, l.size())), u8"lower sse2"sv);
+			assert_equal(true, memcmp(lower_c, lower_simd, lower_len_c) == 0, u8"lower sse2 text"sv);
+		}
+
+		if (platform::neon_supported)
+		{
+			assert_equal(static_cast<uint64_t>(equal_c), static_cast<uint64_t>(ascii_fold_equal_arm(lb, rb, len, fold_space)), u8"fold equal neon"sv);
+			assert_equal(static_cast<uint64_t>(find_c), static_cast<uint64_t>(ascii_find_folded_arm(lb, l.size(), target, fold_space)), u8"find folded neon"sv);
+			assert_equal(static_cast<uint64_t>(lower_len_c), static_cast<uint64_t>(ascii_lower_arm(lower_simd, lb, l.size())), u8"lower neon"sv);
+			assert_equal(true, memcmp(lower_c, lower_simd, lower_len_c) == 0, u8"lower neon text"sv);
+		}
+
+		const auto sub = r.substr(next(static_cast<uint32_t>(r.size())), 1 + next(8));
+		const auto wildcard = next(2) ? str::replace(r, u8"A"sv, u8"*"sv) : u8"*"s + sub + u8"*"s;
+
+		assert_equal(sign(str::icmp(snowman + l, snowman + r)), sign(str::icmp(l, r)), l);
+		assert_equal(crypto::hash_gen(l).result(), crypto::fnv1a_i(l), l);
+		assert_equal(static_cast<uint64_t>(scalar_ifind(l, sub)), static_cast<uint64_t>(str::ifind(l, sub)), l);
+		assert_equal(scalar_wildcard_icmp(l, wildcard), str::wildcard_icmp(l, wildcard), l);
+	}
+}
+
+static void should_detect_wildcard()
+{
+	assert_equal(false, str::is_wildcard(u8""sv));
+	assert_equal(false, str::is_wildcard(u8"abcdef"sv));
+	assert_equal(true, str::is_wildcard(u8"abc*"sv));
+	assert_equal(false, str::is_wildcard(u8"abc\\*"sv));
+	assert_equal(false, str::is_wildcard(u8"abc\\*ef"sv));
+}
+
+static void should_find_closest_location()
 {
 	location_cache locations;
 	locations.load_index();
@@ -2631,6 +3330,53 @@ static void should_find_location()
 		locations.auto_complete(u8"king pru usa"sv, 8, default_location)[0].location.str(), u8"City"sv);
 }
 
+static void should_reuse_compiled_locations()
+{
+	location_cache compiled;
+	compiled.load_index();
+
+	// the second cache maps the file written by the first
+	location_cache mapped;
+	mapped.load_index();
+
+	const std::pair<double, double> coords[] = { { 51.5142, -0.0985 }, { -30.515, 151.665 }, { 39.913889, 116.391667 } };
+
+	for (const auto& [lat, lng] : coords)
+	{
+		assert_equal(compiled.find_closest(lat, lng).str(), mapped.find_closest(lat, lng).str(), u8"closest"sv);
+	}
+
+	assert_equal(u8"City of London"sv, mapped.find_by_id(2643741).place, u8"City"sv);
+}
+
+static void should_batch_reverse_geocode()
+{
+	location_cache locations;
+	locations.load_index();
+
+	// coordinates on the cache grid so batch and single lookups search the same point
+	const std::vector<gps_coordinate> coords = {
+		{ 51.514, -0.098 }, { -30.515, 151.665 }, {}, { 39.914, 116.392 }, { 51.514, -0.098 }
+	};
+
+	const auto places = locations.find_closest_places(coords);
+	assert_equal(coords.size(), places.size(), u8"count"sv);
+	assert_equal(0u, places[2].id, u8"invalid coordinate"sv);
+	assert_equal(places[0].id, places[4].id, u8"repeated coordinate"sv);
+
+	for (size_t i = 0; i < coords.size(); ++i)
+	{
+		if (coords[i].is_valid())
+		{
+			assert_equal(locations.find_closest(coords[i].latitude(), coords[i].longitude()).str(),
+				locations.find_by_id(places[i].id).str(), u8"closest"sv);
+		}
+	}
+
+	// second batch is answered from the cache
+	assert_equal(places[1].id, locations.find_closest_places(std::span(coords).subspan(1, 1)).front().id, u8"cached"sv);
+}
+
 static void should_detect_original_path()
 {
 	const df::file_path path(u8"c:\\temp\\test.original.jpg"sv);
@@ -2966,6 +3712,675 @@ static void should_detect_duplicates(shared_test_context& stc)
 	assert_equal(1u, index.find_item(sony_item->path()).duplicates.count, u8"duplicates"sv);
 }
 
+static void should_group_duplicate_chains()
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	const auto now = platform::now();
+
+	const auto add_folder = [&](const std::u8string_view name, const std::u8string_view file_name,
+		const uint32_t crc32c, const df::date_t created, const bool in_collection)
+		{
+			auto md = std::make_shared<prop::item_metadata>();
+			md->created_exif = created;
+
+			db_items_t items;
+			db_item_t item;
+			item.path = str::cache(file_name);
+			item.metadata = md;
+			item.crc32c = crc32c;
+			items.emplace_back(std::move(item));
+
+			const auto folder_path = test_files_folder.combine(name);
+			index.merge_folder(folder_path, items);
+			index.validate_folder(folder_path, false, now).folder->is_in_collection = in_collection;
+			return folder_path.combine_file(file_name);
+		};
+
+	// a~b share a crc and b~c share a name and created date, a and c share nothing
+	const auto a = add_folder(u8"chain_a"sv, u8"first.jpg"sv, 111, df::date_t(2001, 1, 1), true);
+	const auto b = add_folder(u8"chain_b"sv, u8"same.jpg"sv, 111, df::date_t(2002, 2, 2), true);
+	const auto c = add_folder(u8"chain_c"sv, u8"same.jpg"sv, 222, df::date_t(2002, 2, 2), true);
+	const auto d = add_folder(u8"chain_d"sv, u8"other.jpg"sv, 333, df::date_t(2003, 3, 3), true);
+	const auto e = add_folder(u8"chain_e"sv, u8"late.jpg"sv, 222, df::date_t(2004, 4, 4), false);
+
+	index.update_predictions();
+
+	const auto group = index.find_item(a).duplicates.group;
+	assert_equal(3u, index.find_item(a).duplicates.count, u8"chain count a"sv);
+	assert_equal(3u, index.find_item(c).duplicates.count, u8"chain count c"sv);
+	assert_equal(group, index.find_item(b).duplicates.group, u8"chain group b"sv);
+	assert_equal(group, index.find_item(c).duplicates.group, u8"chain group c"sv);
+	assert_equal(1u, index.find_item(d).duplicates.count, u8"unrelated"sv);
+
+	// joining the collection without a new columns snapshot still adds keys
+	index.validate_folder(e.folder(), false, now).folder->is_in_collection = true;
+	index.update_predictions();
+
+	assert_equal(4u, index.find_item(e).duplicates.count, u8"joined count"sv);
+	assert_equal(group, index.find_item(e).duplicates.group, u8"joined group"sv);
+}
+
+static void should_rebuild_columns_after_folder_changes()
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	const auto now = platform::now();
+
+	const auto merge = [&](const df::folder_path folder_path, const std::u8string_view file_name, const uint32_t crc32c)
+		{
+			db_items_t items;
+			db_item_t item;
+			item.path = str::cache(file_name);
+			item.metadata = std::make_shared<prop::item_metadata>();
+			item.crc32c = crc32c;
+			items.emplace_back(std::move(item));
+			index.merge_folder(folder_path, items);
+			index.validate_folder(folder_path, false, now);
+		};
+
+	const auto changed = test_files_folder.combine(u8"columns_changed"sv);
+	const auto unchanged = test_files_folder.combine(u8"columns_unchanged"sv);
+	merge(changed, u8"a.jpg"sv, 111);
+	merge(unchanged, u8"b.jpg"sv, 333);
+
+	const auto row_of = [](const df::index_columns& columns, const df::folder_path folder_path)
+		{
+			for (size_t f = 0; f < columns.folder_count(); ++f)
+			{
+				if (columns.folder_paths[f] == folder_path) return static_cast<size_t>(columns.first_row(f));
+			}
+
+			return columns.row_count();
+		};
+
+	const auto before = index.columns();
+	assert_equal(true, before == index.columns(), u8"unchanged snapshot reused"sv);
+
+	// merging a folder again updates its file nodes in place
+	merge(changed, u8"a.jpg"sv, 222);
+
+	const auto after = index.columns();
+	const auto before_row = row_of(*before, changed);
+	const auto after_row = row_of(*after, changed);
+	assert_equal(true, before != after, u8"new snapshot"sv);
+	assert_equal(111u, before->crc32c[before_row], u8"old snapshot keeps its copy"sv);
+	assert_equal(222u, after->crc32c[after_row], u8"new snapshot sees merge"sv);
+	assert_equal(true, before->items[before_row] == after->items[after_row], u8"row points at the live node"sv);
+	assert_equal(333u, after->crc32c[row_of(*after, unchanged)], u8"other folder copied"sv);
+
+	index.update_crc(changed.combine_file(u8"a.jpg"sv), 444);
+
+	const auto updated = index.columns();
+	assert_equal(true, after != updated, u8"snapshot after crc"sv);
+	assert_equal(444u, updated->crc32c[row_of(*updated, changed)], u8"new snapshot sees crc"sv);
+}
+
+static void should_update_presence(shared_test_context& stc)
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	auto cache_path = _temps.next_path();
+	database db(index);
+	db.open(cache_path.folder(), cache_path.file_name_without_extension());
+	build_index(index, db);
+
+	// a camera card style folder outside the collection
+	const auto card_folder = _temps.folder().combine(str::format(u8"card-{}"sv, platform::tick_count()));
+	const auto copied_path = df::file_path(card_folder, u8"Test.jpg"sv);
+	const auto missing_path = df::file_path(card_folder, u8"Missing.jpg"sv);
+	const auto card_only_path = df::file_path(card_folder, u8"CardOnly.jpg"sv);
+	assert_equal(true, platform::copy_file(df::file_path(test_files_folder, u8"Test.jpg"sv), copied_path, false, true).success(), u8"copy"sv);
+
+	std::vector<uint8_t> card_only_data(4096);
+	for (size_t i = 0; i < card_only_data.size(); ++i) card_only_data[i] = static_cast<uint8_t>(i * 13);
+	write_binary_file(card_only_path, card_only_data.data(), static_cast<int>(card_only_data.size()));
+
+	// browsing the card lists it in the index without joining the collection
+	index.scan_folder(card_folder, false, platform::now());
+	assert_equal(false, index.is_in_collection(card_folder), u8"card outside collection"sv);
+	index.update_predictions();
+
+	const auto indexed_item = std::make_shared<df::item_element>(df::file_path(test_files_folder, u8"Test.jpg"sv),
+		index.find_item(df::file_path(test_files_folder, u8"Test.jpg"sv)));
+	const auto copied_item = std::make_shared<df::item_element>(copied_path, index.find_item(copied_path));
+	const auto missing_item = std::make_shared<df::item_element>(missing_path, make_index_file_info(platform::now()));
+	const auto card_only_item = std::make_shared<df::item_element>(card_only_path, index.find_item(card_only_path));
+
+	index.scan_item(copied_item, false, false);
+	index.update_presence(df::item_set({ indexed_item, copied_item, missing_item, card_only_item }));
+
+	assert_equal(static_cast<int>(item_presence::this_in), static_cast<int>(indexed_item->presence()), u8"indexed"sv);
+	assert_equal(static_cast<int>(item_presence::similar_in), static_cast<int>(copied_item->presence()), u8"copied"sv);
+	assert_equal(static_cast<int>(item_presence::not_in), static_cast<int>(missing_item->presence()), u8"missing"sv);
+	assert_equal(static_cast<int>(item_presence::not_in), static_cast<int>(card_only_item->presence()), u8"card only"sv);
+
+	platform::delete_file(copied_path);
+	platform::delete_file(card_only_path);
+}
+
+static void should_clear_crc_of_modified_files()
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+
+	const auto folder = _temps.folder().combine(str::format(u8"edited-{}"sv, platform::tick_count()));
+	const auto path = df::file_path(folder, u8"Test.jpg"sv);
+	assert_equal(true, platform::copy_file(df::file_path(test_files_folder, u8"Test.jpg"sv), path, false, true).success(), u8"copy"sv);
+
+	const auto set_modified = [path](const df::date_t modified)
+		{
+			const auto f = platform::open_file(path, platform::file_open_mode::read_write);
+			assert_equal(true, f != nullptr, u8"open"sv);
+			f->set_modified(modified);
+		};
+
+	const auto now = platform::now();
+	set_modified(now - static_cast<int64_t>(df::date_t::intervals_per_day));
+	index.scan_folder(folder, true, now);
+
+	// a crc computed for the current content survives a rescan of the unchanged file
+	index.update_crc(path, 1234);
+	index.scan_folder(folder, true, platform::now());
+	assert_equal(true, index.find_item(path).crc32c != 0, u8"unchanged keeps crc"sv);
+
+	// after an edit the old crc no longer describes the file
+	index.update_crc(path, 1234);
+	set_modified(platform::now() + static_cast<int64_t>(df::date_t::intervals_per_day));
+	index.scan_folder(folder, true, platform::now());
+
+	const auto crc32c = index.find_item(path).crc32c;
+	assert_equal(true, crc32c != 1234, u8"edited drops old crc"sv);
+	assert_equal(true, crc32c == 0 || crc32c == platform::file_crc32(path), u8"edited crc is current or pending"sv);
+
+	platform::delete_file(path);
+}
+
+static void should_fingerprint_files(shared_test_context& stc)
+{
+	constexpr auto span = 64 * 1024;
+	constexpr auto size = 4 * span;
+
+	std::vector<uint8_t> data(size);
+	for (auto i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(i * 7);
+
+	const auto path1 = _temps.next_path(u8".bin"sv);
+	const auto path2 = _temps.next_path(u8".bin"sv);
+	const auto path3 = _temps.next_path(u8".bin"sv);
+
+	write_binary_file(path1, data.data(), size);
+	data[size / 2] ^= 0xff; // differs outside the head and tail
+	write_binary_file(path2, data.data(), size);
+	write_binary_file(path3, data.data(), size - 1);
+
+	const auto partial1 = platform::file_head_tail_crc32(path1, span);
+	assert_equal(true, partial1 != 0, u8"head tail crc"sv);
+	assert_equal(partial1, platform::file_head_tail_crc32(path2, span), u8"same head and tail"sv);
+	assert_equal(true, partial1 != platform::file_head_tail_crc32(path3, span), u8"different size"sv);
+	assert_equal(true, platform::file_crc32(path1) != platform::file_crc32(path2), u8"different middle"sv);
+
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	auto cache_path = _temps.next_path();
+	database db(index);
+	db.open(cache_path.folder(), cache_path.file_name_without_extension());
+	build_index(index, db);
+
+	const auto path = df::file_path(test_files_folder, u8"Test.jpg"sv);
+	index.fingerprint_files(test_token);
+
+	// a throttled pass returns and waits to be resumed instead of sleeping
+	while (index.stats.fingerprint_remaining > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		index.resume_fingerprint_files();
+	}
+
+	assert_equal(platform::file_crc32(path), index.find_item(path).crc32c, u8"fingerprinted crc"sv);
+	assert_equal(0, index.stats.fingerprint_remaining, u8"fingerprint remaining"sv);
+}
+
+static void build_synthetic_index(index_state& index, const int folder_count, const int files_per_folder)
+{
+	const auto now = platform::now();
+	std::vector<prop::item_metadata_ptr> samples;
+
+	for (int i = 0; i < 64; ++i)
+	{
+		auto md = std::make_shared<prop::item_metadata>();
+		md->created_exif = df::date_t(2000 + (i % 20), 1 + (i % 12), 1 + (i % 28));
+		md->rating = static_cast<int16_t>(i % 6);
+		md->tags = str::cache(str::format(u8"tag{}"sv, i % 16));
+		samples.emplace_back(md);
+	}
+
+	for (int f = 0; f < folder_count; ++f)
+	{
+		const auto folder_path = test_files_folder.combine(str::format(u8"synthetic{:05}"sv, f));
+		db_items_t items;
+		items.reserve(files_per_folder);
+
+		for (int i = 0; i < files_per_folder; ++i)
+		{
+			db_item_t item;
+			item.path = str::cache(str::format(u8"IMG_{:05}.jpg"sv, i));
+			item.metadata = samples[(f + i) % samples.size()];
+			items.emplace_back(std::move(item));
+		}
+
+		index.merge_folder(folder_path, items);
+		index.validate_folder(folder_path, false, now).folder->is_in_collection = true;
+	}
+}
+
+static void should_run_busy_work_pool_in_chunks()
+{
+	auto& pool = platform::default_work_pool();
+	std::atomic_int version = 0;
+	const df::cancel_token token(version);
+	std::vector<std::pair<size_t, size_t>> all_ranges;
+	std::vector<std::pair<size_t, size_t>> cancelled_ranges;
+
+	// the outer loop holds the pool so the inner loops take the busy fallback
+	pool.parallel_for(2, 1, [&](size_t, const size_t begin, size_t)
+		{
+			if (begin != 0) return;
+
+			pool.parallel_for(95, 10, [&](size_t, const size_t b, const size_t e)
+				{
+					all_ranges.emplace_back(b, e);
+				});
+
+			pool.parallel_for(95, 10, [&](size_t, const size_t b, const size_t e)
+				{
+					cancelled_ranges.emplace_back(b, e);
+					if (cancelled_ranges.size() == 3) ++version;
+				}, 0, token);
+		});
+
+	assert_equal(10_z, all_ranges.size(), u8"busy chunks"sv);
+	assert_equal(true, all_ranges.front() == std::make_pair(0_z, 10_z), u8"first chunk"sv);
+	assert_equal(true, all_ranges.back() == std::make_pair(90_z, 95_z), u8"last chunk"sv);
+	assert_equal(3_z, cancelled_ranges.size(), u8"cancelled between chunks"sv);
+}
+
+static void should_run_executor_lanes()
+{
+	using pri = platform::executor::priority;
+
+	platform::executor ex(4);
+	const auto serial = ex.add_lane(u8"serial"sv, pri::background);
+	const auto single = ex.add_lane(u8"single"sv, pri::interactive, true);
+
+	constexpr auto count = 200;
+	platform::thread_event serial_done(true, false);
+	platform::thread_event single_done(true, false);
+	std::atomic_int running = 0;
+	auto max_running = 0;
+	std::vector<int> order;
+	auto single_runs = 0;
+	auto last_single = -1;
+
+	for (auto i = 0; i < count; ++i)
+	{
+		ex.enqueue(serial, [&, i]
+			{
+				max_running = std::max(max_running, ++running);
+				order.emplace_back(i);
+				std::this_thread::yield();
+				--running;
+				if (i == count - 1) serial_done.set();
+			});
+	}
+
+	for (auto i = 0; i < 10; ++i)
+	{
+		ex.reset_and_enqueue(single, [&, i]
+			{
+				++single_runs;
+				last_single = i;
+				single_done.set();
+			});
+	}
+
+	ex.start();
+	platform::wait_for({ serial_done }, 5000, false);
+	ex.resume(single);
+	platform::wait_for({ single_done }, 5000, false);
+	ex.stop();
+
+	assert_equal(static_cast<size_t>(count), order.size(), u8"serial tasks run"sv);
+	assert_equal(true, std::ranges::is_sorted(order), u8"serial tasks in order"sv);
+	assert_equal(1, max_running, u8"one task per lane"sv);
+	assert_equal(1, single_runs, u8"pending single tasks coalesced"sv);
+	assert_equal(9, last_single, u8"latest single task kept"sv);
+
+	const auto stats = ex.stats();
+	assert_equal(static_cast<uint64_t>(count), stats[serial].completed, u8"serial completed"sv);
+	assert_equal(static_cast<uint64_t>(count), stats[serial].run.count, u8"serial run histogram"sv);
+	assert_equal(static_cast<size_t>(count), stats[serial].max_depth, u8"serial max depth"sv);
+	assert_equal(static_cast<uint64_t>(9), stats[single].coalesced, u8"single coalesced"sv);
+	assert_equal(true, stats[single].wait.percentile_us(0.5) <= stats[single].wait.max_us, u8"wait percentile"sv);
+	assert_equal(false, format_queue_stats(stats).empty(), u8"formatted stats"sv);
+}
+
+static void should_apply_backpressure_in_bounded_queue()
+{
+	constexpr auto count = 1000;
+	constexpr size_t capacity = 4;
+	platform::bounded_queue<int> q(capacity);
+	std::atomic_int64_t total = 0;
+	std::atomic_int popped = 0;
+	platform::threads consumers;
+
+	for (auto t = 0; t < 3; ++t)
+	{
+		consumers.start([&]
+			{
+				int v = 0;
+
+				while (q.pop(v))
+				{
+					total += v;
+					++popped;
+				}
+			});
+	}
+
+	auto pushed = 0;
+
+	for (auto i = 1; i <= count; ++i)
+	{
+		if (q.push(i)) ++pushed;
+		assert_equal(true, pushed - popped <= static_cast<int>(capacity) + 3, u8"queue bounded"sv);
+	}
+
+	q.close();
+	consumers.clear();
+
+	int v = 0;
+	assert_equal(count, popped.load(), u8"all items popped"sv);
+	assert_equal(static_cast<uint64_t>(count * (count + 1) / 2), static_cast<uint64_t>(total.load()), u8"items intact"sv);
+	assert_equal(false, q.push(1), u8"push after close"sv);
+	assert_equal(false, q.pop(v), u8"pop after close"sv);
+}
+
+static void should_walk_folders_concurrently()
+{
+	// a tree of 4 levels with 5 children under each node, ids are 1 + 5 * parent + child
+	constexpr auto fan_out = 5;
+	constexpr auto node_count = 1 + 5 + 25 + 125;
+	constexpr size_t max_in_flight = 4;
+
+	std::atomic_int in_flight = 0;
+	std::atomic_int peak = 0;
+	std::vector<int> visits(node_count, 0);
+
+	platform::walk_folders(std::vector<int>{0}, [&](const int node)
+		{
+			const auto n = ++in_flight;
+			auto p = peak.load();
+			while (n > p && !peak.compare_exchange_weak(p, n)) {}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			--in_flight;
+			return node;
+		},
+		[&](const int node, const int listed, std::vector<int>& pending)
+		{
+			visits[listed] += 1;
+
+			for (auto i = 0; i < fan_out; ++i)
+			{
+				const auto child = 1 + fan_out * node + i;
+				if (child < node_count) pending.emplace_back(child);
+			}
+		}, df::cancel_token(), max_in_flight);
+
+	assert_equal(node_count, static_cast<int>(std::ranges::count(visits, 1)), u8"each folder listed once"sv);
+	assert_equal(true, peak.load() <= static_cast<int>(max_in_flight), u8"listings bounded"sv);
+}
+
+static void should_scale_collection_queries(shared_test_context& stc)
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	build_synthetic_index(index, 4000, 250);
+
+	const auto searches = { u8"tag3"sv, u8"@photo"sv, u8"2012"sv };
+	const auto max_workers = platform::default_work_pool().worker_count();
+	std::vector<df::file_group_histogram> expected;
+
+	for (size_t workers = 1; workers <= max_workers; workers *= 2)
+	{
+		index.query_workers = workers;
+		size_t i = 0;
+
+		for (const auto& text : searches)
+		{
+			const auto search = df::search_t::parse(text);
+			const auto start_ms = df::now_ms();
+			const auto counts = index.count_matches(search, test_token);
+			const auto elapsed_ms = df::now_ms() - start_ms;
+
+			df::log(__FUNCTION__, str::format(u8"{} workers '{}' {} ms"sv, workers, text, elapsed_ms));
+
+			if (workers == 1) expected.emplace_back(counts);
+			else assert_equal(true, expected[i] == counts, u8"parallel counts"sv, text);
+			++i;
+		}
+	}
+
+	index.query_workers = 0;
+	assert_equal(static_cast<uint64_t>(1000000), expected[1].total_items().count, u8"synthetic photos"sv);
+}
+
+static void should_narrow_text_queries_like_full_scan()
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+
+	const auto names = { u8"alpha"sv, u8"bravo"sv, u8"charlie"sv, u8"delta"sv, u8"echo"sv, u8"foxtrot"sv };
+	const auto now = platform::now();
+	auto n = 0;
+
+	auto merge = [&](const int f, const std::u8string_view extra)
+		{
+			const auto folder_path = test_files_folder.combine(str::format(u8"narrow{:03}"sv, f));
+			db_items_t items;
+
+			for (int i = 0; i < 64; ++i)
+			{
+				auto md = std::make_shared<prop::item_metadata>();
+				md->title = str::cache(str::format(u8"{} w{} {}"sv, *(names.begin() + (n % names.size())), n, extra));
+				md->tags = str::cache(str::format(u8"tag{}"sv, n % 16));
+				md->width = static_cast<uint16_t>(640 + (n % 3));
+				md->height = 480;
+				++n;
+
+				db_item_t item;
+				item.path = str::cache(str::format(u8"IMG_{:05}.jpg"sv, i));
+				item.metadata = md;
+				items.emplace_back(std::move(item));
+			}
+
+			index.merge_folder(folder_path, items);
+			index.validate_folder(folder_path, false, now).folder->is_in_collection = true;
+		};
+
+	for (int f = 0; f < 16; ++f)
+	{
+		merge(f, {});
+	}
+
+	// replaced metadata moves words between postings
+	merge(0, u8"zulu"sv);
+	merge(1, u8"zulu"sv);
+
+	const auto searches = {
+		u8"alpha"sv, u8"lph"sv, u8"w123"sv, u8"ha"sv, u8"tag3 echo"sv, u8"tag:tag7"sv, u8"zulu"sv, u8"zul*"sv,
+		u8"641"sv, u8"nothing"sv
+	};
+
+	assert_equal(true, index.term_candidates(df::search_t::parse(u8"w123"sv)).is_constrained, u8"narrowed"sv);
+
+	for (const auto& text : searches)
+	{
+		const auto search = df::search_t::parse(text);
+
+		index.use_term_candidates = true;
+		const auto narrowed = index.count_matches(search, test_token);
+
+		index.use_term_candidates = false;
+		const auto scanned = index.count_matches(search, test_token);
+
+		assert_equal(true, narrowed == scanned, u8"narrowed counts"sv, text);
+	}
+
+	index.use_term_candidates = true;
+}
+
+static void should_update_summary_incrementally()
+{
+	null_async_strategy as;
+	location_cache locations;
+	index_state index(as, locations);
+	build_synthetic_index(index, 8, 16);
+	index.update_summary();
+
+	const auto folder_path = test_files_folder.combine(u8"synthetic00000"sv);
+
+	auto merge_tags = [&index, folder_path](const std::u8string_view tag)
+		{
+			db_items_t items;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				auto md = std::make_shared<prop::item_metadata>();
+				md->created_exif = df::date_t(2010, 1 + (i % 12), 1);
+				md->rating = static_cast<int16_t>(i % 3);
+				md->tags = str::cache(str::format(u8"{} tag{}"sv, tag, i % 4));
+				md->title = str::cache(str::format(u8"{} title"sv, tag));
+
+				db_item_t item;
+				item.path = str::cache(str::format(u8"IMG_{:05}.jpg"sv, i));
+				item.metadata = md;
+				items.emplace_back(std::move(item));
+			}
+
+			index.merge_folder(folder_path, items);
+		};
+
+	// the transient values are added and then removed by deltas only
+	merge_tags(u8"transient"sv);
+	merge_tags(u8"replaced"sv);
+
+	auto words_of = [](const df::dense_string_counts& words)
+		{
+			std::map<std::u8string, int> result;
+			for (const auto& w : words) result[std::u8string(w.first)] = w.second;
+			return result;
+		};
+
+	auto tags_of = [](const index_state::distinct_results& tags)
+		{
+			std::map<std::u8string, df::file_group_histogram> result;
+			for (const auto& t : tags) result[std::u8string(t.first)] = t.second;
+			return result;
+		};
+
+	const auto incremental_words = words_of(index.distinct_words());
+	const auto incremental_tags = tags_of(index.distinct_tags());
+	const auto incremental_ratings = index.distinct_ratings();
+	const auto incremental_file_types = index.file_types();
+
+	assert_equal(false, incremental_words.contains(u8"#transient"s), u8"removed tag word"sv);
+	assert_equal(false, incremental_words.contains(u8"transient"s), u8"removed title word"sv);
+	assert_equal(false, incremental_tags.contains(u8"transient"s), u8"removed tag"sv);
+	assert_equal(true, incremental_words.contains(u8"#replaced"s), u8"added tag word"sv);
+
+	index.update_summary();
+
+	assert_equal(true, words_of(index.distinct_words()) == incremental_words, u8"words match rebuild"sv);
+	assert_equal(true, tags_of(index.distinct_tags()) == incremental_tags, u8"tags match rebuild"sv);
+	assert_equal(true, index.distinct_ratings() == incremental_ratings, u8"ratings match rebuild"sv);
+	assert_equal(true, index.file_types() == incremental_file_types, u8"file types match rebuild"sv);
+}
+
+static void should_load_index_values_in_parallel(shared_test_context& stc)
+{
+	constexpr int folder_count = 500;
+	constexpr int files_per_folder = 200;
+
+	const auto index_path = _temps.next_path();
+	auto folder_path = [](const int f) { return test_files_folder.combine(str::format(u8"synthetic{:05}"sv, f)); };
+	auto file_name = [](const int i) { return str::format(u8"IMG_{:05}.jpg"sv, i); };
+
+	{
+		null_async_strategy as;
+		location_cache locations;
+		index_state index(as, locations);
+		database db(index);
+		db.open(index_path.folder(), index_path.file_name_without_extension());
+
+		std::deque<item_db_write> writes;
+
+		for (int f = 0; f < folder_count; ++f)
+		{
+			for (int i = 0; i < files_per_folder; ++i)
+			{
+				auto md = std::make_shared<prop::item_metadata>();
+				md->created_exif = df::date_t(2000 + (i % 20), 1 + (i % 12), 1 + (i % 28));
+				md->tags = str::cache(str::format(u8"tag{}"sv, (f + i) % 16));
+
+				item_db_write w;
+				w.path = df::file_path(folder_path(f), file_name(i));
+				w.md = md;
+				w.crc32c = static_cast<uint32_t>(f * files_per_folder + i + 1);
+				writes.emplace_back(std::move(w));
+			}
+		}
+
+		db.perform_writes(std::move(writes));
+		db.close();
+	}
+
+	const auto max_workers = platform::default_work_pool().worker_count();
+
+	for (size_t workers = 1; workers <= max_workers; workers *= 2)
+	{
+		null_async_strategy as;
+		location_cache locations;
+		index_state index(as, locations);
+		database db(index);
+		db.open(index_path.folder(), index_path.file_name_without_extension());
+		db.load_index_values(workers);
+
+		df::log(__FUNCTION__, str::format(u8"{} workers index_load_ms {}"sv, workers, index.stats.index_load_ms));
+
+		for (int f = 0; f < folder_count; f += 37)
+		{
+			for (int i = 0; i < files_per_folder; i += 53)
+			{
+				const auto item = index.find_item(df::file_path(folder_path(f), file_name(i)));
+				const auto md = item.metadata.load();
+
+				assert_equal(true, md != nullptr, u8"loaded metadata"sv);
+				assert_equal(static_cast<uint32_t>(f * files_per_folder + i + 1), item.crc32c, u8"loaded crc32c"sv);
+				assert_equal(str::format(u8"tag{}"sv, (f + i) % 16), md->tags, u8"loaded tags"sv);
+			}
+		}
+
+		db.close();
+	}
+}
+
 static void should_detect_rotation(shared_test_context& stc)
 {
 	files ff;
@@ -3107,6 +4522,12 @@ static void should_parse_command_line()
 	command_line_t cl5;
 	cl5.parse(u8"----- --no-gpu"sv);
 	assert_equal(true, cl5.no_gpu, u8"no_gpu"sv);
+
+	command_line_t cl6;
+	cl6.parse(u8"-no-gpu -queue-stats"sv);
+	assert_equal(true, cl6.no_gpu, u8"no_gpu with queue_stats"sv);
+	assert_equal(true, cl6.queue_stats, u8"queue_stats"sv);
+	assert_equal(u8" -no-gpu -queue-stats"sv, cl6.format_restart_cmd_line(), u8"restart cmd line"sv);
 }
 
 static void should_trim_strings()
@@ -3161,6 +4582,59 @@ static void should_find_text()
 }
 
 
+static void should_rank_auto_complete()
+{
+	auto_complete_index words;
+	words.build({
+		{u8"Beach"sv, 2, 0},
+		{u8"Bear"sv, 9, 0},
+		{u8"Berlin"sv, 5, 0},
+		{u8"Paris Beaches"sv, 7, 0},
+		{u8"Sunset"sv, 1, 0},
+	});
+
+	auto found = words.find(u8"Be"sv, 10);
+	assert_equal(3_z, found.size(), u8"prefix count"sv);
+	assert_equal(u8"Bear"sv, words.entries[found[0].entry].text);
+	assert_equal(u8"Berlin"sv, words.entries[found[1].entry].text);
+	assert_equal(u8"Beach"sv, words.entries[found[2].entry].text);
+	assert_equal(2_z, found[2].highlights[0].length, u8"prefix highlight"sv);
+
+	found = words.find(u8"be"sv, 2);
+	assert_equal(2_z, found.size(), u8"max results"sv);
+
+	found = words.find(u8"bea"sv, 10);
+	assert_equal(3_z, found.size(), u8"trigram count"sv);
+	assert_equal(u8"Bear"sv, words.entries[found[0].entry].text);
+	assert_equal(u8"Paris Beaches"sv, words.entries[found[1].entry].text);
+	assert_equal(6_z, found[1].highlights[0].offset, u8"trigram highlight"sv);
+	assert_equal(u8"Beach"sv, words.entries[found[2].entry].text);
+
+	found = words.find(u8"par bea"sv, 10);
+	assert_equal(1_z, found.size(), u8"segments count"sv);
+	assert_equal(2_z, found[0].highlights.size(), u8"segments highlights"sv);
+
+	assert_equal(0_z, words.find(u8"xyz"sv, 10).size(), u8"no match"sv);
+
+	auto_complete_index folders;
+	folders.build({
+		{u8"C:\\Photos\\Beach"sv, 2, 10},
+		{u8"C:\\Beach Trip"sv, 3, 3},
+		{u8"D:\\Bear"sv, 1, 3},
+	});
+
+	found = folders.find(u8"bea"sv, 10);
+	assert_equal(3_z, found.size(), u8"folder count"sv);
+	assert_equal(u8"C:\\Beach Trip"sv, folders.entries[found[0].entry].text);
+	assert_equal(3_z, found[0].highlights[0].offset, u8"folder name highlight"sv);
+	assert_equal(10_z, found[1].highlights[0].offset, u8"folder name highlight"sv);
+
+	found = folders.find(u8"c:"sv, 10);
+	assert_equal(2_z, found.size(), u8"folder path prefix count"sv);
+	assert_equal(0_z, found[0].highlights[0].offset, u8"folder path highlight"sv);
+}
+
+
 static void should_scan_info_from_title()
 {
 	const auto ps1 = scan_info_from_title(u8"Game.of.Thrones.S02E06.HDTV.x264 - 2HD.mp4"sv);
@@ -3374,7 +4848,9 @@ void register_tests(view_state& state, test_registry &tests)
 	tests.add(u8"Should extract url"s, should_extract_url);
 	tests.add(u8"Should detect wildcard"s, should_detect_wildcard);
 	tests.add(u8"Should match wildcard"s, should_match_wildcard);
+	tests.add(u8"Should match ASCII text with SIMD"s, should_match_ascii_text_with_simd);
 	tests.add(u8"Should handle international characters"s, should_handle_international_characters);
+	tests.add(u8"Should compare cached strings"s, should_compare_cached_strings);
 
 	//tests.add(u8"Should measure text consistently"sv, should_measure_text_consistently);
 	tests.add(u8"Should record crashes"s, should_record_crashes);
@@ -3391,7 +4867,10 @@ void register_tests(view_state& state, test_registry &tests)
 	tests.add(u8"Should trim strings"s, should_trim_strings);
 	tests.add(u8"Should format text"s, should_format_text);
 	tests.add(u8"Should find text"s, should_find_text);
+	tests.add(u8"Should rank auto complete"s, should_rank_auto_complete);
 	tests.add(u8"Should find Location"s, should_find_location);
+	tests.add(u8"Should reuse compiled locations"s, should_reuse_compiled_locations);
+	tests.add(u8"Should batch reverse geocode"s, should_batch_reverse_geocode);
 	tests.add(u8"Should format plural text"s, should_format_plural_text);
 	tests.add(u8"Should format rename"s, should_format_rename);
 	tests.add(u8"Should check overwrite"s, should_check_overwrite);
@@ -3403,6 +4882,7 @@ void register_tests(view_state& state, test_registry &tests)
 	//
 	tests.add(u8"Should scan jpg metadata"s, should_scan_jpeg);
 	tests.add(u8"Should scan avi metadata"s, should_scan_avi);
+	tests.add(u8"Should load scaled thumbnail"s, should_load_scaled_thumbnail);
 	tests.add(u8"Should scan mov metadata"s, should_scan_mov);
 	tests.add(u8"Should scan mp3 metadata"s, should_scan_mp3);
 	tests.add(u8"Should scan mp4 metadata"s, should_scan_mp4);
@@ -3463,6 +4943,9 @@ void register_tests(view_state& state, test_registry &tests)
 	tests.add(u8"Should rotate"s, should_rotate);
 	tests.add(u8"Should rotate 133"s, should_rotate133);
 	tests.add(u8"Should rotate lossless"s, should_rotate_lossless);
+	tests.add(u8"Should adjust color with lut"s, should_adjust_color_with_lut);
+	tests.add(u8"Should find similar images"s, should_find_similar_images);
+	tests.add(u8"Should evict cached thumbnails"s, should_evict_cached_thumbnails);
 	tests.add(u8"Should save .png"s, [] { should_save(u8".png"sv, true); });
 	tests.add(u8"Should save .jpg"s, [] { should_save(u8".jpg"sv, true); });
 	tests.add(u8"Should save .webp"s, [] { should_save(u8".webp"sv, true); });
@@ -3475,6 +4958,7 @@ void register_tests(view_state& state, test_registry &tests)
 	tests.add(u8"Should Enable based on selection"s, should_enable_based_on_selection);
 	tests.add(u8"Should update exif rating"s, should_update_exif_rating);
 	tests.add(u8"Should update formatted description"s, should_update_formatted_text);
+	tests.add(u8"Should group and sort items"s, should_group_and_sort_items);
 	tests.add(u8"Should toggle rating"s, should_toggle_rating);
 
 	//
@@ -3483,10 +4967,26 @@ void register_tests(view_state& state, test_registry &tests)
 	tests.add(u8"Should index"s, should_index);
 	tests.add(u8"Should store thumbnails"s, should_store_thumbnails);
 	tests.add(u8"Should store cover art"s, should_store_cover_art);
+	tests.add(u8"Should compact thumbnail store"s, should_compact_thumbnail_store);
 	tests.add(u8"Should store item properties"s, should_store_item_properties);
+	tests.add(u8"Should load items before the phash column exists"s, should_load_items_before_phash_column);
+	tests.add(u8"Should coalesce item writes"s, should_coalesce_item_writes);
 	tests.add(u8"Should store pack properties"s, should_pack_item_properties);
 	tests.add(u8"Should store webservice results"s, should_store_webservice_results);
 	tests.add(u8"Should detect duplicates"s, should_detect_duplicates);
+	tests.add(u8"Should group duplicate chains"s, should_group_duplicate_chains);
+	tests.add(u8"Should rebuild columns after folder changes"s, should_rebuild_columns_after_folder_changes);
+	tests.add(u8"Should update presence"s, should_update_presence);
+	tests.add(u8"Should clear the crc of modified files"s, should_clear_crc_of_modified_files);
+	tests.add(u8"Should fingerprint files"s, should_fingerprint_files);
+	tests.add(u8"Should run busy work pool in chunks"s, should_run_busy_work_pool_in_chunks);
+	tests.add(u8"Should run executor lanes"s, should_run_executor_lanes);
+	tests.add(u8"Should apply backpressure in bounded queue"s, should_apply_backpressure_in_bounded_queue);
+	tests.add(u8"Should walk folders concurrently"s, should_walk_folders_concurrently);
+	tests.add(u8"Should scale collection queries"s, should_scale_collection_queries);
+	tests.add(u8"Should narrow text queries like a full scan"s, should_narrow_text_queries_like_full_scan);
+	tests.add(u8"Should update summary incrementally"s, should_update_summary_incrementally);
+	tests.add(u8"Should load index values in parallel"s, should_load_index_values_in_parallel);
 	tests.add(u8"Should Rename"s, should_rename);
 	tests.add(u8"Should Rename with substitutions"s, should_rename_with_substitutions);
 	tests.add(u8"Should not overwrite during rename"s, should_not_overwrite_during_rename);
@@ -696,8 +696,15 @@ namespace ui
 		const_surface_ptr transform(const image_edits& photo_edits) const;
 
 		pixel_difference_result pixel_difference(const const_surface_ptr& image) const;
+		uint64_t perceptual_hash() const;
 	};
 
+	// Number of differing bits between two perceptual hashes
+	inline int perceptual_distance(const uint64_t a, const uint64_t b)
+	{
+		return std::popcount(a ^ b);
+	}
+
 
 	class image final : public std::enable_shared_from_this<image>
 	{
@@ -1111,17 +1118,29 @@ namespace ui
 	private:
 		static constexpr int curve_len = 0x1000;
 
+		// The adjustment is baked into a lut_len^3 grid indexed by the top
+		// bits of each channel. Entries hold 16 bit channels scaled by 8.
+		static constexpr int lut_len = 33;
+		static constexpr int lut_shift = 3;
+
 		double _curve[curve_len];
 		double _saturation = 0;
 		double _vibrance = 0;
+		std::vector<uint64_t> _lut;
 
 	public:
 		void color_params(double vibrance, double saturation, double darks, double midtones, double lights,
 			double contrast, double brightness);
 		void apply(const const_surface_ptr& src, uint8_t* dst, const size_t dst_stride, df::cancel_token token) const;
 
+		// Per pixel evaluation without the lut. Slow; used as a reference.
+		void apply_exact(const const_surface_ptr& src, uint8_t* dst, const size_t dst_stride,
+			df::cancel_token token) const;
+
 	private:
-		color32 adjust_color(double y, double u, double v, double a) const;
+		void adjust_color(double y, double u, double v, double& r, double& g, double& b) const;
+		void build_lut();
+		void apply_lut(const color32* s, color32* d, int cx) const;
 	};
 
 	enum class texture_update_result
@@ -57,6 +57,8 @@ enum class async_queue
 	index_predictions_single,
 	index_summary_single,
 	index_presence_single,
+	thumbnail_prefetch_single,
+	fingerprint,
 	web,
 };
 
@@ -72,6 +74,7 @@ namespace df
 	class search_t;
 	class item_element;
 	struct index_file_item;
+	struct index_columns;
 
 	using item_element_ptr = std::shared_ptr<item_element>;
 
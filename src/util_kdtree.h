@@ -16,9 +16,34 @@ struct kd_coordinates_t
 	uint32_t country;
 };
 
+// Nodes are stored flattened in depth first order so a built tree can be
+// written to disk and searched straight from a memory mapped file. The first
+// child of an inner node is the next node, second_child is the index of the other.
+struct kd_node_t
+{
+	float x, y, r;
+	uint16_t split_axis; // 0 or 1, leaf for leaves
+	uint16_t num_points;
+	uint32_t offset; // first point of a leaf, second_child of an inner node
+
+	static constexpr uint16_t leaf = 2;
+};
+
 class kd_tree
 {
 private:
+	static constexpr int MAX_PTS_PER_NODE = 16;
+
+	struct traversal_state : public df::no_copy
+	{
+		kd_coordinates_t p;
+		kd_coordinates_t closest;
+		float closest_d, closest_d2;
+	};
+
+	std::vector<kd_node_t> _built;
+	std::span<const kd_node_t> _nodes;
+
 	static float dist(const float x1, const float y1, const float x2, const float y2)
 	{
 		const auto dx = x1 - x2;
@@ -36,192 +61,195 @@ private:
 		return x * x;
 	}
 
-	class node_t : public df::no_copy
+	uint32_t build_node(std::vector<kd_coordinates_t>& data, const size_t offset, const size_t n)
 	{
-	public:
-		struct traversal_state : public no_copy
-		{
-			kd_coordinates_t p, dir;
-			kd_coordinates_t closest;
-			float closest_d, closest_d2;
-			size_t k;
-		};
-
-		static constexpr int MAX_PTS_PER_NODE = 16;
-
-		int _num_points = 0;
-		float x = 0.0;
-		float y = 0.0;
-		float r = 0.0f;
-		int split_axis = 0;
-		size_t _offset = 0;
+		const auto index = static_cast<uint32_t>(_built.size());
+		auto& leaf = _built.emplace_back();
 
-		std::unique_ptr<node_t> child1;
-		std::unique_ptr<node_t> child2;
-
-		node_t(std::vector<kd_coordinates_t>& data, const size_t offset, const size_t n)
+		if (n <= MAX_PTS_PER_NODE)
 		{
-			if (n <= MAX_PTS_PER_NODE)
-			{
-				_num_points = static_cast<int>(n);
-				_offset = offset;
-				return;
-			}
+			leaf.split_axis = kd_node_t::leaf;
+			leaf.num_points = static_cast<uint16_t>(n);
+			leaf.offset = static_cast<uint32_t>(offset);
+			return index;
+		}
 
-			_num_points = 0;
+		kd_node_t node = {};
 
-			auto xmin = data[offset].x;
-			auto xmax = data[offset].x;
-			auto ymin = data[offset].y;
-			auto ymax = data[offset].y;
+		auto xmin = data[offset].x;
+		auto xmax = data[offset].x;
+		auto ymin = data[offset].y;
+		auto ymax = data[offset].y;
 
-			for (size_t i = 1; i < n; i++)
-			{
-				const auto& c = data[offset + i];
-				if (c.x < xmin) xmin = c.x;
-				if (c.x > xmax) xmax = c.x;
-				if (c.y < ymin) ymin = c.y;
-				if (c.y > ymax) ymax = c.y;
-			}
+		for (size_t i = 1; i < n; i++)
+		{
+			const auto& c = data[offset + i];
+			if (c.x < xmin) xmin = c.x;
+			if (c.x > xmax) xmax = c.x;
+			if (c.y < ymin) ymin = c.y;
+			if (c.y > ymax) ymax = c.y;
+		}
 
-			x = 0.5f * (xmin + xmax);
-			y = 0.5f * (ymin + ymax);
+		node.x = 0.5f * (xmin + xmax);
+		node.y = 0.5f * (ymin + ymax);
 
-			const auto dx = xmax - xmin;
-			const auto dy = ymax - ymin;
+		const auto dx = xmax - xmin;
+		const auto dy = ymax - ymin;
 
-			r = 0.5f * sqrt(fast_sqr(dx) + fast_sqr(dy));
+		node.r = 0.5f * sqrt(fast_sqr(dx) + fast_sqr(dy));
+		node.split_axis = dx > dy ? 0 : 1;
 
-			split_axis = dx > dy ? 0 : 1;
+		auto left = offset;
+		auto right = offset + n - 1;
 
-			auto left = offset;
-			auto right = offset + n - 1;
+		if (node.split_axis == 0)
+		{
+			const auto split_val = node.x;
 
-			if (split_axis == 0)
+			while (true)
 			{
-				const auto split_val = x;
-
-				while (true)
-				{
-					while (data[left].x < split_val)
-						left++;
-
-					while (data[right].x > split_val)
-						right--;
+				while (data[left].x < split_val)
+					left++;
 
-					if (right < left)
-						break;
+				while (data[right].x > split_val)
+					right--;
 
-					if (df::equiv(data[left].x, data[right].x))
-					{
-						left += (right - left) / 2;
-						break;
-					}
+				if (right < left)
+					break;
 
-					std::swap(data[left], data[right]);
-					left++;
-					right--;
+				if (df::equiv(data[left].x, data[right].x))
+				{
+					left += (right - left) / 2;
+					break;
 				}
-			}
-			else
-			{
-				const auto split_val = y;
 
-				while (true)
-				{
-					while (data[left].y < split_val)
-						left++;
+				std::swap(data[left], data[right]);
+				left++;
+				right--;
+			}
+		}
+		else
+		{
+			const auto split_val = node.y;
 
-					while (data[right].y > split_val)
-						right--;
+			while (true)
+			{
+				while (data[left].y < split_val)
+					left++;
 
-					if (right < left)
-						break;
+				while (data[right].y > split_val)
+					right--;
 
-					if (df::equiv(data[left].y, data[right].y))
-					{
-						left += (right - left) / 2;
-						break;
-					}
+				if (right < left)
+					break;
 
-					std::swap(data[left], data[right]);
-					left++;
-					right--;
+				if (df::equiv(data[left].y, data[right].y))
+				{
+					left += (right - left) / 2;
+					break;
 				}
-			}
 
-			child1 = std::make_unique<node_t>(data, offset, left - offset);
-			child2 = std::make_unique<node_t>(data, left, n - (left - offset));
+				std::swap(data[left], data[right]);
+				left++;
+				right--;
+			}
 		}
 
-		void find_closest_to_pt(const std::vector<kd_coordinates_t>& data, traversal_state& ti) const
+		build_node(data, offset, left - offset);
+		node.offset = build_node(data, left, n - (left - offset));
+		_built[index] = node;
+		return index;
+	}
+
+	void find_closest_to_pt(const std::span<const kd_coordinates_t> data, const uint32_t index,
+		traversal_state& ti) const
+	{
+		const auto& node = _nodes[index];
+
+		if (node.split_axis == kd_node_t::leaf)
 		{
-			if (_num_points)
+			for (auto i = 0; i < node.num_points; i++)
 			{
-				for (auto i = 0; i < _num_points; i++)
+				const auto myd2 = dist(data[node.offset + i], ti.p);
+
+				if ((myd2 < ti.closest_d2))
 				{
-					const auto myd2 = dist(data[_offset + i], ti.p);
-
-					if ((myd2 < ti.closest_d2))
-					{
-						ti.closest_d2 = myd2;
-						ti.closest_d = sqrt(ti.closest_d2);
-						ti.closest = data[_offset + i];
-					}
+					ti.closest_d2 = myd2;
+					ti.closest_d = sqrt(ti.closest_d2);
+					ti.closest = data[node.offset + i];
 				}
-				return;
 			}
+			return;
+		}
 
+		if (dist(node.x, node.y, ti.p.x, ti.p.y) >= fast_sqr(node.r + ti.closest_d))
+			return;
 
-			if (dist(x, y, ti.p.x, ti.p.y) >= fast_sqr(r + ti.closest_d))
-				return;
-
-			const auto myd = split_axis == 0 ? (x - ti.p.x) : (y - ti.p.y);
+		const auto myd = node.split_axis == 0 ? (node.x - ti.p.x) : (node.y - ti.p.y);
+		const auto child1 = index + 1;
+		const auto child2 = node.offset;
 
-			if (myd >= 0.0f)
-			{
-				child1->find_closest_to_pt(data, ti);
+		if (myd >= 0.0f)
+		{
+			find_closest_to_pt(data, child1, ti);
 
-				if (myd < ti.closest_d)
-					child2->find_closest_to_pt(data, ti);
-			}
-			else
-			{
-				child2->find_closest_to_pt(data, ti);
-				if (-myd < ti.closest_d)
-					child1->find_closest_to_pt(data, ti);
-			}
+			if (myd < ti.closest_d)
+				find_closest_to_pt(data, child2, ti);
 		}
-	};
-
-	std::unique_ptr<node_t> root;
+		else
+		{
+			find_closest_to_pt(data, child2, ti);
+			if (-myd < ti.closest_d)
+				find_closest_to_pt(data, child1, ti);
+		}
+	}
 
 public:
 	kd_tree() = default;
 
+	// reorders data so each leaf covers a contiguous run of points
 	void build(std::vector<kd_coordinates_t>& data)
 	{
-		root = std::make_unique<node_t>(data, 0, data.size());
+		_built.clear();
+
+		if (!data.empty())
+		{
+			_built.reserve(((data.size() / MAX_PTS_PER_NODE) + 1) * 4);
+			build_node(data, 0, data.size());
+		}
+
+		_nodes = _built;
+	}
+
+	// nodes from a previous build, typically memory mapped
+	void attach(const std::span<const kd_node_t> nodes)
+	{
+		_built.clear();
+		_nodes = nodes;
+	}
+
+	std::span<const kd_node_t> nodes() const
+	{
+		return _nodes;
 	}
 
 	bool is_empty() const
 	{
-		return root == nullptr;
+		return _nodes.empty();
 	}
 
-	kd_coordinates_t find_closest(const std::vector<kd_coordinates_t>& data, const kd_coordinates_t& p) const
+	kd_coordinates_t find_closest(const std::span<const kd_coordinates_t> data, const kd_coordinates_t& p) const
 	{
-		if (root)
+		if (!_nodes.empty())
 		{
-			node_t::traversal_state ti;
+			traversal_state ti;
 
 			ti.p = p;
-			ti.closest.x = 0;
-			ti.closest.y = 0;
-			ti.closest_d2 = fast_sqr(root->r);
+			ti.closest = {};
+			ti.closest_d2 = fast_sqr(_nodes[0].r);
 			ti.closest_d = sqrt(ti.closest_d2);
 
-			root->find_closest_to_pt(data, ti);
+			find_closest_to_pt(data, 0, ti);
 
 			return ti.closest;
 		}
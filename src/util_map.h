@@ -41,12 +41,17 @@ namespace df
 	{
 		size_t operator()(const file_path path) const
 		{
-			return crypto::fnv1a_i(path.folder().text(), path.name());
+			return path.folded_hash();
 		}
 
 		size_t operator()(const folder_path path) const
 		{
-			return crypto::fnv1a_i(path.text());
+			return path.folded_hash();
+		}
+
+		size_t operator()(const str::cached s) const
+		{
+			return s.folded_hash();
 		}
 
 		size_t operator()(const std::u8string_view s) const
@@ -67,6 +72,11 @@ namespace df
 			return l.icmp(r) < 0;
 		}
 
+		bool operator()(const str::cached l, const str::cached r) const
+		{
+			return str::icmp(l, r) < 0;
+		}
+
 		bool operator()(const std::u8string_view l, const std::u8string_view r) const
 		{
 			return str::icmp(l, r) < 0;
@@ -82,12 +92,17 @@ namespace df
 	{
 		bool operator()(const file_path l, const file_path r) const
 		{
-			return l.icmp(r) == 0;
+			return l == r;
 		}
 
 		bool operator()(const folder_path l, const folder_path r) const
 		{
-			return l.compare(r) == 0;
+			return l == r;
+		}
+
+		bool operator()(const str::cached l, const str::cached r) const
+		{
+			return str::iequals(l, r);
 		}
 
 		bool operator()(const std::u8string_view l, const std::u8string_view r) const
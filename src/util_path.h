@@ -369,14 +369,19 @@ namespace df
 		}
 
 
+		uint32_t folded_hash() const
+		{
+			return _s.folded_hash();
+		}
+
 		bool operator==(const folder_path other) const
 		{
-			return compare(other) == 0;
+			return str::iequals(_s, other._s);
 		}
 
 		bool operator!=(const folder_path other) const
 		{
-			return compare(other) != 0;
+			return !str::iequals(_s, other._s);
 		}
 
 		bool operator<(const folder_path other) const
@@ -484,14 +489,20 @@ namespace df
 			return diff == 0 ? str::icmp(_name, other._name) : diff;
 		}
 
+		size_t folded_hash() const
+		{
+			const auto h = ((static_cast<uint64_t>(_folder.folded_hash()) << 32) | _name.folded_hash()) * 0x9e3779b97f4a7c15ull;
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+
 		bool operator==(const file_path other) const
 		{
-			return icmp(other) == 0;
+			return str::iequals(_name, other._name) && _folder == other._folder;
 		}
 
 		bool operator!=(const file_path other) const
 		{
-			return icmp(other) != 0;
+			return !(*this == other);
 		}
 
 		bool exists() const
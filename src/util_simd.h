@@ -137,6 +137,214 @@ static uint32_t calc_crc32c_arm(uint32_t crc, const void* data, const size_t len
 	return crc;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+// ASCII case folding kernels used by the str:: compare and search functions.
+// Each one stops at the first non ASCII byte so the caller can fall back to
+// the code point path in util_strings.cpp. fold_space also maps \t \n \v \f \r
+// to space to match str::normalze_for_compare.
+
+static constexpr uint8_t fold_ascii(const uint8_t c, const bool fold_space)
+{
+	if (c >= 'A' && c <= 'Z') return c + 0x20;
+	if (fold_space && c >= 0x09 && c <= 0x0d) return 0x20;
+	return c;
+}
+
+static size_t ascii_fold_equal_c(const uint8_t* l, const uint8_t* r, const size_t len, const bool fold_space)
+{
+	size_t i = 0;
+
+	while (i < len && (l[i] | r[i]) < 0x80 && fold_ascii(l[i], fold_space) == fold_ascii(r[i], fold_space))
+	{
+		i += 1;
+	}
+
+	return i;
+}
+
+static size_t ascii_find_folded_c(const uint8_t* p, const size_t len, const uint8_t c, const bool fold_space)
+{
+	size_t i = 0;
+
+	while (i < len && p[i] < 0x80 && fold_ascii(p[i], fold_space) != c)
+	{
+		i += 1;
+	}
+
+	return i;
+}
+
+static size_t ascii_lower_c(uint8_t* dst, const uint8_t* src, const size_t len)
+{
+	size_t i = 0;
+
+	while (i < len && src[i] < 0x80)
+	{
+		dst[i] = fold_ascii(src[i], false);
+		i += 1;
+	}
+
+	return i;
+}
+
+#if defined(COMPILE_SIMD_INTRINSIC)
+static __m128i fold_ascii_sse2(const __m128i x, const bool fold_space)
+{
+	// Signed compares are fine here, non ASCII bytes are negative and never fold
+	const auto upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+	auto result = _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+
+	if (fold_space)
+	{
+		const auto space = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(0x08)), _mm_cmplt_epi8(x, _mm_set1_epi8(0x0e)));
+		result = _mm_or_si128(_mm_andnot_si128(space, result), _mm_and_si128(space, _mm_set1_epi8(0x20)));
+	}
+
+	return result;
+}
+#endif
+
+static size_t ascii_fold_equal_sse2(const uint8_t* l, const uint8_t* r, const size_t len, const bool fold_space)
+{
+	size_t i = 0;
+
+#if defined(COMPILE_SIMD_INTRINSIC)
+	while (i + 16 <= len)
+	{
+		const auto a = _mm_loadu_si128(std::bit_cast<const __m128i*>(l + i));
+		const auto b = _mm_loadu_si128(std::bit_cast<const __m128i*>(r + i));
+		const auto same = _mm_movemask_epi8(_mm_cmpeq_epi8(fold_ascii_sse2(a, fold_space), fold_ascii_sse2(b, fold_space)));
+		const auto ascii = ~_mm_movemask_epi8(_mm_or_si128(a, b));
+		const auto matched = static_cast<uint32_t>(same & ascii) & 0xFFFFu;
+
+		if (matched != 0xFFFFu) return i + std::countr_one(matched);
+		i += 16;
+	}
+#endif
+
+	return i + ascii_fold_equal_c(l + i, r + i, len - i, fold_space);
+}
+
+static size_t ascii_find_folded_sse2(const uint8_t* p, const size_t len, const uint8_t c, const bool fold_space)
+{
+	size_t i = 0;
+
+#if defined(COMPILE_SIMD_INTRINSIC)
+	const auto target = _mm_set1_epi8(static_cast<char>(c));
+
+	while (i + 16 <= len)
+	{
+		const auto x = _mm_loadu_si128(std::bit_cast<const __m128i*>(p + i));
+		const auto stop = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(x, _mm_cmpeq_epi8(fold_ascii_sse2(x, fold_space), target))));
+
+		if (stop) return i + std::countr_zero(stop);
+		i += 16;
+	}
+#endif
+
+	return i + ascii_find_folded_c(p + i, len - i, c, fold_space);
+}
+
+static size_t ascii_lower_sse2(uint8_t* dst, const uint8_t* src, const size_t len)
+{
+	size_t i = 0;
+
+#if defined(COMPILE_SIMD_INTRINSIC)
+	while (i + 16 <= len)
+	{
+		const auto x = _mm_loadu_si128(std::bit_cast<const __m128i*>(src + i));
+		if (_mm_movemask_epi8(x)) break;
+		_mm_storeu_si128(std::bit_cast<__m128i*>(dst + i), fold_ascii_sse2(x, false));
+		i += 16;
+	}
+#endif
+
+	return i + ascii_lower_c(dst + i, src + i, len - i);
+}
+
+#if defined(COMPILE_ARM_INTRINSIC)
+static uint8x16_t fold_ascii_arm(const uint8x16_t x, const bool fold_space)
+{
+	const auto upper = vandq_u8(vcgeq_u8(x, vdupq_n_u8('A')), vcleq_u8(x, vdupq_n_u8('Z')));
+	auto result = vorrq_u8(x, vandq_u8(upper, vdupq_n_u8(0x20)));
+
+	if (fold_space)
+	{
+		const auto space = vandq_u8(vcgeq_u8(x, vdupq_n_u8(0x09)), vcleq_u8(x, vdupq_n_u8(0x0d)));
+		result = vbslq_u8(space, vdupq_n_u8(0x20), result);
+	}
+
+	return result;
+}
+
+// Narrows a lane mask to 4 bits per lane, so lane n starts at bit n * 4
+static uint64_t lane_mask_arm(const uint8x16_t m)
+{
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+}
+#endif
+
+static size_t ascii_fold_equal_arm(const uint8_t* l, const uint8_t* r, const size_t len, const bool fold_space)
+{
+	size_t i = 0;
+
+#if defined(COMPILE_ARM_INTRINSIC)
+	while (i + 16 <= len)
+	{
+		const auto a = vld1q_u8(l + i);
+		const auto b = vld1q_u8(r + i);
+		const auto same = vceqq_u8(fold_ascii_arm(a, fold_space), fold_ascii_arm(b, fold_space));
+		const auto ascii = vcltq_u8(vorrq_u8(a, b), vdupq_n_u8(0x80));
+		const auto matched = lane_mask_arm(vandq_u8(same, ascii));
+
+		if (matched != ~0ull) return i + std::countr_one(matched) / 4;
+		i += 16;
+	}
+#endif
+
+	return i + ascii_fold_equal_c(l + i, r + i, len - i, fold_space);
+}
+
+static size_t ascii_find_folded_arm(const uint8_t* p, const size_t len, const uint8_t c, const bool fold_space)
+{
+	size_t i = 0;
+
+#if defined(COMPILE_ARM_INTRINSIC)
+	const auto target = vdupq_n_u8(c);
+
+	while (i + 16 <= len)
+	{
+		const auto x = vld1q_u8(p + i);
+		const auto stop = lane_mask_arm(vorrq_u8(vcgeq_u8(x, vdupq_n_u8(0x80)), vceqq_u8(fold_ascii_arm(x, fold_space), target)));
+
+		if (stop) return i + std::countr_zero(stop) / 4;
+		i += 16;
+	}
+#endif
+
+	return i + ascii_find_folded_c(p + i, len - i, c, fold_space);
+}
+
+static size_t ascii_lower_arm(uint8_t* dst, const uint8_t* src, const size_t len)
+{
+	size_t i = 0;
+
+#if defined(COMPILE_ARM_INTRINSIC)
+	while (i + 16 <= len)
+	{
+		const auto x = vld1q_u8(src + i);
+		if (vmaxvq_u8(x) >= 0x80) break;
+		vst1q_u8(dst + i, fold_ascii_arm(x, false));
+		i += 16;
+	}
+#endif
+
+	return i + ascii_lower_c(dst + i, src + i, len - i);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include "pch.h"
 #include "util.h"
 #include "util_strings.h"
+#include "crypto.h"
+#include "util_simd.h"
 
 #include <cstdarg>
 
@@ -427,7 +429,12 @@ struct string_index_t
 		const auto allocation = sizeof(str::chached_string_storage_t) + (len + 1) * sizeof(char8_t);
 		auto* const copy = static_cast<str::chached_string_storage_t*>(_pool.alloc(allocation));
 
+		const auto prefix = str::folded_prefix(sv);
+
 		copy->len = static_cast<uint32_t>(len);
+		copy->folded_hash = crypto::fnv1a_i(sv);
+		copy->folded_prefix_hi = static_cast<uint32_t>(prefix >> 32);
+		copy->folded_prefix_lo = static_cast<uint32_t>(prefix);
 		memcpy_s(copy->sz, allocation, sv.data(), len * sizeof(char8_t));
 		copy->sz[len] = 0;
 
@@ -452,6 +459,29 @@ struct string_index_t
 	}
 };
 
+uint64_t str::folded_prefix(const std::u8string_view sv)
+{
+	uint64_t result = 0;
+	auto shift = 56;
+	auto p = sv.begin();
+
+	while (p < sv.end() && shift >= 0)
+	{
+		const auto c = pop_utf8_char(p, sv.end());
+
+		if (c >= 0x80)
+		{
+			result |= 0xFFull << shift;
+			break;
+		}
+
+		result |= static_cast<uint64_t>(to_lower(c)) << shift;
+		shift -= 8;
+	}
+
+	return result;
+}
+
 static string_index_t& string_index()
 {
 	static string_index_t index;
@@ -595,6 +625,34 @@ bool str::starts(const std::u8string_view text, const std::u8string_view sub_str
 	return true;
 }
 
+size_t str::ascii_fold_equal(const char8_t* l, const char8_t* r, const size_t len, const bool fold_space)
+{
+	const auto* const lb = std::bit_cast<const uint8_t*>(l);
+	const auto* const rb = std::bit_cast<const uint8_t*>(r);
+	if (platform::sse2_supported) return ascii_fold_equal_sse2(lb, rb, len, fold_space);
+	if (platform::neon_supported) return ascii_fold_equal_arm(lb, rb, len, fold_space);
+	return ascii_fold_equal_c(lb, rb, len, fold_space);
+}
+
+size_t str::ascii_find_folded(const char8_t* p, const size_t len, const uint32_t c, const bool fold_space)
+{
+	// A non ASCII target can only match a non ASCII byte, where the kernels stop anyway
+	const auto target = static_cast<uint8_t>(c < 0x80 ? c : 0x80);
+	const auto* const pb = std::bit_cast<const uint8_t*>(p);
+	if (platform::sse2_supported) return ascii_find_folded_sse2(pb, len, target, fold_space);
+	if (platform::neon_supported) return ascii_find_folded_arm(pb, len, target, fold_space);
+	return ascii_find_folded_c(pb, len, target, fold_space);
+}
+
+size_t str::ascii_lower(char8_t* dst, const char8_t* src, const size_t len)
+{
+	auto* const db = std::bit_cast<uint8_t*>(dst);
+	const auto* const sb = std::bit_cast<const uint8_t*>(src);
+	if (platform::sse2_supported) return ascii_lower_sse2(db, sb, len);
+	if (platform::neon_supported) return ascii_lower_arm(db, sb, len);
+	return ascii_lower_c(db, sb, len);
+}
+
 std::u8string_view::size_type str::ifind(const std::u8string_view text, const std::u8string_view sub_string)
 {
 	if (!text.empty() && !sub_string.empty())
@@ -607,6 +665,10 @@ std::u8string_view::size_type str::ifind(const std::u8string_view text, const st
 
 		while (text_p < text_end && sub_p <= sub_end)
 		{
+			// Skip ASCII text that cannot start a match
+			text_p += ascii_find_folded(&*text_p, text_end - text_p, first_sub_char, true);
+			if (text_p == text_end) break;
+
 			const auto text_start = text_p;
 			const auto text_char = normalze_for_compare(pop_utf8_char(text_p, text_end));
 
@@ -618,6 +680,11 @@ std::u8string_view::size_type str::ifind(const std::u8string_view text, const st
 
 				while (matching && sub_match < sub_end && text_match < text_end)
 				{
+					const auto run = ascii_fold_equal(&*text_match, &*sub_match, std::min(text_end - text_match, sub_end - sub_match), true);
+					text_match += run;
+					sub_match += run;
+					if (sub_match == sub_end || text_match == text_end) break;
+
 					const auto text_match_char = normalze_for_compare(pop_utf8_char(text_match, text_end));
 					const auto sub_match_char = normalze_for_compare(pop_utf8_char(sub_match, sub_end));
 
@@ -654,6 +721,10 @@ str::find_result str::ifind2(const std::u8string_view text, const std::u8string_
 
 		while (text_p < text_end && sub_p <= sub_end)
 		{
+			// Skip ASCII text that cannot start a match
+			text_p += ascii_find_folded(&*text_p, text_end - text_p, first_sub_char, true);
+			if (text_p == text_end) break;
+
 			const auto text_char = normalze_for_compare(pop_utf8_char(text_p, text_end));
 
 			if (text_char == first_sub_char) // Is matching?
@@ -2688,8 +2759,19 @@ bool str::wildcard_icmp(const std::u8string_view text_in, const std::u8string_vi
 			break; // "x" doesn't match "y"
 		}
 
-		pop_utf8_char(text, text_end);
-		pop_utf8_char(wildcard, wildcard_end);
+		// Consume the whole run of matching ASCII characters at once
+		const auto run = ascii_fold_equal(&*text, &*wildcard, std::min(text_end - text, wildcard_end - wildcard), true);
+
+		if (run > 0)
+		{
+			text += run;
+			wildcard += run;
+		}
+		else
+		{
+			pop_utf8_char(text, text_end);
+			pop_utf8_char(wildcard, wildcard_end);
+		}
 	}
 
 	return is_match;
@@ -127,12 +127,21 @@ namespace str
 		size_t length = 0;
 	};
 
+	// folded_hash is fnv1a_i of the text and folded_prefix holds the first
+	// 8 lower cased characters, both computed once when the string is interned
 	struct chached_string_storage_t
 	{
 		uint32_t len;
+		uint32_t folded_hash;
+		uint32_t folded_prefix_hi;
+		uint32_t folded_prefix_lo;
 		char8_t sz[1];
 	};
 
+	// Packs the first 8 lower cased characters big endian, one per byte.
+	// Non ASCII characters are marked with 0xFF and end the prefix.
+	uint64_t folded_prefix(std::u8string_view sv);
+
 	struct cached
 	{
 		const chached_string_storage_t* storage = nullptr;
@@ -246,6 +255,20 @@ namespace str
 			const auto s = storage;
 			return s ? s->sz : u8"";
 		}
+
+		uint32_t folded_hash() const
+		{
+			// capture storage for better thread safety
+			const auto s = storage;
+			return s ? s->folded_hash : 0x811c9dc5u;
+		}
+
+		uint64_t folded_prefix() const
+		{
+			// capture storage for better thread safety
+			const auto s = storage;
+			return s ? (static_cast<uint64_t>(s->folded_prefix_hi) << 32) | s->folded_prefix_lo : 0;
+		}
 	};
 
 	constexpr bool is_empty(const cached c)
@@ -449,6 +472,12 @@ namespace str
 
 	int normalze_for_compare(int c);
 
+	// Vectorized ASCII kernels from util_simd.h. Each returns the length of the leading
+	// run it could handle and stops at the first non ASCII byte.
+	size_t ascii_fold_equal(const char8_t* l, const char8_t* r, size_t len, bool fold_space);
+	size_t ascii_find_folded(const char8_t* p, size_t len, uint32_t c, bool fold_space);
+	size_t ascii_lower(char8_t* dst, const char8_t* src, size_t len);
+
 	constexpr int cmp(const std::u8string_view ll, const std::u8string_view rr)
 	{
 		return ll.compare(rr);
@@ -470,6 +499,18 @@ namespace str
 		const auto el = ll.end();
 		const auto er = rr.end();
 
+		if (!std::is_constant_evaluated())
+		{
+			const auto run = ascii_fold_equal(ll.data(), rr.data(), std::min(ll.size(), rr.size()), false);
+
+			if (run > 0)
+			{
+				il += run;
+				ir += run;
+				cl = cr = to_lower(ll[run - 1]);
+			}
+		}
+
 		while (il < el && ir < er)
 		{
 			cl = to_lower(pop_utf8_char(il, el));
@@ -537,8 +578,50 @@ namespace str
 		return cl - cr;
 	}
 
+	// Orders two non empty strings by their folded prefixes. Returns 0 when the
+	// prefixes tie or differ at a non ASCII character and the text has to decide.
+	constexpr int icmp_folded_prefix(const uint64_t lp, const uint64_t rp)
+	{
+		if (lp == rp) return 0;
+
+		const auto shift = 56 - (std::countl_zero(lp ^ rp) & ~7);
+		const auto lc = (lp >> shift) & 0xFF;
+		const auto rc = (rp >> shift) & 0xFF;
+		if (lc == 0xFF || rc == 0xFF) return 0;
+		return lc < rc ? -1 : 1;
+	}
+
+	// Interned strings compare on their folded prefix when it decides the order
+	// and only walk the text when the prefixes tie or hit a non ASCII character
+	inline int icmp(const cached l, const cached r)
+	{
+		const auto ls = l.storage;
+		const auto rs = r.storage;
+		if (ls == rs) return 0;
+
+		if (ls && rs)
+		{
+			const auto diff = icmp_folded_prefix(l.folded_prefix(), r.folded_prefix());
+			if (diff != 0) return diff;
+		}
+
+		return icmp(l.sv(), r.sv());
+	}
+
+	inline bool iequals(const cached l, const cached r)
+	{
+		if (l.storage == r.storage) return true;
+		if (l.folded_hash() != r.folded_hash()) return false;
+		return icmp(l, r) == 0;
+	}
+
 	struct iless
 	{
+		bool operator()(const cached l, const cached r) const
+		{
+			return icmp(l, r) < 0;
+		}
+
 		bool operator()(const std::u8string_view l, const std::u8string_view r) const
 		{
 			return icmp(l, r) < 0;
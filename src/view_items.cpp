@@ -819,6 +819,45 @@ void items_view::update_visible_items_list()
 				_state.item_index.queue_scan_displayed_items(std::move(load));
 			}
 		}
+
+		// the list covers half a screen either side, decode those thumbnails
+		// before they scroll into view. Images are read here, on the thread that
+		// renders, and a newer list replaces a prefetch that has not started.
+		struct prefetch_thumbnail
+		{
+			df::file_path path;
+			df::date_t timestamp;
+			bool cover_art = false;
+			ui::const_image_ptr image;
+		};
+
+		std::vector<prefetch_thumbnail> prefetch;
+		prefetch.reserve(_visible_items.size());
+
+		for (const auto& i : _visible_items)
+		{
+			const auto cover_art = i.i->has_cover_art();
+			const auto& image = cover_art ? i.i->cover_art() : i.i->thumbnail();
+
+			if (is_valid(image))
+			{
+				prefetch.push_back({ i.i->path(), i.i->thumbnail_timestamp(), cover_art, image });
+			}
+		}
+
+		if (!prefetch.empty())
+		{
+			_state.queue_async(async_queue::thumbnail_prefetch_single, [prefetch = std::move(prefetch)]
+				{
+					auto& cache = df::thumbnail_cache();
+
+					for (const auto& p : prefetch)
+					{
+						if (df::is_closing) break;
+						cache.surface(p.path, p.timestamp, p.cover_art, p.image);
+					}
+				});
+		}
 	}
 }
 
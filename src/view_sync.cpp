@@ -319,7 +319,14 @@ void sync_view::update_rows(const sync_analysis_result& analysis_result)
 	const auto gray_text_color = ui::darken(ui::style::color::view_text, 0.22f);
 	const auto orange_text_color = ui::lighten(ui::style::color::important_background, 0.55f);
 
-	std::vector<row_element_ptr> rows;
+	struct sorted_row
+	{
+		std::u8string_view relative;
+		std::u8string_view name;
+		row_element_ptr row;
+	};
+
+	std::vector<sorted_row> sorted_rows;
 
 	int ignore = 0;
 	int copy_local = 0;
@@ -381,10 +388,26 @@ void sync_view::update_rows(const sync_analysis_result& analysis_result)
 				break;
 			}
 
-			rows.emplace_back(row);
+			sorted_rows.push_back({ a.first, i.first, row });
 		}
 	}
 
+	// the analysis is hashed so rows are put in relative folder and name order here,
+	// delete_remote rows have no local path to sort on
+	std::ranges::sort(sorted_rows, [](const auto& left, const auto& right)
+		{
+			const auto d = str::icmp(left.relative, right.relative);
+			return d != 0 ? d < 0 : str::icmp(left.name, right.name) < 0;
+		});
+
+	std::vector<row_element_ptr> rows;
+	rows.reserve(sorted_rows.size());
+
+	for (auto& r : sorted_rows)
+	{
+		rows.emplace_back(std::move(r.row));
+	}
+
 	_rows = std::move(rows);
 	_status = str::format(u8"{} {}   {} {}   {} {}   {} {}   {} {}"sv,
 		copy_local, tt.sync_copy_local_action,